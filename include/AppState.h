@@ -12,8 +12,10 @@ enum AppState {
   ADVERTISING_BLE,
   WAITING_FOR_WIFI_SCAN,
   WAITING_FOR_TIME_SYNC,
+  APPLYING_OFFLINE_SETUP,
   RUNNING_MAIN_TASK,
   RUNNING_PERIODIC_TASKS,
+  SETTINGS_WINDOW, // Button wake: BLE open for live settings changes
   SLEEPING,
   FETAL_ERROR,
 };
@@ -25,8 +27,13 @@ extern unsigned long lastAttempt;
 
 constexpr const char *WIFI_CRED_FILE = "/wifi.json";
 constexpr const char *MOSQUE_FILE = "/data.json";
-constexpr const char *PRAYER_TIME_FILE_NAME = "/prayer_times_month_";
-constexpr const char *IQAMA_TIME_FILE_NAME = "/iqama_times_month_";
+constexpr const char *PRAYER_TIME_FILE_PREFIX = "/prayer_times_"; // + YYYY_MM
+constexpr const char *PRAYER_TIME_FILE_NAME = "/prayer_times_month_"; // legacy
+constexpr const char *IQAMA_TIME_FILE_NAME = "/iqama_times_month_"; // legacy
+constexpr const char *PRAYER_CONFIG_FILE = "/prayer_config.json";
+constexpr const char *UPLOADED_CALENDAR_FILE = "/calendar.bin"; // Over BLE
+constexpr const char *CALENDAR_UPLOAD_FILE = "/calendar_upload.json"; // Resume
+constexpr const char *ADHAN_FILE = "/adhan.mp3"; // Downloaded once
 
 struct Countdown {
   int hours;
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Compact, allocation-free representation of one day's prayer schedule.
+// Every time is stored as minutes since local midnight (0..1439) so the wake
+// path can compare and subtract without parsing "HH:MM" strings. Strings are
+// only produced with formatHHMM() at the final draw/log step.
+struct DaySchedule {
+  static constexpr uint8_t PRAYER_COUNT = 6; // Fajr, Sunrise, Dhuhr, Asr,
+                                             // Maghrib, Isha
+  static constexpr uint8_t IQAMA_COUNT = 5;  // Fajr, Dhuhr, Asr, Maghrib, Isha
+  static constexpr uint16_t INVALID_MINUTES = 0xFFFF;
+  static constexpr uint16_t MINUTES_PER_DAY = 24 * 60;
+
+  enum PrayerIndex : uint8_t {
+    FAJR = 0,
+    SUNRISE = 1,
+    DHUHR = 2,
+    ASR = 3,
+    MAGHRIB = 4,
+    ISHA = 5,
+  };
+
+  uint16_t prayers[PRAYER_COUNT] = {INVALID_MINUTES, INVALID_MINUTES,
+                                    INVALID_MINUTES, INVALID_MINUTES,
+                                    INVALID_MINUTES, INVALID_MINUTES};
+  // Absolute iqama times (minutes since midnight), one per row prayer
+  uint16_t iqamas[IQAMA_COUNT] = {INVALID_MINUTES, INVALID_MINUTES,
+                                  INVALID_MINUTES, INVALID_MINUTES,
+                                  INVALID_MINUTES};
+
+  // Maps a row slot (0..4, no Sunrise) to its index in prayers[]
+  static uint8_t rowToPrayer(uint8_t row) {
+    static const uint8_t map[IQAMA_COUNT] = {FAJR, DHUHR, ASR, MAGHRIB, ISHA};
+    return row < IQAMA_COUNT ? map[row] : FAJR;
+  }
+
+  bool hasPrayers() const {
+    for (uint8_t i = 0; i < PRAYER_COUNT; ++i) {
+      if (prayers[i] >= MINUTES_PER_DAY)
+        return false;
+    }
+    return true;
+  }
+
+  bool hasIqamas() const {
+    for (uint8_t i = 0; i < IQAMA_COUNT; ++i) {
+      if (iqamas[i] >= MINUTES_PER_DAY)
+        return false;
+    }
+    return true;
+  }
+
+  bool isValid() const { return hasPrayers() && hasIqamas(); }
+
+  // Index into prayers[] of the first prayer strictly after nowMinutes,
+  // or -1 if every prayer of this day has already passed.
+  int nextPrayerIndex(uint16_t nowMinutes) const {
+    for (uint8_t i = 0; i < PRAYER_COUNT; ++i) {
+      if (prayers[i] > nowMinutes)
+        return i;
+    }
+    return -1;
+  }
+
+  // Row slot (0..4) of the next row prayer after nowMinutes; wraps to Fajr.
+  int nextRowIndex(uint16_t nowMinutes) const {
+    for (uint8_t row = 0; row < IQAMA_COUNT; ++row) {
+      if (prayers[rowToPrayer(row)] > nowMinutes)
+        return row;
+    }
+    return 0;
+  }
+
+  uint16_t rowPrayer(uint8_t row) const { return prayers[rowToPrayer(row)]; }
+
+  // Iqama delay in minutes for a row slot (0 if unknown or not after adhan)
+  int iqamaDelay(uint8_t row) const {
+    if (row >= IQAMA_COUNT)
+      return 0;
+    uint16_t prayer = rowPrayer(row);
+    if (prayer >= MINUTES_PER_DAY || iqamas[row] >= MINUTES_PER_DAY)
+      return 0;
+    int delay = (int)iqamas[row] - (int)prayer;
+    return delay > 0 ? delay : 0;
+  }
+
+  // Night is Maghrib..Fajr (used for the weather icon set)
+  bool isNight(uint16_t nowMinutes) const {
+    uint16_t fajr = prayers[FAJR];
+    uint16_t maghrib = prayers[MAGHRIB];
+    if (fajr >= MINUTES_PER_DAY || maghrib >= MINUTES_PER_DAY)
+      return false;
+    if (maghrib > fajr)
+      return nowMinutes >= maghrib || nowMinutes < fajr;
+    return nowMinutes >= maghrib && nowMinutes < fajr;
+  }
+
+  // Parses "HH:MM" (anything after the minutes is ignored, e.g. "05:12 (CET)")
+  static uint16_t parseHHMM(const char *str) {
+    if (!str || str[0] < '0' || str[0] > '9')
+      return INVALID_MINUTES;
+    int h = 0;
+    const char *p = str;
+    while (*p >= '0' && *p <= '9')
+      h = h * 10 + (*p++ - '0');
+    if (*p++ != ':' || *p < '0' || *p > '9')
+      return INVALID_MINUTES;
+    int m = 0;
+    while (*p >= '0' && *p <= '9')
+      m = m * 10 + (*p++ - '0');
+    if (h > 23 || m > 59)
+      return INVALID_MINUTES;
+    return (uint16_t)(h * 60 + m);
+  }
+
+  // Parses an iqama entry which is either an absolute "HH:MM" or a minute
+  // offset such as "+15" or "0" relative to the adhan time.
+  static uint16_t parseIqama(const char *str, uint16_t prayerMinutes) {
+    if (!str || prayerMinutes >= MINUTES_PER_DAY)
+      return INVALID_MINUTES;
+    if (strchr(str, ':') != nullptr)
+      return parseHHMM(str);
+    int offset = atoi(str);
+    return (uint16_t)((prayerMinutes + offset + MINUTES_PER_DAY) %
+                      MINUTES_PER_DAY);
+  }
+
+  // Writes "HH:MM" into out (at least 6 bytes); "--:--" when invalid
+  static void formatHHMM(uint16_t minutes, char *out) {
+    if (minutes >= MINUTES_PER_DAY) {
+      memcpy(out, "--:--", 6);
+      return;
+    }
+    out[0] = '0' + (minutes / 60) / 10;
+    out[1] = '0' + (minutes / 60) % 10;
+    out[2] = ':';
+    out[3] = '0' + (minutes % 60) / 10;
+    out[4] = '0' + (minutes % 60) % 10;
+    out[5] = '\0';
+  }
+};
+
+inline uint16_t minutesOfDay(const struct tm &t) {
+  return (uint16_t)(t.tm_hour * 60 + t.tm_min);
+}
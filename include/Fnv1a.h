@@ -0,0 +1,17 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 32-bit FNV-1a, for short file and cache keys and for body hashes.
+// Chainable: pass the previous result as seed to hash data read in pieces.
+constexpr uint32_t FNV1A_SEED = 2166136261u;
+
+inline uint32_t fnv1a(const uint8_t *data, size_t length,
+                      uint32_t seed = FNV1A_SEED) {
+  uint32_t hash = seed;
+  for (size_t i = 0; i < length; ++i) {
+    hash = (hash ^ data[i]) * 16777619u;
+  }
+  return hash;
+}
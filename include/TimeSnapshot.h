@@ -0,0 +1,34 @@
+#pragma once
+
+#include <Arduino.h>
+#include <DaySchedule.h>
+#include <time.h>
+
+// One reading of the clock, as epoch and local broken-down time (with the
+// TZ rules applied). Taken once per wake and passed by reference to the
+// render/scheduling code instead of calling getLocalTime() everywhere:
+// that call retries for up to 5 s while the RTC looks unset, and mktime()
+// was then used to convert the result back to an epoch.
+struct TimeSnapshot {
+  // Anything earlier means the RTC was never set (power loss, first boot)
+  static constexpr time_t MIN_VALID_EPOCH = 1704067200; // 2024-01-01
+
+  time_t epoch = 0;
+  struct tm local = {};
+  bool valid = false; // False until the RTC holds a real time
+
+  // Never blocks; check valid before using the fields
+  static TimeSnapshot now() {
+    TimeSnapshot snapshot;
+    snapshot.epoch = time(nullptr);
+    if (snapshot.epoch >= MIN_VALID_EPOCH) {
+      localtime_r(&snapshot.epoch, &snapshot.local);
+      snapshot.valid = true;
+    }
+    return snapshot;
+  }
+
+  uint16_t minutes() const {
+    return valid ? minutesOfDay(local) : DaySchedule::INVALID_MINUTES;
+  }
+};
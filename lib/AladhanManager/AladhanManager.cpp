@@ -1,8 +1,16 @@
 #include "AladhanManager.h"
+#include "AppState.h"
+#include "CalendarManager.h"
+#include "HttpCache.h"
 #include "SPIFFSHelper.h"
 #include <ArduinoJson.h>
 #include <HTTPClient.h>
-#include <WiFiClientSecure.h>
+#include <HttpsSession.h>
+
+// Test builds point this at tools/http_cache_mock.py
+#ifndef ALADHAN_API_URL
+#define ALADHAN_API_URL "http://api.aladhan.com"
+#endif
 
 struct FetchParams {
   float latitude;
@@ -10,21 +18,50 @@ struct FetchParams {
   int calculationMethod;
   int month;
   int year;
+  char timezoneName[40]; // IANA zone, empty = let Aladhan infer it
   AladhanManager::FetchCallback callback;
 };
 
+// Query-string escaping: "Etc/GMT+3" would otherwise reach the server as
+// "Etc/GMT 3". Unreserved characters and the zone's '/' are kept.
+static String urlEncode(const char *value) {
+  static const char HEX_DIGITS[] = "0123456789ABCDEF";
+  String out;
+  for (const char *p = value; *p; ++p) {
+    const unsigned char c = *p;
+    if (isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~' ||
+        c == '/') {
+      out += (char)c;
+    } else {
+      out += '%';
+      out += HEX_DIGITS[c >> 4];
+      out += HEX_DIGITS[c & 0x0F];
+    }
+  }
+  return out;
+}
+
 AladhanManager &AladhanManager::getInstance() {
   static AladhanManager instance;
   return instance;
 }
 
+bool AladhanManager::isValidMethod(int method) {
+  return method >= 0 && method <= 23 && method != 6;
+}
+
 void AladhanManager::asyncFetchMonthlyPrayerTimes(float latitude,
                                                    float longitude,
                                                    int calculationMethod,
                                                    int month, int year,
+                                                   const char *timezoneName,
                                                    FetchCallback callback) {
   FetchParams *params = new FetchParams{latitude, longitude, calculationMethod,
-                                        month, year, callback};
+                                        month, year, "", callback};
+  if (timezoneName) {
+    strncpy(params->timezoneName, timezoneName,
+            sizeof(params->timezoneName) - 1);
+  }
   xTaskCreate(fetchTask, "AladhanFetchTask", 16384, params, 1, nullptr);
 }
 
@@ -33,11 +70,15 @@ void AladhanManager::fetchTask(void *parameter) {
 
   // Build Aladhan API URL
   // Format: http://api.aladhan.com/v1/calendar/[year]/[month]?latitude=[lat]&longitude=[lon]&method=[method]
-  String url = "http://api.aladhan.com/v1/calendar/";
+  String url = ALADHAN_API_URL "/v1/calendar/";
   url += String(params->year) + "/" + String(params->month);
   url += "?latitude=" + String(params->latitude, 6);
   url += "&longitude=" + String(params->longitude, 6);
   url += "&method=" + String(params->calculationMethod);
+  if (params->timezoneName[0] != '\0') {
+    // Pin the zone so times match the device's TZ rules across DST
+    url += "&timezonestring=" + urlEncode(params->timezoneName);
+  }
 
   Serial.printf("📡 Fetching from Aladhan API: %s\n", url.c_str());
 
@@ -46,6 +87,12 @@ void AladhanManager::fetchTask(void *parameter) {
   const int MAX_RETRIES = 2;
   int httpCode = -1;
   String payload = "";
+  HttpCache::Validators validators;
+
+  // Conditional request only while the month is still on flash
+  const String prayerFilename =
+      CalendarManager::getMonthFilePath(params->year, params->month);
+  const bool haveCopy = fileExists(prayerFilename);
 
   // Retry loop
   for (int attempt = 1; attempt <= MAX_RETRIES + 1; attempt++) {
@@ -59,13 +106,18 @@ void AladhanManager::fetchTask(void *parameter) {
 
     http.begin(client, url);
     http.setTimeout(15000); // 15 second timeout
+    HttpCache::prepare(http, url, haveCopy);
     httpCode = http.GET();
 
     if (httpCode == HTTP_CODE_OK) {
       payload = http.getString();
+      validators = HttpCache::validators(http);
       Serial.printf("✅ Received %d bytes from Aladhan API\n", payload.length());
       http.end();
       break; // Success, exit retry loop
+    } else if (httpCode == HTTP_CODE_NOT_MODIFIED) {
+      http.end();
+      break;
     } else {
       Serial.printf("❌ Aladhan API request failed, code: %d (attempt %d/%d)\n", 
                     httpCode, attempt, MAX_RETRIES + 1);
@@ -78,7 +130,17 @@ void AladhanManager::fetchTask(void *parameter) {
     }
   }
 
-  if (httpCode == HTTP_CODE_OK) {
+  const uint32_t bodyHash =
+      fnv1a((const uint8_t *)payload.c_str(), payload.length());
+  if (httpCode == HTTP_CODE_NOT_MODIFIED ||
+      (httpCode == HTTP_CODE_OK && haveCopy &&
+       HttpCache::sameBody(url, bodyHash))) {
+    // Same calendar as the one on flash: no parse, no rewrite
+    Serial.printf("✅ Prayer times for %d/%d unchanged (%s)\n", params->month,
+                  params->year,
+                  httpCode == HTTP_CODE_NOT_MODIFIED ? "304" : "same hash");
+    success = true;
+  } else if (httpCode == HTTP_CODE_OK) {
     // Parse Aladhan API response
     JsonDocument doc;
     DeserializationError error = deserializeJson(doc, payload);
@@ -95,16 +157,14 @@ void AladhanManager::fetchTask(void *parameter) {
         return timeStr;
       };
 
-      // Build monthly prayer times and iqama times directly in CalendarManager format
+      // Build monthly prayer times directly in CalendarManager format
       // Format: { "month": X, "prayerCalender": { "1": [...], "2": [...] }, ... }
+      // Iqama times are not stored: CalendarManager derives them from the
+      // configured IqamaRules when it loads a day.
       JsonDocument prayerDoc;
       prayerDoc["month"] = params->month;
       JsonObject prayerCalendar = prayerDoc["prayerCalender"].to<JsonObject>();
 
-      JsonDocument iqamaDoc;
-      iqamaDoc["month"] = params->month;
-      JsonObject iqamaCalendar = iqamaDoc["iqamaCalendar"].to<JsonObject>();
-
       // Process each day in the month
       int dayNum = 1;
       for (JsonVariant dayData : data) {
@@ -119,21 +179,10 @@ void AladhanManager::fetchTask(void *parameter) {
         prayerArray.add(extractTime(timings["Maghrib"].as<String>()));
         prayerArray.add(extractTime(timings["Isha"].as<String>()));
 
-        // Iqama times array: [Fajr, Dhuhr, Asr, Maghrib, Isha] - no Sunrise
-        // Aladhan API doesn't provide iqama times, set to "0" (no delay)
-        // User can configure via BLE in future if needed
-        JsonArray iqamaArray = iqamaCalendar[String(dayNum)].to<JsonArray>();
-        iqamaArray.add("0"); // Fajr - no iqama delay
-        iqamaArray.add("0"); // Dhuhr - no iqama delay
-        iqamaArray.add("0"); // Asr - no iqama delay
-        iqamaArray.add("0"); // Maghrib - no iqama delay
-        iqamaArray.add("0"); // Isha - no iqama delay
-
         dayNum++;
       }
 
-      // Write prayer times to SPIFFS
-      String prayerFilename = "/prayer_times_month_" + String(params->month) + ".json";
+      // Write prayer times to flash
       String prayerOutput;
       serializeJson(prayerDoc, prayerOutput);
       if (!writeJsonFile(prayerFilename, prayerOutput)) {
@@ -141,18 +190,20 @@ void AladhanManager::fetchTask(void *parameter) {
         success = false;
       } else {
         Serial.printf("💾 Saved prayer times to %s\n", prayerFilename.c_str());
+        HttpCache::store(url, validators, bodyHash);
+        success = true;
       }
 
-      // Write iqama times to SPIFFS
-      String iqamaFilename = "/iqama_times_month_" + String(params->month) + ".json";
-      String iqamaOutput;
-      serializeJson(iqamaDoc, iqamaOutput);
-      if (!writeJsonFile(iqamaFilename, iqamaOutput)) {
-        Serial.printf("❌ Failed to save iqama times file\n");
-        success = false;
-      } else {
-        Serial.printf("💾 Saved iqama times to %s\n", iqamaFilename.c_str());
-        success = true;
+      // Drop the legacy year-less files for this month, they are no longer
+      // needed once a year-qualified one exists
+      String legacyFilename =
+          PRAYER_TIME_FILE_NAME + String(params->month) + ".json";
+      if (success && APP_FS.exists(legacyFilename)) {
+        APP_FS.remove(legacyFilename);
+      }
+      String iqamaFilename = IQAMA_TIME_FILE_NAME + String(params->month) + ".json";
+      if (APP_FS.exists(iqamaFilename)) {
+        APP_FS.remove(iqamaFilename);
       }
 
     } else {
@@ -190,10 +241,6 @@ void AladhanManager::asyncReverseGeocode(float latitude, float longitude,
 void AladhanManager::reverseGeocodeTask(void *parameter) {
   ReverseGeocodeParams *params = static_cast<ReverseGeocodeParams *>(parameter);
 
-  HTTPClient http;
-  WiFiClientSecure client;
-  client.setInsecure(); // Skip certificate validation for simplicity
-
   // Build Nominatim API URL
   String url = "https://nominatim.openstreetmap.org/reverse?format=json";
   url += "&lat=" + String(params->latitude, 6);
@@ -207,18 +254,28 @@ void AladhanManager::reverseGeocodeTask(void *parameter) {
   bool success = false;
   String cityName = "";
 
-  http.begin(client, url);
-  http.addHeader("User-Agent", "ESP32-PrayerTimes/1.0"); // Required by Nominatim
-  http.setTimeout(10000); // 10 second timeout
-  
-  int httpCode = http.GET();
+  HttpsSession::Lease lease(url);
+  HTTPClient &http = lease.http();
+  int httpCode = -1;
+  if (lease.ok()) {
+    http.begin(lease.client(), url);
+    http.addHeader("User-Agent", "ESP32-PrayerTimes/1.0"); // Required by Nominatim
+    http.setTimeout(10000); // 10 second timeout
+    httpCode = http.GET();
+  }
 
   if (httpCode == HTTP_CODE_OK) {
-    String payload = http.getString();
-    Serial.printf("✅ Received %d bytes from Nominatim\n", payload.length());
+    // Only the address block is needed out of the full place record
+    JsonDocument filter;
+    JsonObject addressFilter = filter["address"].to<JsonObject>();
+    for (const char *field :
+         {"city", "town", "village", "county", "state", "country"}) {
+      addressFilter[field] = true;
+    }
 
     JsonDocument doc;
-    DeserializationError error = deserializeJson(doc, payload);
+    DeserializationError error = HttpsSession::readJson(http, doc, filter);
+    Serial.println("✅ Received Nominatim response");
 
     if (!error) {
       JsonObject address = doc["address"];
@@ -284,7 +341,9 @@ void AladhanManager::reverseGeocodeTask(void *parameter) {
     Serial.printf("❌ Nominatim request failed, code: %d\n", httpCode);
   }
 
-  http.end();
+  if (lease.ok()) {
+    http.end();
+  }
 
   // Call callback with result
   if (params->callback) {
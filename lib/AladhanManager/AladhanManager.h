@@ -13,11 +13,16 @@ public:
 
   void asyncFetchMonthlyPrayerTimes(float latitude, float longitude,
                                     int calculationMethod, int month, int year,
+                                    const char *timezoneName,
                                     FetchCallback callback);
 
   void asyncReverseGeocode(float latitude, float longitude,
                           ReverseGeocodeCallback callback);
 
+  // Calculation methods the calendar endpoint knows: 0-23 except the
+  // unused 6. Custom (99) needs extra parameters the device never sends.
+  static bool isValidMethod(int method);
+
 private:
   AladhanManager() {}
   AladhanManager(const AladhanManager &) = delete;
@@ -53,9 +53,16 @@ ScreenLayout ScreenUI::computeLayout() const {
 
 void ScreenUI::fullRenderWithStatusBar(
     const ScreenLayout &L, const char *mosqueName, const char *countdownStr,
-    const char *prayerNames[5], const char *prayerTimes[5],
-    const char *iqamaTimes[5], int highlightIndex,
-    const StatusInfo &statusInfo) {
+    const char *prayerNames[5], const DaySchedule &schedule,
+    int highlightIndex, const StatusInfo &statusInfo, const TimeSnapshot &now) {
+  // Clock and the day/night weather icon come from the wake's time snapshot
+  char currentTimeStr[6] = "--:--";
+  bool isNight = false;
+  if (now.valid) {
+    DaySchedule::formatHHMM(now.minutes(), currentTimeStr);
+    isNight = schedule.isNight(now.minutes());
+  }
+
   d_.setFullWindow();
   d_.firstPage();
   do {
@@ -165,7 +172,7 @@ void ScreenUI::fullRenderWithStatusBar(
       int16_t iconY = baselineY - iconSize + 6;
       
       // Draw weather icon (left side, lowered by 6px)
-      drawWeatherIcon(rtcData.weatherDesc, iconX, iconY, iconSize);
+      drawWeatherIcon(rtcData.weatherDesc, isNight, iconX, iconY, iconSize);
       
       // Re-set font to 24pt before printing to ensure correct size
       d_.setFont(&Cairo_Bold24pt7b);
@@ -188,14 +195,6 @@ void ScreenUI::fullRenderWithStatusBar(
       d_.drawCircle(degreeX, degreeY, 5, GxEPD_WHITE); // Outer ring for thickness
     }
 
-    // Get current RTC time to display under countdown
-    struct tm timeinfo;
-    char currentTimeStr[6] = "00:00";
-    if (getLocalTime(&timeinfo)) {
-      snprintf(currentTimeStr, sizeof(currentTimeStr), "%02d:%02d",
-               timeinfo.tm_hour, timeinfo.tm_min);
-    }
-
     // Draw current RTC time centered vertically on screen
     d_.setFont(&Cairo_Bold40pt7b);
     d_.getTextBounds(currentTimeStr, 0, 0, &x1_count, &y1_count, &w_count,
@@ -213,18 +212,10 @@ void ScreenUI::fullRenderWithStatusBar(
     for (int i = 0; i < 5; i++) {
       const int16_t x = startX + i * (L.prayerBoxW + L.prayerSpacing);
 
-      // Calculate Iqama delay
-      int delay = 0;
-      if (prayerTimes[i] && iqamaTimes[i]) {
-        if (strchr(iqamaTimes[i], ':') == nullptr) {
-          delay = atoi(iqamaTimes[i]);
-        } else {
-          int prayerH = 0, prayerM = 0, iqamaH = 0, iqamaM = 0;
-          sscanf(prayerTimes[i], "%d:%d", &prayerH, &prayerM);
-          sscanf(iqamaTimes[i], "%d:%d", &iqamaH, &iqamaM);
-          delay = (iqamaH * 60 + iqamaM) - (prayerH * 60 + prayerM);
-        }
-      }
+      // Format prayer time and iqama delay only now, at draw time
+      char prayerTimeStr[6];
+      DaySchedule::formatHHMM(schedule.rowPrayer(i), prayerTimeStr);
+      int delay = schedule.iqamaDelay(i);
       char iqamaDelayStr[8];
       snprintf(iqamaDelayStr, sizeof(iqamaDelayStr), "+%d", delay);
 
@@ -247,12 +238,12 @@ void ScreenUI::fullRenderWithStatusBar(
 
       // Prayer Time
       d_.setFont(&Cairo_Bold24pt7b);
-      d_.getTextBounds(prayerTimes[i], 0, 0, &x1, &y1, &w, &h);
+      d_.getTextBounds(prayerTimeStr, 0, 0, &x1, &y1, &w, &h);
       int16_t timeX = x + (L.prayerBoxW - w) / 2 - x1;
       int16_t timeY = section2 - 10;
       d_.setTextColor(textColor);
       d_.setCursor(timeX, timeY);
-      d_.print(prayerTimes[i]);
+      d_.print(prayerTimeStr);
 
       // Iqama Delay (only show if delay > 0)
       if (delay > 0) {
@@ -270,19 +261,14 @@ void ScreenUI::fullRenderWithStatusBar(
 
 void ScreenUI::partialRenderWithStatusBar(
     const ScreenLayout &L, const char *mosqueName, const char *countdownStr,
-    const char *prayerNames[5], const char *prayerTimes[5],
-    const char *iqamaTimes[5], int highlightIndex,
-    const StatusInfo &statusInfo) {
+    const char *prayerNames[5], const DaySchedule &schedule,
+    int highlightIndex, const StatusInfo &statusInfo, const TimeSnapshot &now) {
   // Update status bar
   redrawStatusBarRegion(statusInfo);
 
-  // Get current RTC time to display under countdown
-  struct tm timeinfo;
-  char currentTimeStr[6] = "00:00";
-  if (getLocalTime(&timeinfo)) {
-    snprintf(currentTimeStr, sizeof(currentTimeStr), "%02d:%02d",
-             timeinfo.tm_hour, timeinfo.tm_min);
-  }
+  // Current time under the countdown, from the wake's time snapshot
+  char currentTimeStr[6];
+  DaySchedule::formatHHMM(now.minutes(), currentTimeStr);
 
   // Only update countdown with current time - skip header and prayer
   // boxes since they haven't changed
@@ -300,18 +286,9 @@ void ScreenUI::redrawStatusBarRegion(const StatusInfo &statusInfo) {
   } while (d_.nextPage());
 }
 
-int ScreenUI::getNextPrayerIndex(const char *times[5], int currentHour,
+int ScreenUI::getNextPrayerIndex(const DaySchedule &schedule, int currentHour,
                                  int currentMin) {
-  const int now = currentHour * 60 + currentMin;
-  for (int i = 0; i < 5; i++) {
-    int h = 0, m = 0;
-    if (times[i])
-      sscanf(times[i], "%d:%d", &h, &m);
-    const int t = h * 60 + m;
-    if (t > now)
-      return i;
-  }
-  return 0;
+  return schedule.nextRowIndex((uint16_t)(currentHour * 60 + currentMin));
 }
 
 void ScreenUI::drawTextBox(const char *text, int16_t x, int16_t y, int16_t wBox,
@@ -364,33 +341,8 @@ void ScreenUI::drawCenteredText(const char *text, int16_t centerX, int16_t topY,
   d_.print(text);
 }
 
-// Helper function to calculate Iqama delay
-int calculateIqamaDelay(const char *prayerTime, const char *iqamaTime) {
-  if (!prayerTime || !iqamaTime)
-    return 0;
-
-  // Check if iqamaTime is already a simple offset (e.g., "30" or "+30")
-  // If it doesn't contain a colon, it's already the delay in minutes
-  if (strchr(iqamaTime, ':') == nullptr) {
-    // It's already a minutes offset, just convert to int
-    return atoi(iqamaTime);
-  }
-
-  // Otherwise, calculate the difference between two absolute times
-  int prayerH = 0, prayerM = 0;
-  int iqamaH = 0, iqamaM = 0;
-
-  sscanf(prayerTime, "%d:%d", &prayerH, &prayerM);
-  sscanf(iqamaTime, "%d:%d", &iqamaH, &iqamaM);
-
-  int prayerMinutes = prayerH * 60 + prayerM;
-  int iqamaMinutes = iqamaH * 60 + iqamaM;
-
-  return iqamaMinutes - prayerMinutes;
-}
-
-void ScreenUI::drawPrayerTimeBoxes(const char *names[], const char *times[],
-                                   const char *iqamaTimes[], int count,
+void ScreenUI::drawPrayerTimeBoxes(const char *names[],
+                                   const DaySchedule &schedule, int count,
                                    int16_t startY, int16_t boxW, int16_t boxH,
                                    int16_t spacing, int highlightIndex) {
   const int16_t totalW = count * boxW + (count - 1) * spacing;
@@ -399,8 +351,9 @@ void ScreenUI::drawPrayerTimeBoxes(const char *names[], const char *times[],
   for (int i = 0; i < count; i++) {
     const int16_t x = startX + i * (boxW + spacing);
 
-    // Calculate Iqama delay
-    int delay = calculateIqamaDelay(times[i], iqamaTimes[i]);
+    char timeStr[6];
+    DaySchedule::formatHHMM(schedule.rowPrayer(i), timeStr);
+    int delay = schedule.iqamaDelay(i);
     char iqamaDelayStr[8];
     snprintf(iqamaDelayStr, sizeof(iqamaDelayStr), "+%d", delay);
 
@@ -430,12 +383,12 @@ void ScreenUI::drawPrayerTimeBoxes(const char *names[], const char *times[],
 
       // Prayer Time (second third)
       d_.setFont(&Cairo_Bold24pt7b);
-      d_.getTextBounds(times[i], 0, 0, &x1, &y1, &w, &h);
+      d_.getTextBounds(timeStr, 0, 0, &x1, &y1, &w, &h);
       int16_t timeX = x + (boxW - w) / 2 - x1;
       int16_t timeY = section2 - 5;
       d_.setTextColor(GxEPD_WHITE); // White text on black background
       d_.setCursor(timeX, timeY);
-      d_.print(times[i]);
+      d_.print(timeStr);
 
       // Iqama delay (third section) - only show if delay > 0
       if (delay > 0) {
@@ -464,12 +417,12 @@ void ScreenUI::drawPrayerTimeBoxes(const char *names[], const char *times[],
 
       // Prayer Time (second third)
       d_.setFont(&Cairo_Bold24pt7b);
-      d_.getTextBounds(times[i], 0, 0, &x1, &y1, &w, &h);
+      d_.getTextBounds(timeStr, 0, 0, &x1, &y1, &w, &h);
       int16_t timeX = x + (boxW - w) / 2 - x1;
       int16_t timeY = section2 - 5;
       d_.setTextColor(GxEPD_WHITE); // White text on black background
       d_.setCursor(timeX, timeY);
-      d_.print(times[i]);
+      d_.print(timeStr);
 
       // Iqama delay (third section) - only show if delay > 0
       if (delay > 0) {
@@ -556,18 +509,17 @@ void ScreenUI::redrawCountdownRegion(const ScreenLayout &L,
 }
 
 void ScreenUI::redrawPrayerRowRegion(const ScreenLayout &L,
-                                     const char *names[5], const char *times[5],
-                                     const char *iqamaTimes[5],
+                                     const char *names[5],
+                                     const DaySchedule &schedule,
                                      int highlightIndex) {
   d_.setPartialWindow(L.rowStartX, L.rowY, L.rowW, L.prayerBoxH);
   d_.firstPage();
   do {
     d_.fillRect(L.rowStartX, L.rowY, L.rowW, L.prayerBoxH,
                 GxEPD_BLACK); // Black background
-    drawPrayerTimeBoxes(
-        const_cast<const char **>(names), const_cast<const char **>(times),
-        const_cast<const char **>(iqamaTimes), 5, L.rowY, L.prayerBoxW,
-        L.prayerBoxH, L.prayerSpacing, highlightIndex);
+    drawPrayerTimeBoxes(const_cast<const char **>(names), schedule, 5, L.rowY,
+                        L.prayerBoxW, L.prayerBoxH, L.prayerSpacing,
+                        highlightIndex);
   } while (d_.nextPage());
 }
 
@@ -680,43 +632,9 @@ void ScreenUI::showInitializationScreenWithError(const char *errorMsg) {
   } while (d_.nextPage());
 }
 
-void ScreenUI::drawWeatherIcon(const char *weatherDesc, int16_t x, int16_t y, int16_t size) {
-  // Determine if it's night time based on prayer times (Maghrib to Fajr)
-  bool isNight = false;
-  struct tm timeinfo;
-  if (getLocalTime(&timeinfo)) {
-    // Get current time in minutes since midnight
-    int currentMinutes = timeinfo.tm_hour * 60 + timeinfo.tm_min;
-    
-    // Parse Maghrib time (HH:MM)
-    int maghribHour = 0, maghribMin = 0;
-    if (sscanf(rtcData.TODAY_MAGHRIB, "%d:%d", &maghribHour, &maghribMin) == 2) {
-      int maghribMinutes = maghribHour * 60 + maghribMin;
-      
-      // Parse Fajr time (HH:MM) - could be today or next day
-      int fajrHour = 0, fajrMin = 0;
-      const char* fajrTime = rtcData.TODAY_FAJR;
-      
-      // If current time is past midnight, we might need next day's Fajr
-      // But since Fajr is always early morning, TODAY_FAJR should be correct
-      if (sscanf(fajrTime, "%d:%d", &fajrHour, &fajrMin) == 2) {
-        int fajrMinutes = fajrHour * 60 + fajrMin;
-        
-        // Night time is: after Maghrib OR before Fajr
-        // Since Maghrib is in evening and Fajr is in early morning,
-        // we need to handle the day boundary
-        if (maghribMinutes > fajrMinutes) {
-          // Normal case: Maghrib (e.g., 18:00) > Fajr (e.g., 05:00)
-          // Night is: >= Maghrib OR < Fajr
-          isNight = (currentMinutes >= maghribMinutes || currentMinutes < fajrMinutes);
-        } else {
-          // Edge case: shouldn't happen, but handle it
-          isNight = (currentMinutes >= maghribMinutes && currentMinutes < fajrMinutes);
-        }
-      }
-    }
-  }
-  
+void ScreenUI::drawWeatherIcon(const char *weatherDesc, bool isNight,
+                               int16_t x, int16_t y, int16_t size) {
+  // isNight is derived from the schedule (Maghrib to Fajr) by the caller
   // Use appropriate font (day or night)
   if (isNight) {
     d_.setFont(&WeatherIconsNight50pt);
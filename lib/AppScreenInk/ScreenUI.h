@@ -2,6 +2,8 @@
 #pragma once
 #include "IEpaper.h"
 #include <Arduino.h>
+#include <DaySchedule.h>
+#include <TimeSnapshot.h>
 #include <gfxfont.h>
 
 // Cairo Google Fonts - converted to Adafruit GFX format
@@ -48,21 +50,22 @@ public:
   void fullRenderWithStatusBar(const ScreenLayout &L, const char *mosqueName,
                                const char *countdownStr,
                                const char *prayerNames[5],
-                               const char *prayerTimes[5],
-                               const char *iqamaTimes[5], int highlightIndex,
-                               const StatusInfo &statusInfo);
+                               const DaySchedule &schedule, int highlightIndex,
+                               const StatusInfo &statusInfo,
+                               const TimeSnapshot &now);
 
   void partialRenderWithStatusBar(const ScreenLayout &L, const char *mosqueName,
                                   const char *countdownStr,
                                   const char *prayerNames[5],
-                                  const char *prayerTimes[5],
-                                  const char *iqamaTimes[5], int highlightIndex,
-                                  const StatusInfo &statusInfo);
+                                  const DaySchedule &schedule,
+                                  int highlightIndex,
+                                  const StatusInfo &statusInfo,
+                                  const TimeSnapshot &now);
 
   void showInitializationScreen();
   void showInitializationScreenWithError(const char *errorMsg);
 
-  static int getNextPrayerIndex(const char *times[5], int currentHour,
+  static int getNextPrayerIndex(const DaySchedule &schedule, int currentHour,
                                 int currentMin);
 
   void redrawStatusBarRegion(const StatusInfo &statusInfo);
@@ -77,18 +80,16 @@ private:
                         const GFXfont *font);
   void drawTextWithoutBox(const char *text, int16_t x, int16_t y, int16_t wBox,
                           int16_t hBox, const GFXfont *font);
-  void drawPrayerTimeBoxes(const char *names[], const char *times[],
-                           const char *iqamaTimes[], // NEW PARAMETER
+  void drawPrayerTimeBoxes(const char *names[], const DaySchedule &schedule,
                            int count, int16_t startY, int16_t boxW,
                            int16_t boxH, int16_t spacing, int highlightIndex);
 
   void redrawCountdownRegion(const ScreenLayout &L, const char *countdownStr,
                              const char *currentTime);
   void redrawPrayerRowRegion(const ScreenLayout &L, const char *names[5],
-                             const char *times[5],
-                             const char *iqamaTimes[5], // NEW PARAMETER
-                             int highlightIndex);
+                             const DaySchedule &schedule, int highlightIndex);
   void redrawHeaderRegion(const ScreenLayout &L, const char *mosqueName,
                           const char *headerLabel);
-  void drawWeatherIcon(const char *weatherDesc, int16_t x, int16_t y, int16_t size);
+  void drawWeatherIcon(const char *weatherDesc, bool isNight, int16_t x,
+                       int16_t y, int16_t size);
 };
\ No newline at end of file
@@ -3,14 +3,15 @@
 #define STATUSBAR_H
 
 #include <Arduino.h>
+#include <HijriCalendar.h>
+#include <TimeSnapshot.h>
 #include <WiFi.h>
 #include <time.h>
 
 struct StatusInfo {
-  String currentTime; // "HH:MM" or awake counter (temporary debug)
+  String currentTime; // "HH:MM"
   String currentDate; // "Mon DD"
-  unsigned long awakeSeconds; // Cumulative awake seconds (temporary debug)
-  unsigned long wakeCycles;   // Number of wake cycles (temporary debug)
+  char hijriDate[24] = ""; // "15 Ramadan 1447" (cached per day in RTC)
   bool wifiConnected;
   int wifiRssi; // Signal strength
   bool bleAdvertising;
@@ -25,18 +26,18 @@ private:
   static const int BLE_ICON_HEIGHT = 48;
 
 public:
-  static StatusInfo getStatusInfo(bool bleAdvertising = false, unsigned long awakeSeconds = 0, unsigned long wakeCycles = 0) {
+  static StatusInfo getStatusInfo(const TimeSnapshot &now,
+                                  bool bleAdvertising = false) {
     StatusInfo status;
 
-    // Get current time and date
-    struct tm timeinfo;
-    if (getLocalTime(&timeinfo)) {
+    // Time and date come from the wake's time snapshot
+    if (now.valid) {
+      const struct tm &timeinfo = now.local;
       status.timeValid = true;
       
-      // TEMPORARY DEBUG: Show awake counter and cycles instead of current time
-      char awakeStr[24];
-      sprintf(awakeStr, "%lus #%lu", awakeSeconds, wakeCycles);
-      status.currentTime = String(awakeStr);
+      char timeStr[6];
+      DaySchedule::formatHHMM(now.minutes(), timeStr);
+      status.currentTime = String(timeStr);
 
       // Format date as "Mon DD" for compact display
       const char *dayNames[] = {"Sun", "Mon", "Tue", "Wed",
@@ -47,16 +48,15 @@ public:
       sprintf(dateStr, "%s %02d", monthNames[timeinfo.tm_mon],
               timeinfo.tm_mday);
       status.currentDate = String(dateStr);
+
+      HijriCalendar::format(HijriCalendar::today(timeinfo), status.hijriDate,
+                            sizeof(status.hijriDate));
     } else {
       status.timeValid = false;
       status.currentTime = "--:--";
       status.currentDate = "-- --";
     }
 
-    // Store awake seconds and cycles
-    status.awakeSeconds = awakeSeconds;
-    status.wakeCycles = wakeCycles;
-
     // WiFi status
     status.wifiConnected = (WiFi.status() == WL_CONNECTED);
     if (status.wifiConnected) {
@@ -132,9 +132,17 @@ public:
     display.drawLine(0, STATUS_BAR_HEIGHT, screenWidth, STATUS_BAR_HEIGHT,
                      0xFFFF); // White line
 
-    // Left side: Date
+    // Left side: Date, followed by the Hijri date when available
     display.setCursor(MARGIN, STATUS_BAR_HEIGHT - 6);
     display.print(status.currentDate.c_str());
+    if (status.hijriDate[0] != '\0') {
+      int16_t dateX, dateY;
+      uint16_t dateW, dateH;
+      display.getTextBounds(status.currentDate.c_str(), 0, 0, &dateX, &dateY,
+                            &dateW, &dateH);
+      display.setCursor(MARGIN + dateX + dateW + 12, STATUS_BAR_HEIGHT - 6);
+      display.print(status.hijriDate);
+    }
 
     // Center: Current Time
     int16_t timeX, timeY;
@@ -186,4 +194,4 @@ private:
   }
 };
 
-#endif // STATUSBAR_H
\ No newline at end of file
+#endif // STATUSBAR_H
\ No newline at end of file
@@ -1,66 +1,46 @@
 #include "AppStateManager.h"
+#include <Logger.h>
+#include <esp_rom_crc.h>
+#include <stddef.h>
 
 // ✅ Here you really allocate the RTC variable
 RTC_DATA_ATTR RTCData rtcData;
 
 #define RTC_MAGIC_VALID 0xBEEF1234
 
-void AppStateManager::load() {
-  if (rtcData.rtcMagic != RTC_MAGIC_VALID) {
-    Serial.println("🧹 RTC memory invalid, reinitializing...");
-    memset(&rtcData, 0, sizeof(rtcData));
-
-    strncpy(rtcData.TODAY_FAJR, "00:00", sizeof(rtcData.TODAY_FAJR));
-    strncpy(rtcData.TODAY_IQAMA_FAJR, "00:00",
-            sizeof(rtcData.TODAY_IQAMA_FAJR));
-    strncpy(rtcData.NEXT_DAY_FAJR, "00:00", sizeof(rtcData.NEXT_DAY_FAJR));
-    strncpy(rtcData.NEXT_DAY_IQAMA_FAJR, "00:00",
-            sizeof(rtcData.NEXT_DAY_IQAMA_FAJR));
-
-    strncpy(rtcData.TODAY_DHUHR, "00:00", sizeof(rtcData.TODAY_DHUHR));
-    strncpy(rtcData.TODAY_IQAMA_DHUHR, "00:00",
-            sizeof(rtcData.TODAY_IQAMA_DHUHR));
-    strncpy(rtcData.NEXT_DAY_DHUHR, "00:00", sizeof(rtcData.NEXT_DAY_DHUHR));
-    strncpy(rtcData.NEXT_DAY_IQAMA_DHUHR, "00:00",
-            sizeof(rtcData.NEXT_DAY_IQAMA_DHUHR));
-
-    strncpy(rtcData.TODAY_ASR, "00:00", sizeof(rtcData.TODAY_ASR));
-    strncpy(rtcData.TODAY_IQAMA_ASR, "00:00", sizeof(rtcData.TODAY_IQAMA_ASR));
-    strncpy(rtcData.NEXT_DAY_ASR, "00:00", sizeof(rtcData.NEXT_DAY_ASR));
-    strncpy(rtcData.NEXT_DAY_IQAMA_ASR, "00:00",
-            sizeof(rtcData.NEXT_DAY_IQAMA_ASR));
-
-    strncpy(rtcData.TODAY_MAGHRIB, "00:00", sizeof(rtcData.TODAY_MAGHRIB));
-    strncpy(rtcData.TODAY_IQAMA_MAGHRIB, "00:00",
-            sizeof(rtcData.TODAY_IQAMA_MAGHRIB));
-    strncpy(rtcData.NEXT_DAY_MAGHRIB, "00:00",
-            sizeof(rtcData.NEXT_DAY_MAGHRIB));
-    strncpy(rtcData.NEXT_DAY_IQAMA_MAGHRIB, "00:00",
-            sizeof(rtcData.NEXT_DAY_IQAMA_MAGHRIB));
-
-    strncpy(rtcData.TODAY_ISHA, "00:00", sizeof(rtcData.TODAY_ISHA));
-    strncpy(rtcData.TODAY_IQAMA_ISHA, "00:00",
-            sizeof(rtcData.TODAY_IQAMA_ISHA));
-    strncpy(rtcData.NEXT_DAY_ISHA, "00:00", sizeof(rtcData.NEXT_DAY_ISHA));
-    strncpy(rtcData.NEXT_DAY_IQAMA_ISHA, "00:00",
-            sizeof(rtcData.NEXT_DAY_IQAMA_ISHA));
+static uint32_t computeCrc(const RTCData &data) {
+  const size_t payloadOffset = offsetof(RTCData, crc) + sizeof(data.crc);
+  const uint8_t *payload =
+      reinterpret_cast<const uint8_t *>(&data) + payloadOffset;
+  return esp_rom_crc32_le(0, payload, sizeof(RTCData) - payloadOffset);
+}
 
-    strncpy(rtcData.TODAY_SUNRISE, "00:00", sizeof(rtcData.TODAY_SUNRISE));
-    strncpy(rtcData.NEXT_DAY_SUNRISE, "00:00",
-            sizeof(rtcData.NEXT_DAY_SUNRISE));
+bool AppStateManager::load() {
+  const char *reason = nullptr;
+  if (rtcData.rtcMagic != RTC_MAGIC_VALID) {
+    reason = "magic";
+  } else if (rtcData.schemaVersion != RTC_SCHEMA_VERSION ||
+             rtcData.layoutSize != sizeof(RTCData)) {
+    reason = "schema version";
+  } else if (rtcData.crc != computeCrc(rtcData)) {
+    reason = "CRC";
+  }
 
-    rtcData.mosqueLastUpdateMillis = 0;
-    rtcData.userEventsUpdateMillis = 0;
-    rtcData.day = 0;
-    rtcData.month = 0;
-    strncpy(rtcData.mosqueUUID, "", sizeof(rtcData.mosqueUUID)); // Initialize mosque UUID as empty
-    rtcData.rtcMagic = RTC_MAGIC_VALID;
-  } else {
-    Serial.println("✅ RTC memory valid, loaded");
+  if (reason) {
+    LOG_W("🧹 RTC memory invalid (%s), reinitializing...", reason);
+    rtcData = RTCData();
+    save();
+    return false;
   }
+
+  LOG_D("✅ RTC memory valid, loaded");
+  return true;
 }
 
 void AppStateManager::save() {
   rtcData.rtcMagic = RTC_MAGIC_VALID;
-  Serial.println("✅ RTC memory saved");
+  rtcData.schemaVersion = RTC_SCHEMA_VERSION;
+  rtcData.layoutSize = sizeof(RTCData);
+  rtcData.crc = computeCrc(rtcData);
+  LOG_D("✅ RTC memory saved");
 }
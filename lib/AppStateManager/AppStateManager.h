@@ -1,73 +1,85 @@
 #pragma once
 #include <Arduino.h>
+#include <CalendarManager.h>
+#include <DaySchedule.h>
+#include <FetchBackoff.h>
+#include <HijriCalendar.h>
+#include <IqamaRules.h>
+#include <WeatherManager.h>
+
+// Bump whenever the layout of RTCData changes. A mismatch on wake discards
+// the whole block instead of reinterpreting stale bytes.
+#define RTC_SCHEMA_VERSION 13
 
 struct RTCData {
+  // ---- Header (validated by AppStateManager::load) ----
   uint32_t rtcMagic = 0;
+  uint16_t schemaVersion = 0;
+  uint16_t layoutSize = 0; // sizeof(RTCData), catches a forgotten version bump
+  uint32_t crc = 0;        // CRC32 of every byte after this field
 
+  // ---- Payload (fields grouped by size to avoid padding) ----
   time_t mosqueLastUpdateMillis = 0;
   time_t userEventsUpdateMillis = 0;
+  time_t weatherLastUpdate = 0; // Last weather update timestamp
+  time_t nextTzTransition = 0;  // Next DST switch (UTC epoch), 0 = unknown
+  time_t lastCalendarAttempt = 0; // Last prayer month fetch attempt
 
-  char TODAY_FAJR[6] = "00:00";
-  char TODAY_IQAMA_FAJR[6] = "00:00";
-  char NEXT_DAY_FAJR[6] = "00:00";
-  char NEXT_DAY_IQAMA_FAJR[6] = "00:00";
-
-  char TODAY_DHUHR[6] = "00:00";
-  char TODAY_IQAMA_DHUHR[6] = "00:00";
-  char NEXT_DAY_DHUHR[6] = "00:00";
-  char NEXT_DAY_IQAMA_DHUHR[6] = "00:00";
-
-  char TODAY_ASR[6] = "00:00";
-  char TODAY_IQAMA_ASR[6] = "00:00";
-  char NEXT_DAY_ASR[6] = "00:00";
-  char NEXT_DAY_IQAMA_ASR[6] = "00:00";
-
-  char TODAY_MAGHRIB[6] = "00:00";
-  char TODAY_IQAMA_MAGHRIB[6] = "00:00";
-  char NEXT_DAY_MAGHRIB[6] = "00:00";
-  char NEXT_DAY_IQAMA_MAGHRIB[6] = "00:00";
+  // RTC slow clock drift model (see RTCManager::applyDriftCorrection)
+  time_t lastNtpSync = 0;         // Epoch of the last successful NTP sync
+  time_t lastNtpAttempt = 0;      // Epoch of the last sync attempt (any result)
+  time_t lastDriftCorrection = 0; // Epoch the drift correction last ran
 
-  char TODAY_ISHA[6] = "00:00";
-  char TODAY_IQAMA_ISHA[6] = "00:00";
-  char NEXT_DAY_ISHA[6] = "00:00";
-  char NEXT_DAY_IQAMA_ISHA[6] = "00:00";
+  // Cached prayer/iqama minutes for the day stored in day/month and the day
+  // after it (see CalendarManager::fetchTodayAndNextDayPrayerTimes)
+  DaySchedule today;
+  DaySchedule nextDay;
+  ScheduleWindow scheduleWindow; // The coming week, refilled from flash
+  IqamaRuleSet iqamaRules; // Evaluated into the schedules above on load
+  HijriCache hijri;        // Recomputed once per Gregorian day
+  WeatherForecast weather; // Hourly, source of currentTemp/weatherDesc
+  FetchBackoffState backoff; // Retry spacing and radio budget per source
 
-  char TODAY_SUNRISE[6] = "00:00";
-  char NEXT_DAY_SUNRISE[6] = "00:00";
-
-  int day = 0;
-  int month = 0;
-
-  char mosqueUUID[40] =
-      ""; // Store mosque UUID (36 chars + null terminator + padding) - DEPRECATED, use lat/lon
-  
   // NEW: Location-based prayer times configuration
   float latitude = 0.0;  // Location latitude for prayer times calculation
   float longitude = 0.0; // Location longitude for prayer times calculation
   int calculationMethod = 4; // Calculation method (4 = Umm Al-Qura, Makkah)
-  char cityName[50] = ""; // City name from Aladhan API
-  
-  int timezoneOffsetSeconds = 0; // Timezone offset in seconds (e.g., 3600 for UTC+1)
+
+  int timezoneOffsetSeconds = 0; // Fixed offset, used when posixTz is empty
   int wifiRetryCount = 0; // Track WiFi connection failures
   int bootCount = 0;      // Track rapid reboots for factory reset detection
   unsigned long lastBootMillis =
       0; // Last boot time in milliseconds (from millis())
-  
+
   // Weather information
-  float currentTemp = 0.0;        // Current temperature in Celsius
-  char weatherDesc[20] = "";      // Weather description (e.g., "Clear", "Rain")
-  time_t weatherLastUpdate = 0;   // Last weather update timestamp
-  
+  float currentTemp = 0.0; // Temperature shown, from the forecast hour
+  float rtcDriftPpm = 0.0; // Estimated RTC error, positive = RTC runs fast
+
   // Awake time tracking (temporary debug feature)
   unsigned long cumulativeAwakeSeconds = 0;  // Total seconds awake across all cycles
   unsigned long wakeStartMillis = 0;         // millis() when device woke up
   unsigned long wakeCycleCount = 0;          // Number of wake cycles (runs)
+
+  uint8_t day = 0;   // Day of month the cached schedule belongs to
+  uint8_t month = 0; // Month of the cached schedule (1..12)
+  int8_t hijriAdjustmentDays = 0; // Local moon sighting correction
+  uint8_t driftSamples = 0;       // NTP syncs that contributed to rtcDriftPpm
+  bool offlineMode = false; // Set up over BLE only; Wi-Fi is never started
+
+  char weatherDesc[20] = ""; // Weather description (e.g., "Clear", "Rain")
+  char cityName[50] = "";    // City name from Aladhan API
+  char posixTz[48] = "";     // POSIX TZ rules, e.g. "CET-1CEST,M3.5.0,M10.5.0/3"
+  char timezoneName[40] = ""; // IANA name passed to Aladhan ("Europe/Paris")
+  char mosqueUUID[40] =
+      ""; // Store mosque UUID (36 chars + null terminator + padding) - DEPRECATED, use lat/lon
 };
 
 extern RTCData rtcData;
 
 class AppStateManager {
 public:
-  static void load();
+  // Returns true if the RTC block survived (magic, version, size and CRC all
+  // match); otherwise it is reset to defaults and false is returned.
+  static bool load();
   static void save();
 };
@@ -0,0 +1,237 @@
+#include "AudioManager.h"
+#include "AppState.h"
+#include "SPIFFSHelper.h"
+#include <AudioFileSourceBuffer.h>
+#include <AudioFileSourceFS.h>
+#include <AudioGeneratorMP3.h>
+#include <AudioOutputI2S.h>
+#include <CpuGovernor.h>
+#include <HttpsSession.h>
+#include <Logger.h>
+#include <WiFi.h>
+#include <sys/time.h>
+
+// Flash kept free for month files, settings and TLS sessions
+static const size_t FLASH_RESERVE = 16 * 1024;
+static const uint32_t READ_BUFFER_BYTES = 4096;
+
+struct DownloadParams {
+  AudioManager::DownloadCallback callback;
+};
+
+RTC_DATA_ATTR static time_t nextAdhan = 0;
+
+static AudioFileSourceFS *source = nullptr;
+static AudioFileSourceBuffer *buffer = nullptr;
+static AudioOutputI2S *output = nullptr;
+static AudioGeneratorMP3 *mp3 = nullptr;
+static volatile bool playing = false;
+
+AudioManager &AudioManager::getInstance() {
+  static AudioManager instance;
+  return instance;
+}
+
+bool AudioManager::hasAdhan() { return fileExists(ADHAN_FILE); }
+
+// ===================== 📥 Download =====================
+void AudioManager::asyncDownloadAdhan(DownloadCallback callback) {
+  DownloadParams *params = new DownloadParams{callback};
+  xTaskCreate(downloadTask, "AdhanDownloadTask", 8192, params, 1, nullptr);
+}
+
+// Passes the body through to the file, keeping its first bytes for the
+// format check
+class HeadStream : public Stream {
+public:
+  explicit HeadStream(Stream &target) : target(target) {}
+
+  size_t write(uint8_t data) override { return write(&data, 1); }
+  size_t write(const uint8_t *buf, size_t size) override {
+    for (size_t i = 0; i < size && kept < sizeof(head); i++) {
+      head[kept++] = buf[i];
+    }
+    return target.write(buf, size);
+  }
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+  void flush() override { target.flush(); }
+
+  // An ID3 tag or an MPEG audio frame sync, not an error page
+  bool looksLikeMp3() const {
+    if (kept < sizeof(head)) {
+      return false;
+    }
+    return memcmp(head, "ID3", 3) == 0 ||
+           (head[0] == 0xFF && (head[1] & 0xE0) == 0xE0);
+  }
+
+private:
+  Stream &target;
+  uint8_t head[3];
+  size_t kept = 0;
+};
+
+void AudioManager::downloadTask(void *parameter) {
+  DownloadParams *params = static_cast<DownloadParams *>(parameter);
+  bool success = false;
+
+  // The shared session's TLS client; redirects stay on https
+  HttpsSession::Lease lease(ADHAN_URL);
+  LOG_I("📡 Downloading adhan from %s", ADHAN_URL);
+  if (!lease.ok() || WiFi.status() != WL_CONNECTED ||
+      !lease.http().begin(lease.client(), ADHAN_URL)) {
+    LOG_E("❌ Adhan download could not start");
+  } else {
+    HTTPClient &http = lease.http();
+    http.setFollowRedirects(HTTPC_STRICT_FOLLOW_REDIRECTS);
+    http.setTimeout(15000);
+    const int httpCode = http.GET();
+    const int size = http.getSize(); // -1 when chunked
+    const size_t freeBytes = APP_FS.totalBytes() - APP_FS.usedBytes();
+    if (httpCode != HTTP_CODE_OK) {
+      LOG_W("⚠️ Adhan download failed, code %d", httpCode);
+    } else if (size <= 0) {
+      // A cut chunked body could not be told from a complete one, and a
+      // truncated file would never be fetched again
+      LOG_W("⚠️ Adhan response has no Content-Length");
+    } else if ((size_t)size + FLASH_RESERVE > freeBytes) {
+      LOG_E("❌ No room for a %d byte adhan (%u free)", size,
+            (unsigned)freeBytes);
+    } else {
+      File file = beginAtomicWrite(ADHAN_FILE);
+      if (!file) {
+        LOG_E("❌ Cannot create %s", ADHAN_FILE);
+      } else {
+        HeadStream sink(file);
+        const int written = http.writeToStream(&sink);
+        const bool complete = written == size;
+        success = complete && sink.looksLikeMp3();
+        commitAtomicWrite(file, ADHAN_FILE, success);
+        if (success) {
+          LOG_I("💾 Adhan saved, %d bytes", written);
+        } else if (!complete) {
+          LOG_W("⚠️ Adhan download cut short (%d/%d bytes)", written, size);
+        } else {
+          LOG_W("⚠️ Adhan download is not an MP3 file");
+        }
+      }
+    }
+    http.end();
+    // The other fetches of the session do not follow redirects. A redirect
+    // may also have moved the connection to another host than the session
+    // recorded; a one-off download gains nothing from keep-alive.
+    http.setFollowRedirects(HTTPC_DISABLE_FOLLOW_REDIRECTS);
+    lease.client().stop();
+  }
+
+  if (params->callback) {
+    params->callback(success);
+  }
+  delete params;
+  vTaskDelete(nullptr);
+}
+
+// ===================== ⏰ Schedule =====================
+void AudioManager::schedule(time_t at) { nextAdhan = ADHAN_ENABLED ? at : 0; }
+
+time_t AudioManager::wakeTime() {
+  return nextAdhan != 0 ? nextAdhan - ADHAN_PREROLL_SECONDS : 0;
+}
+
+bool AudioManager::isDue(time_t now) {
+  // A second of slack for a timer that fires a little early
+  return nextAdhan != 0 && now >= nextAdhan - ADHAN_PREROLL_SECONDS - 1 &&
+         now < nextAdhan + 60;
+}
+
+// ===================== 🔊 Playback =====================
+static void release() {
+  delete mp3;
+  delete output;
+  delete buffer;
+  delete source;
+  mp3 = nullptr;
+  output = nullptr;
+  buffer = nullptr;
+  source = nullptr;
+  CpuGovernor::setFloor(0);
+}
+
+static void waitUntil(time_t at) {
+  struct timeval now;
+  gettimeofday(&now, nullptr);
+  const int64_t remainingMs =
+      ((int64_t)at - now.tv_sec) * 1000 - now.tv_usec / 1000;
+  if (remainingMs > 0) {
+    delay(remainingMs);
+  }
+}
+
+bool AudioManager::startAdhan() {
+  const time_t at = nextAdhan;
+  nextAdhan = 0; // Played at most once, even if this wake fails
+  if (at == 0 || !hasAdhan()) {
+    return false;
+  }
+
+  // Pre-roll: clock up, file open, decoder and I2S started while there is
+  // still time before the prayer
+  CpuGovernor::setFloor(CPU_MHZ_AUDIO);
+  CpuGovernor::apply(WakeProfiler::currentPhase());
+  source = new AudioFileSourceFS(APP_FS, ADHAN_FILE);
+  if (!source->isOpen()) {
+    LOG_E("❌ Cannot open %s", ADHAN_FILE);
+    release();
+    return false;
+  }
+  buffer = new AudioFileSourceBuffer(source, READ_BUFFER_BYTES);
+  output = new AudioOutputI2S();
+  output->SetPinout(AUDIO_I2S_BCLK, AUDIO_I2S_LRC, AUDIO_I2S_DIN);
+  output->SetOutputModeMono(true);
+  output->SetGain(ADHAN_GAIN);
+  mp3 = new AudioGeneratorMP3();
+  if (!mp3->begin(buffer, output)) {
+    LOG_E("❌ Adhan decoder failed to start");
+    release();
+    return false;
+  }
+
+  waitUntil(at);
+  playing = true;
+  // Core 0: the display refresh on the loop core must not starve decoding
+  if (xTaskCreatePinnedToCore(playTask, "AdhanPlayTask", 12288, nullptr, 3,
+                              nullptr, 0) != pdPASS) {
+    LOG_E("❌ Adhan task not started");
+    playing = false;
+    release();
+    return false;
+  }
+  LOG_I("🔊 Adhan started");
+  return true;
+}
+
+void AudioManager::playTask(void *parameter) {
+  const unsigned long started = millis();
+  while (mp3->isRunning() && mp3->loop()) {
+    if (millis() - started > ADHAN_MAX_SECONDS * 1000UL) {
+      LOG_W("⚠️ Adhan stopped after %d s", ADHAN_MAX_SECONDS);
+      break;
+    }
+    delay(1); // loop() returns at once while the I2S DMA is full
+  }
+  mp3->stop();
+  LOG_I("🔇 Adhan finished after %lu s", (millis() - started) / 1000);
+  release();
+  playing = false;
+  vTaskDelete(nullptr);
+}
+
+bool AudioManager::isPlaying() { return playing; }
+
+void AudioManager::waitUntilDone() {
+  while (playing) {
+    delay(100);
+  }
+}
@@ -0,0 +1,78 @@
+#ifndef AUDIO_MANAGER_H
+#define AUDIO_MANAGER_H
+
+#include <Arduino.h>
+#include <functional>
+#include <time.h>
+
+// Adhan at each prayer (not sunrise), played from flash. Build with
+// -DADHAN_ENABLED=0 for a device without a speaker.
+#ifndef ADHAN_ENABLED
+#define ADHAN_ENABLED 1
+#endif
+#ifndef ADHAN_URL
+#define ADHAN_URL "https://www.mp3quran.net/api/adhan_madinah.mp3"
+#endif
+// The timer wake comes this much earlier to open the file and start the
+// decoder and I2S, so the first sample goes out on the prayer time
+#ifndef ADHAN_PREROLL_SECONDS
+#define ADHAN_PREROLL_SECONDS 3
+#endif
+#ifndef ADHAN_GAIN
+#define ADHAN_GAIN 0.5f // 0.0 .. 4.0
+#endif
+// Safety stop for a damaged file
+#ifndef ADHAN_MAX_SECONDS
+#define ADHAN_MAX_SECONDS (10 * 60)
+#endif
+
+// I2S amplifier (MAX98357A)
+#ifndef AUDIO_I2S_BCLK
+#define AUDIO_I2S_BCLK 17
+#endif
+#ifndef AUDIO_I2S_LRC
+#define AUDIO_I2S_LRC 18
+#endif
+#ifndef AUDIO_I2S_DIN
+#define AUDIO_I2S_DIN 21
+#endif
+
+// MP3 decoding needs this clock; CpuGovernor keeps it while playing
+#ifndef CPU_MHZ_AUDIO
+#define CPU_MHZ_AUDIO 160
+#endif
+
+class AudioManager {
+private:
+  AudioManager() {}
+  AudioManager(const AudioManager &) = delete;
+  AudioManager &operator=(const AudioManager &) = delete;
+
+  static void downloadTask(void *parameter);
+  static void playTask(void *parameter);
+
+public:
+  static AudioManager &getInstance();
+
+  using DownloadCallback = std::function<void(bool success)>;
+
+  // ADHAN_URL to ADHAN_FILE; Wi-Fi must be up
+  void asyncDownloadAdhan(DownloadCallback callback);
+  static bool hasAdhan();
+
+  // Next adhan (UTC epoch), kept in RTC memory; 0 clears it
+  static void schedule(time_t at);
+  // When the timer has to wake for the pre-roll, 0 if nothing is scheduled
+  static time_t wakeTime();
+  // True from the pre-roll until a minute after the adhan time
+  static bool isDue(time_t now);
+
+  // Pre-rolls the scheduled adhan and returns once it has started playing;
+  // playback continues in its own task. Needs the filesystem mounted.
+  static bool startAdhan();
+  static bool isPlaying();
+  // Blocks until playback has ended (call before deep sleep)
+  static void waitUntilDone();
+};
+
+#endif // AUDIO_MANAGER_H
@@ -1,5 +1,6 @@
 #include "BLEManager.h"
 #include "BLEDevice.h"
+#include <BleProtocol.h>
 #include "RTCManager.h"
 #include "SPIFFSHelper.h"
 #include "WiFiManager.h"
@@ -13,14 +14,30 @@
   "b8b3f5a4-12d5-4d8f-9b6c-8a7f4c1e2d40"
 #define CHARACTERISTIC_TIME_UUID "b8b3f5a4-12d5-4d8f-9b6c-8a7f4c1e2d41"
 #define CHARACTERISTIC_WIFI_SCAN_UUID "b8b3f5a4-12d5-4d8f-9b6c-8a7f4c1e2d42"
+// Framed binary protocol (BleProtocol.h); the JSON characteristics above
+// stay for older app versions
+#define CHARACTERISTIC_PROTOCOL_UUID "b8b3f5a4-12d5-4d8f-9b6c-8a7f4c1e2d43"
+// Read-only field counters. No notifications: the record is larger than
+// most MTUs (23 by default, 185 on iOS), so the phone reads it with a long
+// read, which the stack serves in MTU-sized pieces
+#define CHARACTERISTIC_TELEMETRY_UUID "b8b3f5a4-12d5-4d8f-9b6c-8a7f4c1e2d44"
+
+// Pause between notifications so the controller's TX queue keeps up
+#ifndef BLE_FRAME_GAP_MS
+#define BLE_FRAME_GAP_MS 5
+#endif
 
 BLEManager::NotificationToggleCallback BLEManager::notificationCallback =
     nullptr;
 
 BLEManager::JsonReceivedCallback BLEManager::jsonCallback = nullptr;
+BLEManager::MessageCallback BLEManager::messageCallback = nullptr;
 BLECharacteristic *pJsonCharacteristic = nullptr;
 BLECharacteristic *pTimeCharacteristic = nullptr;
 BLECharacteristic *pWifiScanCharacteristic = nullptr;
+BLECharacteristic *pProtocolCharacteristic = nullptr;
+BLECharacteristic *pTelemetryCharacteristic = nullptr;
+static BleProtocol::Reassembler incoming;
 BLEServer *pServer = nullptr;
 
 String bleReceivedJson = "";
@@ -49,6 +66,15 @@ void BLEManager::invokeJsonReceivedCallback(const String &json) {
   }
 }
 
+void BLEManager::onMessage(MessageCallback cb) { messageCallback = cb; }
+
+void BLEManager::invokeMessageCallback(uint8_t type, const uint8_t *data,
+                                       size_t length) {
+  if (messageCallback) {
+    messageCallback(type, data, length);
+  }
+}
+
 // ===================== 🟡 BLE Callbacks =====================
 class NotifyStatusDescriptorCallback : public BLEDescriptorCallbacks {
   void onWrite(BLEDescriptor *pDesc) override {
@@ -69,6 +95,29 @@ class JsonReceivedCallbacks : public BLECharacteristicCallbacks {
   }
 };
 
+class ProtocolCallbacks : public BLECharacteristicCallbacks {
+  void onWrite(BLECharacteristic *pChar) override {
+    std::string value = pChar->getValue();
+    switch (incoming.push((const uint8_t *)value.data(), value.size())) {
+    case BleProtocol::Reassembler::COMPLETE:
+      Serial.printf("📥 BLE message 0x%02x, %u bytes\n", incoming.type(),
+                    (unsigned)incoming.size());
+      BLEManager::invokeMessageCallback(incoming.type(), incoming.data(),
+                                        incoming.size());
+      break;
+    case BleProtocol::Reassembler::ERROR: {
+      Serial.println("⚠️ Bad BLE frame, message dropped");
+      uint8_t status = BleProtocol::STATUS_BAD_FRAME;
+      BLEManager::getInstance().sendMessage(BleProtocol::MSG_STATUS, &status,
+                                            1);
+      break;
+    }
+    default:
+      break;
+    }
+  }
+};
+
 class TimeReceivedCallbacks : public BLECharacteristicCallbacks {
   void onWrite(BLECharacteristic *pChar) override {
     std::string value = pChar->getValue();
@@ -86,6 +135,7 @@ class MyServerCallbacks : public BLEServerCallbacks {
   void onDisconnect(BLEServer *pServer) override {
     Serial.println("📴 Phone disconnected");
     isConnected = false;
+    incoming.reset();
     BLEDevice::startAdvertising();
   }
 };
@@ -95,6 +145,8 @@ void BLEManager::setupBLE() {
   Serial.println("🔵 Initializing BLE...");
   esp_log_level_set("BLEDevice", ESP_LOG_WARN);
   BLEDevice::init("Kwaizar");
+  // The phone starts the MTU exchange; this is what we accept
+  BLEDevice::setMTU(BleProtocol::PREFERRED_MTU);
 
   pServer = BLEDevice::createServer();
   pServer->setCallbacks(new MyServerCallbacks());
@@ -116,6 +168,18 @@ void BLEManager::setupBLE() {
   desc->setCallbacks(new NotifyStatusDescriptorCallback());
   pWifiScanCharacteristic->addDescriptor(desc);
 
+  pProtocolCharacteristic = pService->createCharacteristic(
+      CHARACTERISTIC_PROTOCOL_UUID,
+      BLECharacteristic::PROPERTY_WRITE | BLECharacteristic::PROPERTY_WRITE_NR |
+          BLECharacteristic::PROPERTY_NOTIFY);
+  pProtocolCharacteristic->setCallbacks(new ProtocolCallbacks());
+  BLE2902 *protocolDesc = new BLE2902();
+  protocolDesc->setCallbacks(new NotifyStatusDescriptorCallback());
+  pProtocolCharacteristic->addDescriptor(protocolDesc);
+
+  pTelemetryCharacteristic = pService->createCharacteristic(
+      CHARACTERISTIC_TELEMETRY_UUID, BLECharacteristic::PROPERTY_READ);
+
   pService->start();
   Serial.println("📡 BLE is advertising...");
   BLEDevice::startAdvertising();
@@ -123,6 +187,8 @@ void BLEManager::setupBLE() {
 
 bool BLEManager::isNewBLEDataAvailable() { return newDataAvailable; }
 
+bool BLEManager::isPhoneConnected() { return isConnected; }
+
 void BLEManager::stopAdvertising() {
   BLEDevice::stopAdvertising();
   Serial.println("🔕 BLE advertising stopped");
@@ -154,3 +220,39 @@ void BLEManager::sendBLEData(const String &json) {
     Serial.println("⚠️ Not connected or characteristic missing");
   }
 }
+
+bool BLEManager::sendMessage(uint8_t type, const uint8_t *data,
+                             size_t length) {
+  if (!isConnected || !pProtocolCharacteristic) {
+    Serial.println("⚠️ Not connected or characteristic missing");
+    return false;
+  }
+  uint16_t mtu = pServer->getPeerMTU(pServer->getConnId());
+  if (mtu < BleProtocol::DEFAULT_MTU) {
+    mtu = BleProtocol::DEFAULT_MTU;
+  }
+
+  BleProtocol::Chunker chunker(type, data, length, mtu);
+  uint8_t frame[BleProtocol::PREFERRED_MTU];
+  uint16_t frames = 0;
+  size_t frameLength;
+  while ((frameLength = chunker.next(frame)) > 0) {
+    if (!isConnected) {
+      return false;
+    }
+    pProtocolCharacteristic->setValue(frame, frameLength);
+    pProtocolCharacteristic->notify();
+    frames++;
+    delay(BLE_FRAME_GAP_MS);
+  }
+  Serial.printf("📤 BLE message 0x%02x: %u bytes in %u frames (MTU %u)\n",
+                type, (unsigned)length, frames, mtu);
+  return true;
+}
+
+void BLEManager::setTelemetry(const uint8_t *data, size_t length) {
+  if (!pTelemetryCharacteristic) {
+    return;
+  }
+  pTelemetryCharacteristic->setValue((uint8_t *)data, length);
+}
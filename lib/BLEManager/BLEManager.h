@@ -10,19 +10,31 @@ public:
   static BLEManager &getInstance();
   using NotificationToggleCallback = std::function<void(void)>;
   using JsonReceivedCallback = std::function<void(const String &json)>;
+  // A complete framed message (see BleProtocol.h)
+  using MessageCallback =
+      std::function<void(uint8_t type, const uint8_t *data, size_t length)>;
   void setupBLE();
   void stopAdvertising();
   void startAdvertising();
   void restartBLE();
   void sendBLEData(const String &json);
+  // Sends one message as MTU-sized frames on the protocol characteristic
+  bool sendMessage(uint8_t type, const uint8_t *data, size_t length);
+  // New value of the read-only telemetry characteristic (TelemetryRecord.h),
+  // served to the phone by long reads
+  void setTelemetry(const uint8_t *data, size_t length);
   bool isNewBLEDataAvailable();
+  bool isPhoneConnected();
   String getReceivedBLEData();
 
   void onNotificationEnabled(NotificationToggleCallback cb);
   void onJsonReceived(JsonReceivedCallback cb);
+  void onMessage(MessageCallback cb);
 
   static void invokeNotificationCallback();
   static void invokeJsonReceivedCallback(const String &json);
+  static void invokeMessageCallback(uint8_t type, const uint8_t *data,
+                                    size_t length);
   bool getIsDeviceConnectedWithNotification();
 
 private:
@@ -32,6 +44,7 @@ private:
 
   static NotificationToggleCallback notificationCallback;
   static JsonReceivedCallback jsonCallback;
+  static MessageCallback messageCallback;
   friend class NotifyStatusDescriptorCallback; // 👈 allow access from internal
                                                // BLE callback
 };
@@ -0,0 +1,334 @@
+#include "BleProtocol.h"
+#include <string.h>
+
+namespace BleProtocol {
+
+static void putU16(uint8_t *p, uint16_t v) {
+  p[0] = v & 0xFF;
+  p[1] = v >> 8;
+}
+
+static uint16_t getU16(const uint8_t *p) { return p[0] | (p[1] << 8); }
+
+static void putI32(uint8_t *p, int32_t v) { writeU32(p, (uint32_t)v); }
+
+static int32_t getI32(const uint8_t *p) { return (int32_t)readU32(p); }
+
+uint32_t crc32(uint32_t crc, const uint8_t *data, size_t length) {
+  crc = ~crc;
+  while (length--) {
+    crc ^= *data++;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+    }
+  }
+  return ~crc;
+}
+
+// ===================== 📦 Framing =====================
+Chunker::Chunker(uint8_t type, const uint8_t *data, size_t length,
+                 uint16_t mtu)
+    : type(type), data(data), length(length) {
+  if (mtu < DEFAULT_MTU) {
+    mtu = DEFAULT_MTU;
+  }
+  payloadPerFrame = mtu - ATT_OVERHEAD - HEADER_SIZE;
+}
+
+size_t Chunker::next(uint8_t *frame) {
+  if (done()) {
+    return 0;
+  }
+  size_t chunk = length - offset;
+  if (chunk > payloadPerFrame) {
+    chunk = payloadPerFrame;
+  }
+  bool last = offset + chunk >= length;
+
+  frame[0] = type;
+  frame[1] = last ? FRAME_LAST : 0;
+  putU16(frame + 2, seq++);
+  if (chunk > 0) {
+    memcpy(frame + HEADER_SIZE, data + offset, chunk);
+  }
+  offset += chunk;
+  sent = true;
+  return HEADER_SIZE + chunk;
+}
+
+void Reassembler::reset() {
+  used = 0;
+  expectedSeq = 0;
+  messageType = 0;
+  active = false;
+}
+
+Reassembler::Result Reassembler::push(const uint8_t *frame, size_t length) {
+  if (length < HEADER_SIZE) {
+    reset();
+    return ERROR;
+  }
+  uint8_t type = frame[0];
+  uint8_t flags = frame[1];
+  uint16_t seq = getU16(frame + 2);
+
+  if (seq == 0) {
+    // A retry from the phone restarts the message
+    reset();
+    active = true;
+    messageType = type;
+  } else if (!active || seq != expectedSeq || type != messageType) {
+    reset();
+    return ERROR;
+  }
+
+  size_t payload = length - HEADER_SIZE;
+  if (used + payload > sizeof(buffer)) {
+    reset();
+    return ERROR;
+  }
+  memcpy(buffer + used, frame + HEADER_SIZE, payload);
+  used += payload;
+  expectedSeq = seq + 1;
+
+  if (flags & FRAME_LAST) {
+    active = false;
+    return COMPLETE;
+  }
+  return INCOMPLETE;
+}
+
+// ===================== 📶 Scan results =====================
+size_t encodeScanResults(const ScanEntry *entries, size_t count, uint8_t *out,
+                         size_t capacity) {
+  if (capacity < 1) {
+    return 0;
+  }
+  size_t pos = 1;
+  uint8_t written = 0;
+  for (size_t i = 0; i < count && written < 255; i++) {
+    size_t len = strnlen(entries[i].ssid, sizeof(entries[i].ssid) - 1);
+    if (pos + 3 + len > capacity) {
+      break;
+    }
+    out[pos++] = (uint8_t)entries[i].rssi;
+    out[pos++] = entries[i].secured ? 0x01 : 0x00;
+    out[pos++] = (uint8_t)len;
+    memcpy(out + pos, entries[i].ssid, len);
+    pos += len;
+    written++;
+  }
+  out[0] = written;
+  return pos;
+}
+
+size_t decodeScanResults(const uint8_t *data, size_t length,
+                         ScanEntry *entries, size_t maxEntries) {
+  if (length < 1) {
+    return 0;
+  }
+  size_t count = data[0];
+  size_t pos = 1;
+  size_t decoded = 0;
+  for (size_t i = 0; i < count && decoded < maxEntries; i++) {
+    if (pos + 3 > length) {
+      break;
+    }
+    size_t len = data[pos + 2];
+    if (len > sizeof(entries[0].ssid) - 1 || pos + 3 + len > length) {
+      break;
+    }
+    ScanEntry &e = entries[decoded++];
+    e.rssi = (int8_t)data[pos];
+    e.secured = data[pos + 1] & 0x01;
+    memcpy(e.ssid, data + pos + 3, len);
+    e.ssid[len] = '\0';
+    pos += 3 + len;
+  }
+  return decoded;
+}
+
+// ===================== ⚙️ Configuration =====================
+static bool putTlv(uint8_t *out, size_t capacity, size_t &pos, uint8_t tag,
+                   const uint8_t *value, size_t len) {
+  if (len > 255 || pos + 2 + len > capacity) {
+    return false;
+  }
+  out[pos++] = tag;
+  out[pos++] = (uint8_t)len;
+  memcpy(out + pos, value, len);
+  pos += len;
+  return true;
+}
+
+static bool putString(uint8_t *out, size_t capacity, size_t &pos, uint8_t tag,
+                      const char *s, size_t maxLen) {
+  size_t len = strnlen(s, maxLen);
+  if (len == 0) {
+    return true; // Empty strings are simply left out
+  }
+  return putTlv(out, capacity, pos, tag, (const uint8_t *)s, len);
+}
+
+static bool putInt(uint8_t *out, size_t capacity, size_t &pos, uint8_t tag,
+                   int32_t v) {
+  uint8_t buf[4];
+  putI32(buf, v);
+  return putTlv(out, capacity, pos, tag, buf, sizeof(buf));
+}
+
+size_t encodeConfig(const Config &c, uint8_t *out, size_t capacity) {
+  size_t pos = 0;
+  uint8_t method = c.method;
+  uint8_t hijri = (uint8_t)c.hijriAdjust;
+  bool ok = putString(out, capacity, pos, TAG_SSID, c.ssid,
+                      sizeof(c.ssid) - 1) &&
+            putString(out, capacity, pos, TAG_PASSWORD, c.password,
+                      sizeof(c.password) - 1) &&
+            putString(out, capacity, pos, TAG_POSIX_TZ, c.posixTz,
+                      sizeof(c.posixTz) - 1) &&
+            putString(out, capacity, pos, TAG_TZ_NAME, c.timezoneName,
+                      sizeof(c.timezoneName) - 1) &&
+            putString(out, capacity, pos, TAG_MOSQUE_UUID, c.mosqueUuid,
+                      sizeof(c.mosqueUuid) - 1) &&
+            putString(out, capacity, pos, TAG_DISPLAY_NAME, c.displayName,
+                      sizeof(c.displayName) - 1);
+  if (ok && c.hasMethod) {
+    ok = putTlv(out, capacity, pos, TAG_METHOD, &method, 1);
+  }
+  if (ok && c.hasHijriAdjust) {
+    ok = putTlv(out, capacity, pos, TAG_HIJRI_ADJUST, &hijri, 1);
+  }
+  if (ok && c.hasLocation) {
+    ok = putInt(out, capacity, pos, TAG_LATITUDE, c.latitudeE7) &&
+         putInt(out, capacity, pos, TAG_LONGITUDE, c.longitudeE7);
+  }
+  if (ok && c.hasTimezoneOffset) {
+    ok = putInt(out, capacity, pos, TAG_TZ_OFFSET, c.timezoneOffset);
+  }
+  if (ok && c.currentTime != 0) {
+    ok = putInt(out, capacity, pos, TAG_CURRENT_TIME, (int32_t)c.currentTime);
+  }
+  if (ok && c.iqamaMask == ALL_IQAMA_RULES) {
+    uint8_t buf[IQAMA_RULES * 3];
+    for (int i = 0; i < IQAMA_RULES; i++) {
+      buf[i * 3] = c.iqama[i].type;
+      putU16(buf + i * 3 + 1, c.iqama[i].value);
+    }
+    ok = putTlv(out, capacity, pos, TAG_IQAMA, buf, sizeof(buf));
+  } else {
+    for (int i = 0; ok && i < IQAMA_RULES; i++) {
+      if (c.iqamaMask & (1 << i)) {
+        uint8_t buf[4] = {(uint8_t)i, c.iqama[i].type};
+        putU16(buf + 2, c.iqama[i].value);
+        ok = putTlv(out, capacity, pos, TAG_IQAMA_RULE, buf, sizeof(buf));
+      }
+    }
+  }
+  return ok ? pos : 0;
+}
+
+static bool copyString(char *dst, size_t dstSize, const uint8_t *value,
+                       size_t len) {
+  if (len >= dstSize) {
+    return false;
+  }
+  memcpy(dst, value, len);
+  dst[len] = '\0';
+  return true;
+}
+
+bool decodeConfig(const uint8_t *data, size_t length, Config &c) {
+  c = Config();
+  bool hasLat = false;
+  bool hasLon = false;
+  size_t pos = 0;
+  while (pos < length) {
+    if (pos + 2 > length) {
+      return false;
+    }
+    uint8_t tag = data[pos];
+    size_t len = data[pos + 1];
+    const uint8_t *value = data + pos + 2;
+    if (pos + 2 + len > length) {
+      return false;
+    }
+    pos += 2 + len;
+
+    bool ok = true;
+    switch (tag) {
+    case TAG_SSID:
+      ok = copyString(c.ssid, sizeof(c.ssid), value, len);
+      break;
+    case TAG_PASSWORD:
+      ok = copyString(c.password, sizeof(c.password), value, len);
+      break;
+    case TAG_POSIX_TZ:
+      ok = copyString(c.posixTz, sizeof(c.posixTz), value, len);
+      break;
+    case TAG_TZ_NAME:
+      ok = copyString(c.timezoneName, sizeof(c.timezoneName), value, len);
+      break;
+    case TAG_MOSQUE_UUID:
+      ok = copyString(c.mosqueUuid, sizeof(c.mosqueUuid), value, len);
+      break;
+    case TAG_DISPLAY_NAME:
+      ok = copyString(c.displayName, sizeof(c.displayName), value, len);
+      break;
+    case TAG_LATITUDE:
+      ok = len == 4;
+      c.latitudeE7 = ok ? getI32(value) : 0;
+      hasLat = ok;
+      break;
+    case TAG_LONGITUDE:
+      ok = len == 4;
+      c.longitudeE7 = ok ? getI32(value) : 0;
+      hasLon = ok;
+      break;
+    case TAG_TZ_OFFSET:
+      ok = len == 4;
+      c.timezoneOffset = ok ? getI32(value) : 0;
+      c.hasTimezoneOffset = ok;
+      break;
+    case TAG_CURRENT_TIME:
+      ok = len == 4;
+      c.currentTime = ok ? readU32(value) : 0;
+      break;
+    case TAG_METHOD:
+      ok = len == 1;
+      c.method = ok ? value[0] : c.method;
+      c.hasMethod = ok;
+      break;
+    case TAG_HIJRI_ADJUST:
+      ok = len == 1;
+      c.hijriAdjust = ok ? (int8_t)value[0] : 0;
+      c.hasHijriAdjust = ok;
+      break;
+    case TAG_IQAMA:
+      ok = len == IQAMA_RULES * 3;
+      for (int i = 0; ok && i < IQAMA_RULES; i++) {
+        c.iqama[i].type = value[i * 3];
+        c.iqama[i].value = getU16(value + i * 3 + 1);
+      }
+      c.iqamaMask = ok ? ALL_IQAMA_RULES : c.iqamaMask;
+      break;
+    case TAG_IQAMA_RULE:
+      ok = len == 4 && value[0] < IQAMA_RULES;
+      if (ok) {
+        c.iqama[value[0]].type = value[1];
+        c.iqama[value[0]].value = getU16(value + 2);
+        c.iqamaMask |= 1 << value[0];
+      }
+      break;
+    default:
+      break; // Newer phone app; ignore what we don't know
+    }
+    if (!ok) {
+      return false;
+    }
+  }
+  c.hasLocation = hasLat && hasLon;
+  return true;
+}
+
+} // namespace BleProtocol
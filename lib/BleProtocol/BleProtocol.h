@@ -0,0 +1,202 @@
+#ifndef BLE_PROTOCOL_H
+#define BLE_PROTOCOL_H
+
+// Framed binary provisioning protocol. Plain C++ without Arduino types, so
+// the phone app / host tools can build the same codec.
+//
+// Every message is split into frames of at most (ATT MTU - 3) bytes:
+//
+//   [type u8][flags u8][seq u16 LE][payload ...]
+//
+// seq counts from 0 within a message and FRAME_LAST marks its final frame.
+// A frame with seq 0 always starts a new message.
+//
+// Payloads (little endian throughout):
+//   MSG_SCAN_RESULTS  [count u8] { [rssi i8][flags u8][len u8][ssid] }*
+//   MSG_CONFIG        { [tag u8][len u8][value] }*    (see ConfigTag)
+//   MSG_STATUS        [status u8]                     (see BleStatus)
+//   MSG_SETTINGS      like MSG_CONFIG, only the tags that change: method,
+//                     iqama, timezone, Hijri, display name and current
+//                     time (others are ignored). The time sets the clock
+//                     and feeds the drift model like an NTP sync, the only
+//                     correction an offline device gets. Answered with a
+//                     STATUS once applied.
+//   MSG_LOG_REQUEST   (empty)                         settings window only
+//   MSG_LOG           [more u8] text lines, '\n' separated, oldest first
+//
+// The log answer is the device's RTC log ring (Logger.h), split over as
+// many MSG_LOG messages as it takes to stay within MAX_MESSAGE_SIZE; 'more'
+// is 0 on the last one. A device logging to Serial answers with one MSG_LOG
+// without lines.
+//
+// File upload (the calendar, see CalendarFile.h), resumable after a
+// disconnect:
+//   MSG_UPLOAD_BEGIN  [id u32][size u32][crc32 u32]
+//   MSG_UPLOAD_DATA   [id u32][offset u32][bytes ...]
+//   MSG_UPLOAD_END    [id u32]
+//   MSG_UPLOAD_ACK    [id u32][stored u32]
+// The device answers BEGIN and every DATA with an ACK holding the bytes
+// stored so far; BEGIN with the id, size and CRC of an unfinished upload
+// continues it. DATA must start exactly at 'stored'. END is answered with a
+// STATUS once the CRC and the file layout were checked.
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace BleProtocol {
+
+constexpr size_t HEADER_SIZE = 4;
+constexpr size_t ATT_OVERHEAD = 3;    // Opcode + handle of a notification
+constexpr uint16_t DEFAULT_MTU = 23;  // Before the exchange
+constexpr uint16_t PREFERRED_MTU = 517;
+constexpr size_t MAX_MESSAGE_SIZE = 2048;
+
+constexpr uint8_t FRAME_LAST = 0x01;
+
+enum MessageType : uint8_t {
+  MSG_SCAN_RESULTS = 0x01, // Device -> phone
+  MSG_CONFIG = 0x02,       // Phone -> device
+  MSG_STATUS = 0x03,       // Device -> phone
+  MSG_UPLOAD_BEGIN = 0x04, // Phone -> device
+  MSG_UPLOAD_DATA = 0x05,  // Phone -> device
+  MSG_UPLOAD_END = 0x06,   // Phone -> device
+  MSG_UPLOAD_ACK = 0x07,   // Device -> phone
+  MSG_SETTINGS = 0x08,     // Phone -> device, settings window after a
+                           // button wake
+  MSG_LOG_REQUEST = 0x09,  // Phone -> device, settings window
+  MSG_LOG = 0x0A,          // Device -> phone
+};
+
+constexpr size_t UPLOAD_BEGIN_SIZE = 12;
+constexpr size_t UPLOAD_DATA_HEADER = 8;
+constexpr size_t UPLOAD_ACK_SIZE = 8;
+
+enum BleStatus : uint8_t {
+  STATUS_OK = 0,
+  STATUS_BAD_FRAME = 1,  // Out of order, oversized or truncated
+  STATUS_BAD_CONFIG = 2, // Decoded but rejected by validation
+  STATUS_BAD_CHECKSUM = 3, // Upload CRC mismatch; start over
+  STATUS_UPLOAD_FAILED = 4, // Flash full, unknown id or bad file layout
+  STATUS_BUSY = 5,       // Previous settings still being applied; resend
+};
+
+enum ConfigTag : uint8_t {
+  TAG_SSID = 1,          // UTF-8, <= 32 bytes
+  TAG_PASSWORD = 2,      // <= 64 bytes
+  TAG_LATITUDE = 3,      // i32, degrees x 1e7
+  TAG_LONGITUDE = 4,     // i32, degrees x 1e7
+  TAG_METHOD = 5,        // u8, Aladhan calculation method
+  TAG_TZ_OFFSET = 6,     // i32, seconds east of UTC
+  TAG_POSIX_TZ = 7,      // POSIX TZ rules
+  TAG_TZ_NAME = 8,       // IANA zone name
+  TAG_HIJRI_ADJUST = 9,  // i8, days
+  TAG_IQAMA = 10,        // 6 x [type u8][value u16]: 5 daily + Jumu'ah
+  TAG_MOSQUE_UUID = 11,  // Legacy
+  TAG_CURRENT_TIME = 12, // u32, UTC epoch; sets the clock without Wi-Fi
+  TAG_DISPLAY_NAME = 13, // Location label shown on screen
+  TAG_IQAMA_RULE = 14,   // [row u8][type u8][value u16], row 5 = Jumu'ah;
+                         // may repeat
+};
+
+constexpr uint8_t IQAMA_RULES = 6;
+constexpr uint8_t ALL_IQAMA_RULES = (1 << IQAMA_RULES) - 1;
+
+struct ScanEntry {
+  char ssid[33];
+  int8_t rssi;
+  bool secured;
+};
+
+struct IqamaWire {
+  uint8_t type;
+  uint16_t value;
+};
+
+// Decoded MSG_CONFIG; has* flags tell which tags were present
+struct Config {
+  char ssid[33] = "";
+  char password[65] = "";
+  char posixTz[48] = "";
+  char timezoneName[40] = "";
+  char mosqueUuid[40] = "";
+  char displayName[50] = "";
+  int32_t latitudeE7 = 0;
+  int32_t longitudeE7 = 0;
+  int32_t timezoneOffset = 0;
+  uint32_t currentTime = 0; // 0 = not sent
+  uint8_t method = 4;
+  int8_t hijriAdjust = 0;
+  IqamaWire iqama[IQAMA_RULES] = {};
+  uint8_t iqamaMask = 0; // Bit per iqama[] entry that was sent
+  bool hasLocation = false;
+  bool hasTimezoneOffset = false;
+  bool hasMethod = false;
+  bool hasHijriAdjust = false;
+};
+
+// Writes one frame per call into 'frame' (capacity >= mtu - ATT_OVERHEAD)
+class Chunker {
+public:
+  Chunker(uint8_t type, const uint8_t *data, size_t length, uint16_t mtu);
+  bool done() const { return sent && offset >= length; }
+  size_t next(uint8_t *frame); // Frame length, 0 when done
+
+private:
+  uint8_t type;
+  const uint8_t *data;
+  size_t length;
+  size_t payloadPerFrame;
+  size_t offset = 0;
+  uint16_t seq = 0;
+  bool sent = false; // An empty message still goes out as one frame
+};
+
+// Collects frames of one message at a time
+class Reassembler {
+public:
+  enum Result { INCOMPLETE, COMPLETE, ERROR };
+
+  Result push(const uint8_t *frame, size_t length);
+  uint8_t type() const { return messageType; }
+  const uint8_t *data() const { return buffer; }
+  size_t size() const { return used; }
+  void reset();
+
+private:
+  uint8_t buffer[MAX_MESSAGE_SIZE];
+  size_t used = 0;
+  uint16_t expectedSeq = 0;
+  uint8_t messageType = 0;
+  bool active = false;
+};
+
+inline void writeU32(uint8_t *p, uint32_t v) {
+  for (int i = 0; i < 4; i++) {
+    p[i] = (v >> (8 * i)) & 0xFF;
+  }
+}
+
+inline uint32_t readU32(const uint8_t *p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+         ((uint32_t)p[3] << 24);
+}
+
+// CRC-32 (IEEE, as zlib); pass the previous result to continue
+uint32_t crc32(uint32_t crc, const uint8_t *data, size_t length);
+
+// Returns the encoded length, or 0 if 'out' is too small. Entries that do
+// not fit are dropped from the end (strongest networks first is the
+// caller's job), never cut in half.
+size_t encodeScanResults(const ScanEntry *entries, size_t count, uint8_t *out,
+                         size_t capacity);
+size_t decodeScanResults(const uint8_t *data, size_t length,
+                         ScanEntry *entries, size_t maxEntries);
+
+size_t encodeConfig(const Config &config, uint8_t *out, size_t capacity);
+// False on a truncated TLV, an oversized string or a bad fixed-size field;
+// unknown tags are skipped
+bool decodeConfig(const uint8_t *data, size_t length, Config &config);
+
+} // namespace BleProtocol
+
+#endif // BLE_PROTOCOL_H
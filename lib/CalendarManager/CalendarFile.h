@@ -0,0 +1,63 @@
+#ifndef CALENDAR_FILE_H
+#define CALENDAR_FILE_H
+
+// Layout of an uploaded calendar ("/calendar.bin"), built by the phone app
+// and sent over BLE (see BleProtocol.h). Plain C++ so the app shares it.
+//
+// A Header followed by dayCount DayRecords for consecutive days starting at
+// firstYear-firstMonth-firstDay, little endian, no padding. Fixed-size
+// records let the device seek straight to a day.
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace CalendarFile {
+
+constexpr uint8_t VERSION = 1;
+constexpr uint16_t NO_TIME = 0xFFFF;   // Iqama derived from the local rules
+constexpr uint8_t NO_WEATHER = 0xFF;   // No snapshot for the day
+constexpr uint16_t MAX_DAYS = 400;
+
+struct Header {
+  char magic[4]; // "KCAL"
+  uint8_t version;
+  uint8_t recordSize; // sizeof(DayRecord)
+  uint16_t dayCount;
+  uint16_t firstYear;
+  uint8_t firstMonth; // 1..12
+  uint8_t firstDay;   // 1..31
+};
+
+struct DayRecord {
+  uint16_t prayers[6]; // Minutes since midnight: Fajr, Sunrise, Dhuhr, Asr,
+                       // Maghrib, Isha
+  uint16_t iqamas[5];  // Fajr, Dhuhr, Asr, Maghrib, Isha, or NO_TIME
+  int8_t temperature;  // Typical daytime temperature, degrees Celsius
+  uint8_t weatherCode; // WMO code, or NO_WEATHER
+};
+
+static_assert(sizeof(Header) == 12, "Header must stay 12 bytes");
+static_assert(sizeof(DayRecord) == 24, "DayRecord must stay 24 bytes");
+
+inline bool isMagic(const Header &h) {
+  return h.magic[0] == 'K' && h.magic[1] == 'C' && h.magic[2] == 'A' &&
+         h.magic[3] == 'L';
+}
+
+inline size_t fileSize(uint16_t dayCount) {
+  return sizeof(Header) + (size_t)dayCount * sizeof(DayRecord);
+}
+
+// Days since 1970-01-01 of a proleptic Gregorian date
+inline int32_t dayNumber(int year, int month, int day) {
+  year -= month <= 2;
+  const int32_t era = (year >= 0 ? year : year - 399) / 400;
+  const int32_t yoe = year - era * 400;
+  const int32_t doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+  const int32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + doe - 719468;
+}
+
+} // namespace CalendarFile
+
+#endif // CALENDAR_FILE_H
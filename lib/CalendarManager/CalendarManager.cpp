@@ -1,270 +1,346 @@
 #include "CalendarManager.h"
 #include "AppState.h"
 #include "AppStateManager.h"
-#include <SPIFFS.h>
+#include "CalendarFile.h"
+#include "IqamaRules.h"
+#include <Logger.h>
+#include <SPIFFSHelper.h>
 #include <vector>
 
-CalendarManager::CalendarManager() : currentMonth(0), currentDay(0) {}
+static_assert(sizeof(CalendarFile::DayRecord::prayers) ==
+                      sizeof(ScheduleWindow::Day::prayers) &&
+                  sizeof(CalendarFile::DayRecord::iqamas) ==
+                      sizeof(ScheduleWindow::Day::iqamas),
+              "Uploaded day records must match the schedule window");
 
-void safeCopyPrayer(char *destination, const std::vector<String> &times,
-                    size_t index) {
-  if (index < times.size()) {
-    strncpy(destination, times[index].c_str(), 6);
-    destination[5] = '\0';
-  } else {
-    strncpy(destination, "00:00", 6); // fallback
-    destination[5] = '\0';
+CalendarManager::CalendarManager() {}
+
+String CalendarManager::getMonthFilePath(int year, int month) {
+  char path[32];
+  snprintf(path, sizeof(path), "%s%04d_%02d.json", PRAYER_TIME_FILE_PREFIX,
+           year, month);
+  return String(path);
+}
+
+void CalendarManager::invalidateCache() {
+  rtcData.day = 0;
+  rtcData.scheduleWindow.count = 0;
+}
+
+void CalendarManager::removeStoredMonths(const String &keep) {
+  // Collect first: removing while iterating a directory is not safe
+  std::vector<String> paths;
+  File root = APP_FS.open("/");
+  for (File entry = root.openNextFile(); entry; entry = root.openNextFile()) {
+    String name = entry.name();
+    String path = name.startsWith("/") ? name : "/" + name;
+    if (name.indexOf("prayer_times_") >= 0 && path != keep) {
+      paths.push_back(path);
+    }
+  }
+  root.close();
+
+  for (const String &path : paths) {
+    APP_FS.remove(path);
+  }
+  LOG_I("🗑️ Removed %u stored prayer months", (unsigned)paths.size());
+  invalidateCache();
+}
+
+int CalendarManager::daysInMonth(int year, int month) {
+  static const uint8_t DAYS[12] = {31, 28, 31, 30, 31, 30,
+                                   31, 31, 30, 31, 30, 31};
+  if (month == 2 && (year % 4 == 0 && (year % 100 != 0 || year % 400 == 0))) {
+    return 29;
   }
+  return month >= 1 && month <= 12 ? DAYS[month - 1] : 0;
 }
-String CalendarManager::getMonthFilePath(int month, bool isIqama) {
-  if (isIqama) {
-    return IQAMA_TIME_FILE_NAME + String(month) + ".json";
+
+// Opens the uploaded calendar positioned after its (checked) header
+static File openUploaded(CalendarFile::Header &header) {
+  if (!fileExists(UPLOADED_CALENDAR_FILE)) {
+    return File();
   }
-  return PRAYER_TIME_FILE_NAME + String(month) + ".json";
+  File file = openFileForRead(UPLOADED_CALENDAR_FILE);
+  if (file && (file.read((uint8_t *)&header, sizeof(header)) !=
+                   sizeof(header) ||
+               !CalendarFile::isMagic(header) ||
+               header.recordSize != sizeof(CalendarFile::DayRecord))) {
+    LOG_E("❌ Uploaded calendar is unreadable");
+    file.close();
+  }
+  return file;
 }
-IqamaTimes CalendarManager::fetchTodayIqamaTimes(int month, int day) {
-  Serial.println("📅 Fetching Iqama times for month: " + String(month) +
-                 ", day: " + String(day));
-  // Serial.println("📂 File path: " + getMonthFilePath(month, true));
-  IqamaTimes result;
-
-  String filePath = getMonthFilePath(month, true);
-  File file = SPIFFS.open(filePath, "r");
-  if (!file) {
-    Serial.println("❌ Failed to open file: " + filePath);
-    return result;
+
+// Index of a date in the uploaded calendar, -1 if outside it
+static int uploadedIndex(const CalendarFile::Header &header, int year,
+                         int month, int day) {
+  const int32_t index =
+      CalendarFile::dayNumber(year, month, day) -
+      CalendarFile::dayNumber(header.firstYear, header.firstMonth,
+                              header.firstDay);
+  return index >= 0 && index < header.dayCount ? (int)index : -1;
+}
+
+bool CalendarManager::hasUploadedCalendar() {
+  return fileExists(UPLOADED_CALENDAR_FILE);
+}
+
+void CalendarManager::removeUploadedCalendar() {
+  if (APP_FS.exists(UPLOADED_CALENDAR_FILE)) {
+    APP_FS.remove(UPLOADED_CALENDAR_FILE);
   }
+  if (APP_FS.exists(CALENDAR_UPLOAD_FILE)) {
+    APP_FS.remove(CALENDAR_UPLOAD_FILE);
+  }
+  invalidateCache();
+}
 
-  String fileContent = file.readString();
+bool CalendarManager::uploadedWeather(int year, int month, int day,
+                                      int8_t &temperature,
+                                      uint8_t &weatherCode) {
+  CalendarFile::Header header;
+  File file = openUploaded(header);
+  if (!file) {
+    return false;
+  }
+  const int index = uploadedIndex(header, year, month, day);
+  CalendarFile::DayRecord record;
+  bool found = index >= 0 &&
+               file.seek(sizeof(header) + index * sizeof(record)) &&
+               file.read((uint8_t *)&record, sizeof(record)) == sizeof(record) &&
+               record.weatherCode != CalendarFile::NO_WEATHER;
   file.close();
+  if (found) {
+    temperature = record.temperature;
+    weatherCode = record.weatherCode;
+  }
+  return found;
+}
 
-  DynamicJsonDocument doc(1024); // Use dynamic allocation here
-  DeserializationError error = deserializeJson(doc, fileContent);
-  if (error) {
-    Serial.println("❌ JSON parsing failed");
-    return result;
+int CalendarManager::uploadedCoverageDays(const struct tm &today) {
+  CalendarFile::Header header;
+  File file = openUploaded(header);
+  if (!file) {
+    return 0;
   }
+  file.close();
+  const int index = uploadedIndex(header, today.tm_year + 1900,
+                                  today.tm_mon + 1, today.tm_mday);
+  return index >= 0 ? header.dayCount - index : 0;
+}
 
-  JsonObject monthData = doc.as<JsonObject>();
-  JsonObject dayDataCalendar = monthData["iqamaCalendar"].as<JsonObject>();
-  String dayKey = String(day);
+int CalendarManager::coverageDays(const struct tm &today, int horizonDays,
+                                  int *missingYear, int *missingMonth) {
+  // Past the end of an uploaded calendar the fetched months take over
+  if (uploadedCoverageDays(today) >= horizonDays) {
+    return horizonDays;
+  }
 
-  if (dayDataCalendar[dayKey].is<JsonArray>()) {
-    JsonArray iqamaTimes = dayDataCalendar[dayKey].as<JsonArray>();
-    for (const auto &time : iqamaTimes) {
-      result.iqamaTimes.push_back(time.as<String>());
+  int year = today.tm_year + 1900;
+  int month = today.tm_mon + 1;
+  int covered = 0;
+  int remaining = daysInMonth(year, month) - today.tm_mday + 1;
+  while (covered < horizonDays) {
+    if (!fileExists(getMonthFilePath(year, month))) {
+      if (missingYear && missingMonth) {
+        *missingYear = year;
+        *missingMonth = month;
+      }
+      return covered;
     }
-  } else {
-    Serial.println("❌ No Iqama times found for this day");
+    covered += remaining;
+    if (++month > 12) {
+      month = 1;
+      year++;
+    }
+    remaining = daysInMonth(year, month);
   }
-
-  return result;
+  return horizonDays;
 }
-TodayPrayerTimes CalendarManager::fetchTodayPrayerTimes(int month, int day) {
-  TodayPrayerTimes result;
 
-  String filePath = getMonthFilePath(month);
-  File file = SPIFFS.open(filePath, "r");
+bool CalendarManager::appendMonthDays(int year, int month, int firstDay,
+                                      bool &reachedMonthEnd) {
+  String filePath = getMonthFilePath(year, month);
+  File file = openFileForRead(filePath);
   if (!file) {
-    Serial.println("❌ Failed to open file: " + filePath);
-    return result;
+    // Year-agnostic month files (MAWAQIT calendar, older firmware)
+    filePath = PRAYER_TIME_FILE_NAME + String(month) + ".json";
+    file = openFileForRead(filePath);
+  }
+  if (!file) {
+    LOG_E("❌ No prayer times for %d/%d", month, year);
+    return false;
   }
 
-  String fileContent = file.readString();
+  JsonDocument doc;
+  DeserializationError error = deserializeJson(doc, file);
   file.close();
-
-  DynamicJsonDocument doc(1024); // Use dynamic allocation here
-  DeserializationError error = deserializeJson(doc, fileContent);
   if (error) {
-    Serial.println("❌ JSON parsing failed");
-    return result;
+    LOG_E("❌ JSON parsing failed");
+    return false;
   }
 
-  JsonObject monthData = doc.as<JsonObject>();
-  JsonObject dayDataCalendar = monthData["prayerCalender"].as<JsonObject>();
-  String dayKey = String(day);
-
-  if (dayDataCalendar[dayKey].is<JsonArray>()) {
+  ScheduleWindow &window = rtcData.scheduleWindow;
+  JsonObject dayDataCalendar = doc["prayerCalender"].as<JsonObject>();
+  char dayKey[4];
+  reachedMonthEnd = false;
+  for (int day = firstDay; window.count < ScheduleWindow::DAYS; ++day) {
+    snprintf(dayKey, sizeof(dayKey), "%d", day);
     JsonArray prayerTimes = dayDataCalendar[dayKey].as<JsonArray>();
-    struct tm timeinfo;
-    if (getLocalTime(&timeinfo)) // Assuming local time is available
-    {
-      int year = timeinfo.tm_year + 1900; // Get the current year
-      String isoDate = String(year) + "-" + String(month) + "-" +
-                       String(day); // Format the date as YYYY-MM-DD
-      for (const auto &time : prayerTimes) {
-        result.prayerTimes.push_back(time.as<String>());
-        String prayerTime = time.as<String>();
-        int hour = prayerTime.substring(0, 2).toInt();
-        int minute = prayerTime.substring(3, 5).toInt();
-        String timeZoneOffset = "+00:00";
-        String isoDateTime =
-            isoDate + "T" + prayerTime + ":00" +
-            timeZoneOffset; // Format as YYYY-MM-DDTHH:MM:SS+00:00 // Assign the
-                            // full ISO 8601 date and time
-        result.prayerTimesISODate.push_back(
-            isoDateTime); // Add to the new vector
-      }
+    if (prayerTimes.isNull()) {
+      reachedMonthEnd = true; // The next day doesn't exist
+      break;
     }
-    String nextDayKey = String(day + 1);
-    if (!dayDataCalendar[nextDayKey].is<JsonArray>()) {
-      result.isLastDayOfMonth = true; // This is the last day of the month if
-                                      // the next day doesn't exist
+    if (prayerTimes.size() < DaySchedule::PRAYER_COUNT) {
+      return false;
     }
-  }
 
-  return result;
-}
-bool CalendarManager::isLaterThan(int hour, int minute, const String &timeStr) {
-  int h = timeStr.substring(0, 2).toInt();
-  int m = timeStr.substring(3, 5).toInt();
-
-  if (h > hour)
-    return true;
-  if (h == hour && m > minute)
-    return true;
-  return false;
+    ScheduleWindow::Day &entry = window.days[window.count];
+    entry = ScheduleWindow::Day(); // Iqamas from the rules
+    entry.year = (uint16_t)year;
+    entry.month = (uint8_t)month;
+    entry.day = (uint8_t)day;
+    for (uint8_t i = 0; i < DaySchedule::PRAYER_COUNT; ++i) {
+      entry.prayers[i] =
+          DaySchedule::parseHHMM(prayerTimes[i].as<const char *>());
+      if (entry.prayers[i] >= DaySchedule::MINUTES_PER_DAY) {
+        return false;
+      }
+    }
+    window.count++;
+  }
+  return true;
 }
 
-TodayAndNextDayPrayerTimes
-CalendarManager::fetchTodayAndNextDayPrayerTimes(int month, int day) {
-
-  TodayAndNextDayPrayerTimes times;
-  bool hasAllTodayPrayers =
-      rtcData.TODAY_FAJR[0] != '\0' && rtcData.TODAY_SUNRISE[0] != '\0' &&
-      rtcData.TODAY_DHUHR[0] != '\0' && rtcData.TODAY_ASR[0] != '\0' &&
-      rtcData.TODAY_MAGHRIB[0] != '\0' && rtcData.TODAY_ISHA[0] != '\0';
-
-  bool hasAllTodayIqamas = rtcData.TODAY_IQAMA_FAJR[0] != '\0' &&
-                           rtcData.TODAY_IQAMA_DHUHR[0] != '\0' &&
-                           rtcData.TODAY_IQAMA_ASR[0] != '\0' &&
-                           rtcData.TODAY_IQAMA_MAGHRIB[0] != '\0' &&
-                           rtcData.TODAY_IQAMA_ISHA[0] != '\0';
-
-  bool hasAllNextDayPrayers =
-      rtcData.NEXT_DAY_FAJR[0] != '\0' && rtcData.NEXT_DAY_SUNRISE[0] != '\0' &&
-      rtcData.NEXT_DAY_DHUHR[0] != '\0' && rtcData.NEXT_DAY_ASR[0] != '\0' &&
-      rtcData.NEXT_DAY_MAGHRIB[0] != '\0' && rtcData.NEXT_DAY_ISHA[0] != '\0';
-
-  bool hasAllNextDayIqamas = rtcData.NEXT_DAY_IQAMA_FAJR[0] != '\0' &&
-                             rtcData.NEXT_DAY_IQAMA_DHUHR[0] != '\0' &&
-                             rtcData.NEXT_DAY_IQAMA_ASR[0] != '\0' &&
-                             rtcData.NEXT_DAY_IQAMA_MAGHRIB[0] != '\0' &&
-                             rtcData.NEXT_DAY_IQAMA_ISHA[0] != '\0';
-
-  if (rtcData.day != 0 && rtcData.day == day && rtcData.month != 0 &&
-      rtcData.month == month && hasAllTodayPrayers && hasAllTodayIqamas &&
-      hasAllNextDayPrayers && hasAllNextDayIqamas) {
+uint8_t CalendarManager::appendUploadedDays(int year, int month, int day) {
+  CalendarFile::Header header;
+  File file = openUploaded(header);
+  if (!file) {
+    return 0;
+  }
+  const int index = uploadedIndex(header, year, month, day);
+  if (index < 0 || !file.seek(sizeof(header) +
+                              index * sizeof(CalendarFile::DayRecord))) {
+    file.close();
+    return 0;
+  }
 
-    Serial.println("📅 Using cached prayer times from RTC");
+  ScheduleWindow &window = rtcData.scheduleWindow;
+  CalendarFile::DayRecord record;
+  uint8_t added = 0;
+  for (int i = index; i < header.dayCount && window.count < ScheduleWindow::DAYS;
+       ++i) {
+    if (file.read((uint8_t *)&record, sizeof(record)) != sizeof(record)) {
+      break;
+    }
+    ScheduleWindow::Day &entry = window.days[window.count++];
+    entry.year = (uint16_t)year;
+    entry.month = (uint8_t)month;
+    entry.day = (uint8_t)day;
+    memcpy(entry.prayers, record.prayers, sizeof(entry.prayers));
+    memcpy(entry.iqamas, record.iqamas, sizeof(entry.iqamas));
+    added++;
+
+    if (++day > daysInMonth(year, month)) {
+      day = 1;
+      if (++month > 12) {
+        month = 1;
+        year++;
+      }
+    }
+  }
+  file.close();
+  return added;
+}
 
-    times.todayPrayerTimes = {rtcData.TODAY_FAJR,    rtcData.TODAY_SUNRISE,
-                              rtcData.TODAY_DHUHR,   rtcData.TODAY_ASR,
-                              rtcData.TODAY_MAGHRIB, rtcData.TODAY_ISHA};
+uint8_t CalendarManager::fillWindow(int year, int month, int day) {
+  LOG_I("🔄 Loading %d days of prayer times from %d/%d",
+        ScheduleWindow::DAYS, day, month);
+  rtcData.scheduleWindow.count = 0;
 
-    times.todayIqamaTimes = {rtcData.TODAY_IQAMA_FAJR,
-                             rtcData.TODAY_IQAMA_DHUHR, rtcData.TODAY_IQAMA_ASR,
-                             rtcData.TODAY_IQAMA_MAGHRIB,
-                             rtcData.TODAY_IQAMA_ISHA};
+  const uint8_t uploaded = appendUploadedDays(year, month, day);
+  if (uploaded == ScheduleWindow::DAYS) {
+    return uploaded;
+  }
+  if (uploaded > 0) {
+    // The uploaded calendar ends inside the window; month files continue it
+    const ScheduleWindow::Day &last = rtcData.scheduleWindow.days[uploaded - 1];
+    year = last.year;
+    month = last.month;
+    day = last.day + 1;
+    if (day > daysInMonth(year, month)) {
+      day = 1;
+      year = month == 12 ? year + 1 : year;
+      month = (month % 12) + 1;
+    }
+  }
 
-    times.nextDayPrayerTimes = {
-        rtcData.NEXT_DAY_FAJR, rtcData.NEXT_DAY_SUNRISE, rtcData.NEXT_DAY_DHUHR,
-        rtcData.NEXT_DAY_ASR,  rtcData.NEXT_DAY_MAGHRIB, rtcData.NEXT_DAY_ISHA};
+  // At most two month files: the rest of this month, then the next one
+  // (January of the following year after December)
+  bool reachedMonthEnd = false;
+  if (appendMonthDays(year, month, day, reachedMonthEnd) && reachedMonthEnd &&
+      rtcData.scheduleWindow.count < ScheduleWindow::DAYS) {
+    appendMonthDays(month == 12 ? year + 1 : year, (month % 12) + 1, 1,
+                    reachedMonthEnd);
+  }
+  return rtcData.scheduleWindow.count;
+}
 
-    times.nextDayIqamaTimes = {
-        rtcData.NEXT_DAY_IQAMA_FAJR, rtcData.NEXT_DAY_IQAMA_DHUHR,
-        rtcData.NEXT_DAY_IQAMA_ASR, rtcData.NEXT_DAY_IQAMA_MAGHRIB,
-        rtcData.NEXT_DAY_IQAMA_ISHA};
+TodayAndNextDayPrayerTimes
+CalendarManager::fetchTodayAndNextDayPrayerTimes(int year, int month, int day,
+                                                 int weekday) {
 
-    return times;
-  }
+  TodayAndNextDayPrayerTimes times;
 
-  Serial.println("🔄 Fetching prayer times for month: " + String(month) +
-                 ", day: " + String(day));
-  TodayPrayerTimes todayPrayerTime = fetchTodayPrayerTimes(month, day);
-  IqamaTimes todayIqamaTime = fetchTodayIqamaTimes(month, day);
-  if (todayPrayerTime.prayerTimes.empty() ||
-      todayIqamaTime.iqamaTimes.empty() ||
-      todayPrayerTime.prayerTimes.size() < 6 ||
-      todayIqamaTime.iqamaTimes.size() < 5) {
-    Serial.println("❌ Failed to fetch today prayer times");
+  if (rtcData.day != 0 && rtcData.day == day && rtcData.month != 0 &&
+      rtcData.month == month && rtcData.today.isValid() &&
+      rtcData.nextDay.isValid()) {
+    LOG_D("📅 Using cached prayer times from RTC");
+    times.today = rtcData.today;
+    times.nextDay = rtcData.nextDay;
     return times;
   }
-  // *** Today prayer times ***//
-  safeCopyPrayer(rtcData.TODAY_FAJR, todayPrayerTime.prayerTimes, 0);
-  safeCopyPrayer(rtcData.TODAY_SUNRISE, todayPrayerTime.prayerTimes, 1);
-  safeCopyPrayer(rtcData.TODAY_DHUHR, todayPrayerTime.prayerTimes, 2);
-  safeCopyPrayer(rtcData.TODAY_ASR, todayPrayerTime.prayerTimes, 3);
-  safeCopyPrayer(rtcData.TODAY_MAGHRIB, todayPrayerTime.prayerTimes, 4);
-  safeCopyPrayer(rtcData.TODAY_ISHA, todayPrayerTime.prayerTimes, 5);
-
-  // *** Today iqama times ***//
-  safeCopyPrayer(rtcData.TODAY_IQAMA_FAJR, todayIqamaTime.iqamaTimes, 0);
-  safeCopyPrayer(rtcData.TODAY_IQAMA_DHUHR, todayIqamaTime.iqamaTimes, 1);
-  safeCopyPrayer(rtcData.TODAY_IQAMA_ASR, todayIqamaTime.iqamaTimes, 2);
-  safeCopyPrayer(rtcData.TODAY_IQAMA_MAGHRIB, todayIqamaTime.iqamaTimes, 3);
-  safeCopyPrayer(rtcData.TODAY_IQAMA_ISHA, todayIqamaTime.iqamaTimes, 4);
-  AppStateManager::save();
 
-  int nextMonth;
-  int nextDay;
-  if (todayPrayerTime.isLastDayOfMonth) {
-    Serial.println("🔄 Next month");
-    nextMonth = (month % 12) + 1;
-    nextDay = 1;
+  // Day rollover: served from the RTC window while it still holds tomorrow
+  const ScheduleWindow &window = rtcData.scheduleWindow;
+  int index = window.indexOf(year, month, day);
+  if (index < 0 || index + 1 >= window.count) {
+    fillWindow(year, month, day);
+    index = window.indexOf(year, month, day);
   } else {
-    Serial.println("🔄 Next day");
-    nextMonth = month;
-    nextDay = day + 1;
+    LOG_D("📅 Prayer times for %d/%d from the RTC window", day, month);
   }
-  TodayPrayerTimes nextDayPrayerTime =
-      fetchTodayPrayerTimes(nextMonth, nextDay);
-  IqamaTimes nextDayIqamaTime = fetchTodayIqamaTimes(nextMonth, nextDay);
-  if (nextDayPrayerTime.prayerTimes.empty() ||
-      nextDayIqamaTime.iqamaTimes.empty() ||
-      nextDayPrayerTime.prayerTimes.size() < 6 ||
-      nextDayIqamaTime.iqamaTimes.size() < 5) {
-    Serial.println("❌ Failed to fetch next day prayer times");
-    return times;
+  if (index < 0) {
+    LOG_E("❌ Failed to fetch today prayer times");
+    return TodayAndNextDayPrayerTimes();
+  }
+  if (index + 1 >= window.count) {
+    LOG_E("❌ Failed to fetch next day prayer times");
+    return TodayAndNextDayPrayerTimes();
   }
-  Serial.println("🔄 Fetching prayer times for month: " + String(nextMonth) +
-                 ", day: " + String(nextDay));
-
-  // *** Next day prayer times ***//
-  safeCopyPrayer(rtcData.NEXT_DAY_FAJR, nextDayPrayerTime.prayerTimes, 0);
-  safeCopyPrayer(rtcData.NEXT_DAY_SUNRISE, nextDayPrayerTime.prayerTimes, 1);
-  safeCopyPrayer(rtcData.NEXT_DAY_DHUHR, nextDayPrayerTime.prayerTimes, 2);
-  safeCopyPrayer(rtcData.NEXT_DAY_ASR, nextDayPrayerTime.prayerTimes, 3);
-  safeCopyPrayer(rtcData.NEXT_DAY_MAGHRIB, nextDayPrayerTime.prayerTimes, 4);
-  safeCopyPrayer(rtcData.NEXT_DAY_ISHA, nextDayPrayerTime.prayerTimes, 5);
-
-  /// *** Next day iqama times ***//
-  safeCopyPrayer(rtcData.NEXT_DAY_IQAMA_FAJR, nextDayIqamaTime.iqamaTimes, 0);
-  safeCopyPrayer(rtcData.NEXT_DAY_IQAMA_DHUHR, nextDayIqamaTime.iqamaTimes, 1);
-  safeCopyPrayer(rtcData.NEXT_DAY_IQAMA_ASR, nextDayIqamaTime.iqamaTimes, 2);
-  safeCopyPrayer(rtcData.NEXT_DAY_IQAMA_MAGHRIB, nextDayIqamaTime.iqamaTimes,
-                 3);
-  safeCopyPrayer(rtcData.NEXT_DAY_IQAMA_ISHA, nextDayIqamaTime.iqamaTimes, 4);
+
+  memcpy(times.today.prayers, window.days[index].prayers,
+         sizeof(times.today.prayers));
+  memcpy(times.nextDay.prayers, window.days[index + 1].prayers,
+         sizeof(times.nextDay.prayers));
+
+  // Iqama times are derived locally from the configured rules, except
+  // those an uploaded calendar fixed
+  IqamaRules::apply(rtcData.iqamaRules, times.today, weekday);
+  IqamaRules::apply(rtcData.iqamaRules, times.nextDay, (weekday + 1) % 7);
+  for (uint8_t row = 0; row < DaySchedule::IQAMA_COUNT; ++row) {
+    if (window.days[index].iqamas[row] < DaySchedule::MINUTES_PER_DAY)
+      times.today.iqamas[row] = window.days[index].iqamas[row];
+    if (window.days[index + 1].iqamas[row] < DaySchedule::MINUTES_PER_DAY)
+      times.nextDay.iqamas[row] = window.days[index + 1].iqamas[row];
+  }
+
+  rtcData.today = times.today;
+  rtcData.nextDay = times.nextDay;
   rtcData.day = day;
   rtcData.month = month;
   AppStateManager::save();
 
-  times.todayPrayerTimes = {rtcData.TODAY_FAJR,    rtcData.TODAY_SUNRISE,
-                            rtcData.TODAY_DHUHR,   rtcData.TODAY_ASR,
-                            rtcData.TODAY_MAGHRIB, rtcData.TODAY_ISHA};
-
-  times.todayIqamaTimes = {rtcData.TODAY_IQAMA_FAJR, rtcData.TODAY_IQAMA_DHUHR,
-                           rtcData.TODAY_IQAMA_ASR, rtcData.TODAY_IQAMA_MAGHRIB,
-                           rtcData.TODAY_IQAMA_ISHA};
-
-  times.nextDayPrayerTimes = {
-      rtcData.NEXT_DAY_FAJR, rtcData.NEXT_DAY_SUNRISE, rtcData.NEXT_DAY_DHUHR,
-      rtcData.NEXT_DAY_ASR,  rtcData.NEXT_DAY_MAGHRIB, rtcData.NEXT_DAY_ISHA};
-
-  times.nextDayIqamaTimes = {
-      rtcData.NEXT_DAY_IQAMA_FAJR, rtcData.NEXT_DAY_IQAMA_DHUHR,
-      rtcData.NEXT_DAY_IQAMA_ASR, rtcData.NEXT_DAY_IQAMA_MAGHRIB,
-      rtcData.NEXT_DAY_IQAMA_ISHA};
-
   return times;
 }
@@ -3,48 +3,97 @@
 
 #include <Arduino.h>
 #include <ArduinoJson.h>
+#include <DaySchedule.h>
 #include <FS.h>
-#include <vector>
 
-struct TodayPrayerTimes {
-  std::vector<String> prayerTimes;
-  std::vector<String> prayerTimesISODate;
-  bool isLastDayOfMonth = false;
-};
-struct IqamaTimes {
-  std::vector<String> iqamaTimes;
-};
+// Look-ahead policy: keep this many days (from today) of prayer data on
+// flash, fetching missing months on any Wi-Fi session. Below the alarm
+// threshold a fetch is forced outside the regular schedule.
+#ifndef CALENDAR_COVERAGE_DAYS
+#define CALENDAR_COVERAGE_DAYS 14
+#endif
+#ifndef CALENDAR_COVERAGE_ALARM_DAYS
+#define CALENDAR_COVERAGE_ALARM_DAYS 3
+#endif
 
-struct PrayerTimeInfo {
-  std::vector<String> prayerTimes;
-  std::vector<String> prayerTimesISODate;
-  std::vector<String> iqamaTimes;
-  String nextPrayerMinAndHour;
-};
 struct TodayAndNextDayPrayerTimes {
-  std::vector<String> todayPrayerTimes;
-  std::vector<String> todayIqamaTimes;
+  DaySchedule today;
+  DaySchedule nextDay;
+
+  bool isValid() const { return today.isValid() && nextDay.isValid(); }
+};
+
+// Prayer minutes of consecutive days (across month ends), kept in RTC memory
+// so day rollovers are served without touching flash. Refilled in one batch
+// when the window runs out. Iqamas are derived from the rules when a day is
+// taken out, unless an uploaded calendar fixed them.
+struct ScheduleWindow {
+  static constexpr uint8_t DAYS = 7;
+  struct Day {
+    uint16_t year = 0;
+    uint8_t month = 0; // 1..12
+    uint8_t day = 0;   // 1..31
+    uint16_t prayers[DaySchedule::PRAYER_COUNT] = {};
+    // Fixed iqama times; INVALID_MINUTES = from the rules
+    uint16_t iqamas[DaySchedule::IQAMA_COUNT] = {
+        DaySchedule::INVALID_MINUTES, DaySchedule::INVALID_MINUTES,
+        DaySchedule::INVALID_MINUTES, DaySchedule::INVALID_MINUTES,
+        DaySchedule::INVALID_MINUTES};
+  };
+  uint8_t count = 0;
+  Day days[DAYS];
 
-  std::vector<String> nextDayPrayerTimes;
-  std::vector<String> nextDayIqamaTimes;
+  int indexOf(int year, int month, int day) const {
+    for (uint8_t i = 0; i < count; ++i) {
+      if (days[i].year == year && days[i].month == month &&
+          days[i].day == day)
+        return i;
+    }
+    return -1;
+  }
 };
 
 class CalendarManager {
 public:
   CalendarManager();
-  String getMonthFilePath(int month, bool isIqama = false);
-  TodayPrayerTimes fetchTodayPrayerTimes(int month, int day);
-  IqamaTimes fetchTodayIqamaTimes(int month, int day);
-  PrayerTimeInfo getNextPrayerTimeForToday(int month, int day, int currentHour,
-                                           int currentMinute,
-                                           bool fetchTomorrow = false);
-  TodayAndNextDayPrayerTimes fetchTodayAndNextDayPrayerTimes(int month,
-                                                             int day);
-  bool isLaterThan(int hour, int minute, const String &timeStr);
+  // "/prayer_times_2026_01.json"
+  static String getMonthFilePath(int year, int month);
+  // weekday of `day` (0 = Sunday), used for the Jumu'ah iqama rule
+  TodayAndNextDayPrayerTimes
+  fetchTodayAndNextDayPrayerTimes(int year, int month, int day, int weekday);
+  // Drops the RTC window and day cache, call when the month files change
+  static void invalidateCache();
+  // Deletes every stored month (e.g. the location changed) and the caches.
+  // A month file named in 'keep' stays, so the screen has data until it is
+  // refetched.
+  static void removeStoredMonths(const String &keep = "");
+
+  // Consecutive days from 'today' covered by month files on flash, capped
+  // at horizonDays. If short, the first missing month is reported.
+  static int coverageDays(const struct tm &today, int horizonDays,
+                          int *missingYear = nullptr,
+                          int *missingMonth = nullptr);
+  static int daysInMonth(int year, int month);
+
+  // Calendar uploaded over BLE (UPLOADED_CALENDAR_FILE, see CalendarFile.h).
+  // It takes precedence over fetched months for the days it covers.
+  static bool hasUploadedCalendar();
+  // Weather snapshot of one day; false if none
+  static bool uploadedWeather(int year, int month, int day,
+                              int8_t &temperature, uint8_t &weatherCode);
+  static void removeUploadedCalendar();
 
 private:
-  int currentMonth;
-  int currentDay;
+  // Refills rtcData.scheduleWindow starting at the given day; returns days
+  uint8_t fillWindow(int year, int month, int day);
+  // Appends days firstDay.. of one month file to the window; sets
+  // reachedMonthEnd when the file has no more days
+  bool appendMonthDays(int year, int month, int firstDay,
+                       bool &reachedMonthEnd);
+  // Fills the window from the uploaded calendar; returns days added
+  uint8_t appendUploadedDays(int year, int month, int day);
+  // Days from 'today' the uploaded calendar still covers, 0 if none
+  static int uploadedCoverageDays(const struct tm &today);
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,216 @@
+#include "CalendarUpload.h"
+#include "AppState.h"
+#include "CalendarFile.h"
+#include "CalendarManager.h"
+#include <ArduinoJson.h>
+#include <Logger.h>
+#include <SPIFFSHelper.h>
+#include <esp_rom_crc.h>
+
+// Flash kept free for month files, settings and TLS sessions
+static const size_t FLASH_RESERVE = 16 * 1024;
+
+struct UploadInfo {
+  uint32_t id = 0;
+  uint32_t size = 0; // 0 = no upload in progress
+  uint32_t crc = 0;
+};
+
+// The upload being received; reloaded from flash by begin()
+static UploadInfo current;
+static uint32_t storedBytes = 0;
+
+static bool loadInfo(UploadInfo &info) {
+  JsonDocument doc;
+  if (!fileExists(CALENDAR_UPLOAD_FILE) ||
+      !readJsonFile(CALENDAR_UPLOAD_FILE, doc)) {
+    return false;
+  }
+  info.id = doc["id"] | 0u;
+  info.size = doc["size"] | 0u;
+  info.crc = doc["crc"] | 0u;
+  return info.size > 0;
+}
+
+static bool saveInfo(const UploadInfo &info) {
+  JsonDocument doc;
+  doc["id"] = info.id;
+  doc["size"] = info.size;
+  doc["crc"] = info.crc;
+  String json;
+  serializeJson(doc, json);
+  return writeJsonFile(CALENDAR_UPLOAD_FILE, json);
+}
+
+// Drops the partial file and its bookkeeping
+static void discard() {
+  File part = openPendingWrite(UPLOADED_CALENDAR_FILE, FILE_APPEND);
+  commitAtomicWrite(part, UPLOADED_CALENDAR_FILE, false);
+  if (APP_FS.exists(CALENDAR_UPLOAD_FILE)) {
+    APP_FS.remove(CALENDAR_UPLOAD_FILE);
+  }
+  current = UploadInfo();
+  storedBytes = 0;
+}
+
+bool CalendarUpload::begin(uint32_t id, uint32_t size, uint32_t crc,
+                           uint32_t &stored) {
+  stored = 0;
+  if (size < CalendarFile::fileSize(1) ||
+      size > CalendarFile::fileSize(CalendarFile::MAX_DAYS)) {
+    LOG_W("⚠️ Calendar upload of %lu bytes refused", (unsigned long)size);
+    return false;
+  }
+
+  UploadInfo saved;
+  if (loadInfo(saved) && saved.id == id && saved.size == size &&
+      saved.crc == crc) {
+    storedBytes = pendingAtomicWriteSize(UPLOADED_CALENDAR_FILE);
+    if (storedBytes <= size) {
+      current = saved;
+      stored = storedBytes;
+      LOG_I("📥 Resuming calendar upload at %lu/%lu bytes",
+            (unsigned long)stored, (unsigned long)size);
+      return true;
+    }
+  }
+
+  // New upload: truncate whatever was left of an older one
+  File part = beginAtomicWrite(UPLOADED_CALENDAR_FILE);
+  if (!part) {
+    LOG_E("❌ Cannot create calendar upload file");
+    return false;
+  }
+  part.close();
+  const size_t freeBytes = APP_FS.totalBytes() - APP_FS.usedBytes();
+  if (freeBytes < size + FLASH_RESERVE) {
+    LOG_E("❌ No room for a %lu byte calendar (%u free)", (unsigned long)size,
+          (unsigned)freeBytes);
+    discard();
+    return false;
+  }
+
+  current.id = id;
+  current.size = size;
+  current.crc = crc;
+  storedBytes = 0;
+  if (!saveInfo(current)) {
+    discard();
+    return false;
+  }
+  LOG_I("📥 Calendar upload started, %lu bytes", (unsigned long)size);
+  return true;
+}
+
+bool CalendarUpload::write(uint32_t id, uint32_t offset, const uint8_t *data,
+                           size_t length, uint32_t &stored) {
+  stored = storedBytes;
+  if (current.size == 0 || id != current.id) {
+    return false; // BEGIN first, also after a reset
+  }
+  if (offset != storedBytes) {
+    // A piece resent after a lost ACK is harmless; a gap is not
+    return offset < storedBytes;
+  }
+  if (storedBytes + length > current.size) {
+    return false;
+  }
+
+  File part = openPendingWrite(UPLOADED_CALENDAR_FILE, FILE_APPEND);
+  if (!part) {
+    return false;
+  }
+  const size_t written = part.write(data, length);
+  part.close();
+  storedBytes += written;
+  stored = storedBytes;
+  return written == length;
+}
+
+static uint32_t fileCrc(File &part) {
+  uint8_t buffer[256];
+  uint32_t crc = 0;
+  int n;
+  while ((n = part.read(buffer, sizeof(buffer))) > 0) {
+    crc = esp_rom_crc32_le(crc, buffer, n);
+  }
+  return crc;
+}
+
+// Header and every record must make sense before the file replaces the
+// current one
+static bool checkLayout(File &part, uint32_t size) {
+  CalendarFile::Header header;
+  if (part.read((uint8_t *)&header, sizeof(header)) != sizeof(header)) {
+    return false;
+  }
+  if (!CalendarFile::isMagic(header) ||
+      header.version != CalendarFile::VERSION ||
+      header.recordSize != sizeof(CalendarFile::DayRecord) ||
+      header.dayCount == 0 || header.dayCount > CalendarFile::MAX_DAYS ||
+      CalendarFile::fileSize(header.dayCount) != size ||
+      header.firstMonth < 1 || header.firstMonth > 12 ||
+      header.firstDay < 1 ||
+      header.firstDay >
+          CalendarManager::daysInMonth(header.firstYear, header.firstMonth)) {
+    LOG_W("⚠️ Uploaded calendar has a bad header");
+    return false;
+  }
+
+  bool valid = true;
+  CalendarFile::DayRecord record;
+  for (uint16_t i = 0; i < header.dayCount; ++i) {
+    if (part.read((uint8_t *)&record, sizeof(record)) != sizeof(record)) {
+      return false;
+    }
+    for (uint8_t p = 0; p < DaySchedule::PRAYER_COUNT; ++p) {
+      valid = valid && record.prayers[p] < DaySchedule::MINUTES_PER_DAY;
+    }
+    for (uint8_t r = 0; r < DaySchedule::IQAMA_COUNT; ++r) {
+      valid = valid && (record.iqamas[r] < DaySchedule::MINUTES_PER_DAY ||
+                        record.iqamas[r] == CalendarFile::NO_TIME);
+    }
+  }
+  if (!valid) {
+    LOG_W("⚠️ Uploaded calendar has invalid times");
+  }
+  return valid;
+}
+
+CalendarUpload::Result CalendarUpload::finish(uint32_t id) {
+  if (current.size == 0 || id != current.id ||
+      storedBytes != current.size) {
+    LOG_W("⚠️ Calendar upload incomplete (%lu/%lu bytes)",
+          (unsigned long)storedBytes, (unsigned long)current.size);
+    return FAILED;
+  }
+
+  File part = openPendingWrite(UPLOADED_CALENDAR_FILE, FILE_READ);
+  if (!part) {
+    return FAILED;
+  }
+  const uint32_t crc = fileCrc(part);
+  part.seek(0);
+  const bool layoutOk = crc == current.crc && checkLayout(part, current.size);
+  part.close();
+  if (crc != current.crc) {
+    LOG_W("⚠️ Calendar upload CRC mismatch");
+    discard();
+    return BAD_CHECKSUM;
+  }
+  if (!layoutOk) {
+    discard();
+    return FAILED;
+  }
+
+  part = openPendingWrite(UPLOADED_CALENDAR_FILE, FILE_APPEND);
+  if (!commitAtomicWrite(part, UPLOADED_CALENDAR_FILE)) {
+    return FAILED;
+  }
+  APP_FS.remove(CALENDAR_UPLOAD_FILE);
+  current = UploadInfo();
+  storedBytes = 0;
+  CalendarManager::invalidateCache();
+  LOG_I("✅ Uploaded calendar installed");
+  return INSTALLED;
+}
@@ -0,0 +1,28 @@
+#ifndef CALENDAR_UPLOAD_H
+#define CALENDAR_UPLOAD_H
+
+#include <Arduino.h>
+
+// Receives a calendar file (CalendarFile.h) in pieces over BLE. Bytes go
+// straight into the atomic-write temp file of UPLOADED_CALENDAR_FILE; the
+// upload's id, size and CRC are kept in CALENDAR_UPLOAD_FILE, so a
+// disconnect or even a reset only costs the piece in flight. The file is
+// swapped in once the CRC and the layout check out.
+class CalendarUpload {
+public:
+  enum Result { INSTALLED, BAD_CHECKSUM, FAILED };
+
+  // Starts a new upload, or continues the unfinished one with the same id,
+  // size and CRC. 'stored' is where the next write has to start. False if
+  // the file is too large or flash has no room for it.
+  static bool begin(uint32_t id, uint32_t size, uint32_t crc,
+                    uint32_t &stored);
+  // Appends a piece that must start at the stored size (a resent piece is
+  // ignored); 'stored' is updated either way
+  static bool write(uint32_t id, uint32_t offset, const uint8_t *data,
+                    size_t length, uint32_t &stored);
+  // Checks and installs the complete file
+  static Result finish(uint32_t id);
+};
+
+#endif // CALENDAR_UPLOAD_H
@@ -0,0 +1,49 @@
+#include "CpuGovernor.h"
+#include <Logger.h>
+#include <WiFi.h>
+
+static uint16_t phaseMhz[WAKE_PHASE_COUNT] = {
+    CPU_MHZ_IDLE,    // BOOT (never applied, setup() is already running)
+    CPU_MHZ_IDLE,    // RTC_LOAD
+    CPU_MHZ_IDLE,    // SCHEDULE
+    CPU_MHZ_IO,      // FS_MOUNT
+    CPU_MHZ_IO,      // DISPLAY_INIT
+    CPU_MHZ_RENDER,  // RENDER
+    CPU_MHZ_NETWORK, // NETWORK
+    CPU_MHZ_IDLE,    // SLEEP
+};
+
+static uint32_t floorMhz = 0;
+
+static bool radioActive() {
+  return WiFi.getMode() != WIFI_OFF || btStarted();
+}
+
+uint32_t CpuGovernor::apply(WakePhase phase) {
+  if (phase >= WAKE_PHASE_COUNT) {
+    return getCpuFrequencyMhz();
+  }
+  uint32_t mhz = phaseMhz[phase];
+  if (mhz < CPU_MHZ_RADIO_MIN && radioActive()) {
+    mhz = CPU_MHZ_RADIO_MIN;
+  }
+  if (mhz < floorMhz) {
+    mhz = floorMhz;
+  }
+  if (mhz != getCpuFrequencyMhz() && !setCpuFrequencyMhz(mhz)) {
+    LOG_W("⚠️ CPU clock %lu MHz rejected", (unsigned long)mhz);
+  }
+  return getCpuFrequencyMhz();
+}
+
+void CpuGovernor::setPolicy(WakePhase phase, uint32_t mhz) {
+  if (phase < WAKE_PHASE_COUNT) {
+    phaseMhz[phase] = (uint16_t)mhz;
+  }
+}
+
+void CpuGovernor::setFloor(uint32_t mhz) { floorMhz = mhz; }
+
+uint32_t CpuGovernor::policy(WakePhase phase) {
+  return phase < WAKE_PHASE_COUNT ? phaseMhz[phase] : 0;
+}
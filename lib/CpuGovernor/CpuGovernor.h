@@ -0,0 +1,39 @@
+#ifndef CPU_GOVERNOR_H
+#define CPU_GOVERNOR_H
+
+#include <Arduino.h>
+#include <WakeProfiler.h>
+
+// CPU clock per wake phase. Defaults can be overridden with build flags
+// (e.g. -DCPU_MHZ_RENDER=160) or at runtime with setPolicy() while tuning
+// against the per-phase energy figures WakeProfiler logs.
+// Valid ESP32-S3 steps: 240, 160, 80, 40, 20, 10 MHz.
+#ifndef CPU_MHZ_IDLE
+#define CPU_MHZ_IDLE 40 // RTC load, planning, sleep bookkeeping
+#endif
+#ifndef CPU_MHZ_IO
+#define CPU_MHZ_IO 80 // Filesystem, SPI display init
+#endif
+#ifndef CPU_MHZ_RENDER
+#define CPU_MHZ_RENDER 80 // Frame building, panel refresh wait
+#endif
+#ifndef CPU_MHZ_NETWORK
+#define CPU_MHZ_NETWORK 240 // TLS handshakes, JSON parsing
+#endif
+
+// Wi-Fi and BLE stop working below this clock
+#define CPU_MHZ_RADIO_MIN 80
+
+class CpuGovernor {
+public:
+  // Switches to the phase's clock, raised to CPU_MHZ_RADIO_MIN while a
+  // radio is up. Returns the clock now in effect.
+  static uint32_t apply(WakePhase phase);
+  static void setPolicy(WakePhase phase, uint32_t mhz);
+  // Lowest clock for every phase while some work needs it (audio
+  // decoding); 0 removes it
+  static void setFloor(uint32_t mhz);
+  static uint32_t policy(WakePhase phase);
+};
+
+#endif // CPU_GOVERNOR_H
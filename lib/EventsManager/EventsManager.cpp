@@ -46,12 +46,9 @@ void EventsManager::fetchTask(void *parameter) {
 
   Serial.printf("🌐 Fetching events from: %s\n", url.c_str());
 
-  WiFiClientSecure client;
-  client.setInsecure();
-  client.setTimeout(10000);
-
-  HTTPClient https;
-  if (!https.begin(client, url)) {
+  HttpsSession::Lease lease(url);
+  HTTPClient &https = lease.http();
+  if (!lease.ok() || !https.begin(lease.client(), url)) {
     Serial.println("❌ HTTPS.begin() failed");
   } else {
     https.addHeader("Authorization",
@@ -62,11 +59,19 @@ void EventsManager::fetchTask(void *parameter) {
     if (httpCode != HTTP_CODE_OK) {
       Serial.printf("❌ HTTP GET failed: %d\n", httpCode);
     } else {
-      String json = https.getString();
-      Serial.printf("📦 Received %d bytes\n", json.length());
+      // Keep only the event fields copied below
+      JsonDocument filter;
+      JsonObject itemFilter = filter["items"][0].to<JsonObject>();
+      itemFilter["eventType"] = true;
+      itemFilter["summary"] = true;
+      itemFilter["start"] = true;
+      itemFilter["creator"] = true;
+      itemFilter["attendees"][0]["self"] = true;
+      itemFilter["attendees"][0]["responseStatus"] = true;
 
       StaticJsonDocument<16384> sourceDoc;
-      DeserializationError error = deserializeJson(sourceDoc, json);
+      DeserializationError error =
+          HttpsSession::readJson(https, sourceDoc, filter);
       if (error) {
         Serial.printf("❌ JSON validation failed: %s\n", error.c_str());
       } else {
@@ -93,14 +98,15 @@ void EventsManager::fetchTask(void *parameter) {
           }
         }
 
-        File file = SPIFFS.open(EVENTS_JSON_PATH, FILE_WRITE);
+        File file = beginAtomicWrite(EVENTS_JSON_PATH);
         if (!file) {
           Serial.println("❌ Failed to open file for writing");
         } else {
-          serializeJson(filteredDoc, file);
-          file.close();
-          Serial.printf("✅ Filtered events saved to %s\n", EVENTS_JSON_PATH);
-          success = true;
+          const bool complete = serializeJson(filteredDoc, file) > 0;
+          if (commitAtomicWrite(file, EVENTS_JSON_PATH, complete)) {
+            Serial.printf("✅ Filtered events saved to %s\n", EVENTS_JSON_PATH);
+            success = true;
+          }
         }
       }
     }
@@ -117,7 +123,7 @@ void EventsManager::fetchTask(void *parameter) {
 }
 
 void EventsManager::listEventsForNextWeek() {
-  File file = SPIFFS.open(EVENTS_JSON_PATH, FILE_READ);
+  File file = openFileForRead(EVENTS_JSON_PATH);
   if (!file) {
     Serial.println("❌ Cannot open events.json");
     return;
@@ -5,8 +5,8 @@
 #include <ArduinoJson.h>
 #include <FS.h>
 #include <HTTPClient.h>
-#include <SPIFFS.h>
-#include <WiFiClientSecure.h>
+#include <HttpsSession.h>
+#include <SPIFFSHelper.h>
 
 #define EVENTS_JSON_PATH "/events.json"
 #define MAX_EVENT_FETCH_RETRIES 3
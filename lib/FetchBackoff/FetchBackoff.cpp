@@ -0,0 +1,130 @@
+#include "FetchBackoff.h"
+#include "AppStateManager.h"
+#include <Logger.h>
+
+static const char *const SOURCE_NAMES[FETCH_SOURCE_COUNT] = {
+    "wifi", "prayer", "weather", "ntp", "adhan"};
+
+static uint32_t localDay(time_t now) {
+  struct tm local;
+  localtime_r(&now, &local);
+  return (uint32_t)(local.tm_year + 1900) * 1000 + local.tm_yday;
+}
+
+// Next local midnight, when the radio budget starts over
+static time_t nextLocalMidnight(time_t now) {
+  struct tm local;
+  localtime_r(&now, &local);
+  local.tm_mday++;
+  local.tm_hour = 0;
+  local.tm_min = 0;
+  local.tm_sec = 0;
+  local.tm_isdst = -1;
+  return mktime(&local);
+}
+
+static void rollBudget(time_t now) {
+  const uint32_t today = localDay(now);
+  if (rtcData.backoff.radioDay != today) {
+    rtcData.backoff.radioDay = today;
+    rtcData.backoff.radioSeconds = 0;
+  }
+}
+
+bool FetchBackoff::budgetLeft(time_t now) {
+  rollBudget(now);
+  return rtcData.backoff.radioSeconds < RADIO_BUDGET_SECONDS;
+}
+
+void FetchBackoff::chargeRadio(time_t now, uint32_t seconds) {
+  if (seconds == 0) {
+    return;
+  }
+  rollBudget(now);
+  rtcData.backoff.radioSeconds += seconds;
+  LOG_D("📶 Radio %lu s this wake, %lu/%d s today", (unsigned long)seconds,
+        (unsigned long)rtcData.backoff.radioSeconds, RADIO_BUDGET_SECONDS);
+}
+
+bool FetchBackoff::ready(FetchSource source, time_t now) {
+  const FetchBackoffState &state = rtcData.backoff;
+  if (now < state.sources[FETCH_WIFI].nextAttempt ||
+      now < state.sources[source].nextAttempt) {
+    LOG_D("⏳ [%s] Backing off", SOURCE_NAMES[source]);
+    return false;
+  }
+  if (!budgetLeft(now)) {
+    LOG_W("📶 Daily radio budget spent, %s waits for tomorrow",
+          SOURCE_NAMES[source]);
+    return false;
+  }
+  return true;
+}
+
+void FetchBackoff::failure(FetchSource source, time_t now) {
+  FetchBackoffState::Source &s = rtcData.backoff.sources[source];
+  s.totalFailures++;
+  if (s.failures < UINT8_MAX) {
+    s.failures++;
+  }
+
+  uint32_t delaySeconds = BACKOFF_BASE_SECONDS;
+  for (uint8_t i = 1; i < s.failures && delaySeconds < BACKOFF_MAX_SECONDS;
+       ++i) {
+    delaySeconds *= 2;
+  }
+  if (delaySeconds > BACKOFF_MAX_SECONDS) {
+    delaySeconds = BACKOFF_MAX_SECONDS;
+  }
+  const uint32_t spread = delaySeconds * BACKOFF_JITTER_PERCENT / 100;
+  if (spread > 0) {
+    delaySeconds = delaySeconds - spread + esp_random() % (2 * spread + 1);
+  }
+
+  s.nextAttempt = now + delaySeconds;
+  LOG_W("⏳ [%s] Failure %u, next attempt in %lu min", SOURCE_NAMES[source],
+        s.failures, (unsigned long)(delaySeconds / 60));
+}
+
+void FetchBackoff::success(FetchSource source) {
+  rtcData.backoff.sources[source].totalSuccesses++;
+  clear(source);
+}
+
+void FetchBackoff::clear(FetchSource source) {
+  FetchBackoffState::Source &s = rtcData.backoff.sources[source];
+  s.failures = 0;
+  s.nextAttempt = 0;
+}
+
+uint8_t FetchBackoff::failures(FetchSource source) {
+  return rtcData.backoff.sources[source].failures;
+}
+
+void FetchBackoff::totals(FetchSource source, uint32_t &successes,
+                          uint32_t &failures) {
+  successes = rtcData.backoff.sources[source].totalSuccesses;
+  failures = rtcData.backoff.sources[source].totalFailures;
+}
+
+time_t FetchBackoff::earliest(FetchSource source, time_t due, time_t now) {
+  const FetchBackoffState &state = rtcData.backoff;
+  time_t at = due;
+  if (state.sources[FETCH_WIFI].nextAttempt > at) {
+    at = state.sources[FETCH_WIFI].nextAttempt;
+  }
+  if (state.sources[source].nextAttempt > at) {
+    at = state.sources[source].nextAttempt;
+  }
+  if (!budgetLeft(now)) {
+    const time_t midnight = nextLocalMidnight(now);
+    if (midnight > at) {
+      at = midnight;
+    }
+  }
+  return at;
+}
+
+const char *FetchBackoff::name(FetchSource source) {
+  return source < FETCH_SOURCE_COUNT ? SOURCE_NAMES[source] : "";
+}
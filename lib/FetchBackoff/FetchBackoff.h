@@ -0,0 +1,70 @@
+#ifndef FETCH_BACKOFF_H
+#define FETCH_BACKOFF_H
+
+#include <Arduino.h>
+#include <time.h>
+
+// Retry spacing after a failure: BASE, 2x, 4x ... capped at MAX, each
+// spread by +-JITTER percent so a fleet does not retry in lockstep
+#ifndef BACKOFF_BASE_SECONDS
+#define BACKOFF_BASE_SECONDS (10 * 60)
+#endif
+#ifndef BACKOFF_MAX_SECONDS
+#define BACKOFF_MAX_SECONDS (6 * 60 * 60)
+#endif
+#ifndef BACKOFF_JITTER_PERCENT
+#define BACKOFF_JITTER_PERCENT 20
+#endif
+// Radio-on time allowed per local day for periodic fetches
+#ifndef RADIO_BUDGET_SECONDS
+#define RADIO_BUDGET_SECONDS (15 * 60)
+#endif
+
+// Things that can fail independently. FETCH_WIFI gates all the others: when
+// the access point is down there is no point trying any server.
+enum FetchSource : uint8_t {
+  FETCH_WIFI = 0,
+  FETCH_PRAYER,
+  FETCH_WEATHER,
+  FETCH_NTP,
+  FETCH_ADHAN, // Multi-megabyte file, only retried after a backoff
+  FETCH_SOURCE_COUNT
+};
+
+// Kept in RTC memory (rtcData.backoff)
+struct FetchBackoffState {
+  struct Source {
+    time_t nextAttempt = 0; // Epoch before which the source is not tried
+    uint32_t totalSuccesses = 0; // Since power-on, for telemetry
+    uint32_t totalFailures = 0;
+    uint8_t failures = 0;   // Consecutive failures
+  };
+  Source sources[FETCH_SOURCE_COUNT];
+  uint32_t radioDay = 0;     // Local day the budget below belongs to
+  uint32_t radioSeconds = 0; // Radio-on time spent that day
+};
+
+class FetchBackoff {
+public:
+  // True if 'source' (and Wi-Fi) are out of backoff and today's radio
+  // budget is not spent
+  static bool ready(FetchSource source, time_t now);
+  static void failure(FetchSource source, time_t now);
+  static void success(FetchSource source);
+  // Lifts the backoff without counting a success (settings changed)
+  static void clear(FetchSource source);
+  static uint8_t failures(FetchSource source);
+  static void totals(FetchSource source, uint32_t &successes,
+                     uint32_t &failures);
+
+  // When a fetch that is due at 'due' can actually run
+  static time_t earliest(FetchSource source, time_t due, time_t now);
+
+  // Adds one wake's radio-on time to today's total
+  static void chargeRadio(time_t now, uint32_t seconds);
+  static bool budgetLeft(time_t now);
+
+  static const char *name(FetchSource source);
+};
+
+#endif // FETCH_BACKOFF_H
@@ -0,0 +1,72 @@
+#include "HijriCalendar.h"
+#include "AppStateManager.h"
+#include <Logger.h>
+
+// ASCII transliterations, the Cairo GFX fonts only cover 7-bit glyphs
+static const char *const HIJRI_MONTHS[12] = {
+    "Muharram", "Safar",   "Rabi I",  "Rabi II", "Jumada I", "Jumada II",
+    "Rajab",    "Sha'ban", "Ramadan", "Shawwal", "Dhu al-Qi'dah",
+    "Dhu al-Hijjah"};
+
+static long julianDayNumber(int year, int month, int day) {
+  int a = (14 - month) / 12;
+  long y = year + 4800 - a;
+  int m = month + 12 * a - 3;
+  return day + (153 * m + 2) / 5 + 365 * y + y / 4 - y / 100 + y / 400 -
+         32045;
+}
+
+HijriDate HijriCalendar::fromGregorian(int year, int month, int day,
+                                       int adjustDays) {
+  // Integer form of the 30-year tabular cycle (11 leap years per cycle)
+  long l = julianDayNumber(year, month, day) + adjustDays - 1948440 + 10632;
+  long n = (l - 1) / 10631;
+  l = l - 10631 * n + 354;
+  long j = ((10985 - l) / 5316) * ((50 * l) / 17719) +
+           (l / 5670) * ((43 * l) / 15238);
+  l = l - ((30 - j) / 15) * ((17719 * j) / 50) -
+      (j / 16) * ((15238 * j) / 43) + 29;
+  long m = (24 * l) / 709;
+
+  HijriDate date;
+  date.month = (uint8_t)m;
+  date.day = (uint8_t)(l - (709 * m) / 24);
+  date.year = (uint16_t)(30 * n + j - 30);
+  return date;
+}
+
+HijriDate HijriCalendar::today(const struct tm &timeinfo) {
+  HijriCache &cache = rtcData.hijri;
+  const uint16_t year = timeinfo.tm_year + 1900;
+  const uint8_t month = timeinfo.tm_mon + 1;
+  const uint8_t day = timeinfo.tm_mday;
+
+  if (cache.gregorianYear != year || cache.gregorianMonth != month ||
+      cache.gregorianDay != day || cache.date.month == 0) {
+    cache.date =
+        fromGregorian(year, month, day, rtcData.hijriAdjustmentDays);
+    cache.gregorianYear = year;
+    cache.gregorianMonth = month;
+    cache.gregorianDay = day;
+    LOG_I("🌙 Hijri date: %d/%d/%d", cache.date.day,
+          cache.date.month, cache.date.year);
+  }
+  return cache.date;
+}
+
+const char *HijriCalendar::monthName(uint8_t month) {
+  if (month < 1 || month > 12)
+    return "";
+  return HIJRI_MONTHS[month - 1];
+}
+
+bool HijriCalendar::format(const HijriDate &date, char *out, size_t outSize) {
+  if (date.month < 1 || date.month > 12 || date.day == 0) {
+    if (outSize > 0)
+      out[0] = '\0';
+    return false;
+  }
+  snprintf(out, outSize, "%d %s %d", date.day, monthName(date.month),
+           date.year);
+  return true;
+}
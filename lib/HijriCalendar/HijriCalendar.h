@@ -0,0 +1,39 @@
+#ifndef HIJRI_CALENDAR_H
+#define HIJRI_CALENDAR_H
+
+#include <Arduino.h>
+#include <time.h>
+
+struct HijriDate {
+  uint16_t year = 0;
+  uint8_t month = 0; // 1..12
+  uint8_t day = 0;   // 1..30
+};
+
+// Hijri date of one Gregorian day, kept in RTC memory so the conversion runs
+// once per day rollover rather than on every minute wake.
+struct HijriCache {
+  uint16_t gregorianYear = 0;
+  uint8_t gregorianMonth = 0;
+  uint8_t gregorianDay = 0;
+  HijriDate date;
+};
+
+class HijriCalendar {
+public:
+  // Arithmetic (tabular) Islamic calendar. adjustDays shifts the result to
+  // follow local moon sighting (typically -2..+2).
+  static HijriDate fromGregorian(int year, int month, int day,
+                                 int adjustDays = 0);
+
+  // Hijri date for a local broken-down time, served from rtcData's cache
+  // when the Gregorian day has not changed.
+  static HijriDate today(const struct tm &timeinfo);
+
+  static const char *monthName(uint8_t month);
+
+  // "15 Ramadan 1447"; returns false (and "") if date is unset
+  static bool format(const HijriDate &date, char *out, size_t outSize);
+};
+
+#endif // HIJRI_CALENDAR_H
@@ -0,0 +1,88 @@
+#include "HttpCache.h"
+#include <ArduinoJson.h>
+#include <SPIFFSHelper.h>
+
+static const char *const VALIDATOR_HEADERS[] = {"ETag", "Last-Modified"};
+
+// Entries are keyed by a hash of the URL, which stays short for long
+// query strings and changes with location or method
+static String keyOf(const String &url) {
+  char key[9];
+  snprintf(key, sizeof(key), "%08lx",
+           (unsigned long)fnv1a((const uint8_t *)url.c_str(), url.length()));
+  return String(key);
+}
+
+void HttpCache::prepare(HTTPClient &http, const String &url, bool haveCopy) {
+  http.collectHeaders(VALIDATOR_HEADERS, 2);
+  if (!haveCopy) {
+    return; // A 304 would leave the caller with nothing
+  }
+
+  JsonDocument doc;
+  if (!readJsonFile(HTTP_CACHE_FILE, doc)) {
+    return;
+  }
+  JsonObject entry = doc[keyOf(url)];
+  const char *etag = entry["e"] | "";
+  const char *modified = entry["m"] | "";
+  if (etag[0] != '\0') {
+    http.addHeader("If-None-Match", etag);
+  }
+  if (modified[0] != '\0') {
+    http.addHeader("If-Modified-Since", modified);
+  }
+}
+
+HttpCache::Validators HttpCache::validators(HTTPClient &http) {
+  return Validators{http.header("ETag"), http.header("Last-Modified")};
+}
+
+void HttpCache::store(const String &url, const Validators &validators,
+                      uint32_t bodyHash) {
+  JsonDocument doc;
+  readJsonFile(HTTP_CACHE_FILE, doc);
+  if (!doc.is<JsonObject>()) {
+    doc.to<JsonObject>();
+  }
+
+  const String key = keyOf(url);
+  const String &etag = validators.etag;
+  const String &modified = validators.modified;
+  JsonObject old = doc[key];
+  if (old && (old["h"] | 0u) == bodyHash && etag == (old["e"] | "") &&
+      modified == (old["m"] | "")) {
+    return; // Nothing new, spare the flash write
+  }
+
+  // Re-inserted at the end, so the first entries are the least recent
+  doc.remove(key);
+  JsonObject entry = doc[key].to<JsonObject>();
+  if (etag.length() > 0) {
+    entry["e"] = etag;
+  }
+  if (modified.length() > 0) {
+    entry["m"] = modified;
+  }
+  entry["h"] = bodyHash;
+
+  JsonObject root = doc.as<JsonObject>();
+  while (root.size() > HTTP_CACHE_MAX_ENTRIES) {
+    root.remove(root.begin());
+  }
+
+  String json;
+  serializeJson(doc, json);
+  writeJsonFile(HTTP_CACHE_FILE, json);
+}
+
+bool HttpCache::sameBody(const String &url, uint32_t bodyHash) {
+  JsonDocument doc;
+  if (!readJsonFile(HTTP_CACHE_FILE, doc)) {
+    return false;
+  }
+  JsonVariant stored = doc[keyOf(url)]["h"];
+  return stored.is<uint32_t>() && stored.as<uint32_t>() == bodyHash;
+}
+
+void HttpCache::clear() { deleteFile(HTTP_CACHE_FILE); }
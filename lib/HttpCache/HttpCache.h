@@ -0,0 +1,62 @@
+#ifndef HTTP_CACHE_H
+#define HTTP_CACHE_H
+
+#include <Arduino.h>
+#include <Fnv1a.h>
+#include <HTTPClient.h>
+
+#define HTTP_CACHE_FILE "/http_cache.json"
+#ifndef HTTP_CACHE_MAX_ENTRIES
+#define HTTP_CACHE_MAX_ENTRIES 16
+#endif
+
+// Validators (ETag, Last-Modified) and body hashes of remote resources,
+// kept on flash per URL. An unchanged resource then costs a 304 instead of
+// a download, or at least skips the parse and the flash rewrite when the
+// server sends no validators.
+class HttpCache {
+public:
+  struct Validators {
+    String etag;
+    String modified; // Last-Modified
+  };
+
+  // Call between http.begin() and GET(). Asks for the response validators
+  // and, if the caller still has its copy, sends the stored ones as
+  // If-None-Match / If-Modified-Since (a 304 then means "keep it").
+  static void prepare(HTTPClient &http, const String &url, bool haveCopy);
+  // Validators of the current response; read them before http.end()
+  static Validators validators(HTTPClient &http);
+  // Once the body of a 200 has been kept: remembers validators and hash
+  static void store(const String &url, const Validators &validators,
+                    uint32_t bodyHash);
+  // True if bodyHash (fnv1a of the body) equals the hash stored for url
+  static bool sameBody(const String &url, uint32_t bodyHash);
+  static void clear();
+};
+
+// Forwards writes to 'target' while hashing them, so a body streamed to a
+// file is hashed without a second pass
+class HashingStream : public Stream {
+public:
+  explicit HashingStream(Stream &target) : target(target) {}
+
+  size_t write(uint8_t data) override { return write(&data, 1); }
+  size_t write(const uint8_t *buf, size_t size) override {
+    const size_t written = target.write(buf, size);
+    digest = fnv1a(buf, written, digest);
+    return written;
+  }
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+  void flush() override { target.flush(); }
+
+  uint32_t value() const { return digest; }
+
+private:
+  Stream &target;
+  uint32_t digest = FNV1A_SEED;
+};
+
+#endif // HTTP_CACHE_H
@@ -0,0 +1,80 @@
+#include "HttpsSession.h"
+#include <Logger.h>
+
+struct SharedSession {
+  TlsClient client;
+  HTTPClient http;
+  char host[64] = ""; // Host the open connection (if any) belongs to
+};
+
+static SharedSession &session() {
+  static SharedSession instance;
+  return instance;
+}
+
+static SemaphoreHandle_t sessionLock() {
+  static SemaphoreHandle_t lock = xSemaphoreCreateMutex();
+  return lock;
+}
+
+// "https://host:port/path" -> "host:port"
+static void hostOf(const String &url, char *out, size_t outSize) {
+  int start = url.indexOf("://");
+  start = start < 0 ? 0 : start + 3;
+  int end = url.indexOf('/', start);
+  if (end < 0) {
+    end = url.length();
+  }
+  strlcpy(out, url.substring(start, end).c_str(), outSize);
+}
+
+HttpsSession::Lease::Lease(const String &url, uint32_t waitMs) {
+  held = xSemaphoreTake(sessionLock(), pdMS_TO_TICKS(waitMs)) == pdTRUE;
+  if (!held) {
+    LOG_W("🔒 HTTPS session busy, request dropped");
+    return;
+  }
+
+  SharedSession &s = session();
+  char host[sizeof(s.host)];
+  hostOf(url, host, sizeof(host));
+  if (strcmp(host, s.host) != 0) {
+    // Keep-alive only helps for the same host
+    s.client.stop();
+    strlcpy(s.host, host, sizeof(s.host));
+  } else if (s.client.connected()) {
+    LOG_D("🔗 Reusing open HTTPS connection");
+  }
+}
+
+HttpsSession::Lease::~Lease() {
+  if (held) {
+    xSemaphoreGive(sessionLock());
+  }
+}
+
+TlsClient &HttpsSession::Lease::client() { return session().client; }
+
+HTTPClient &HttpsSession::Lease::http() { return session().http; }
+
+DeserializationError HttpsSession::readJson(HTTPClient &http,
+                                            JsonDocument &doc,
+                                            const JsonDocument &filter) {
+  DeserializationOption::Filter option(filter.as<JsonVariantConst>());
+  if (http.getSize() >= 0) {
+    return deserializeJson(doc, http.getStream(), option);
+  }
+  // getString() undoes the chunked transfer encoding
+  return deserializeJson(doc, http.getString(), option);
+}
+
+void HttpsSession::close() {
+  if (xSemaphoreTake(sessionLock(), pdMS_TO_TICKS(1000)) != pdTRUE) {
+    return; // A fetch is still running; Wi-Fi going down will end it
+  }
+  SharedSession &s = session();
+  s.http.end();
+  s.client.stop();
+  s.host[0] = '\0';
+  xSemaphoreGive(sessionLock());
+}
@@ -0,0 +1,43 @@
+#ifndef HTTPS_SESSION_H
+#define HTTPS_SESSION_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <HTTPClient.h>
+#include <TlsClient.h>
+
+// One TLS client and HTTP client shared by every HTTPS fetch of a Wi-Fi
+// session. The connection is kept alive between requests to the same host,
+// so retries and follow-up requests skip the TLS handshake; a request to
+// another host closes it first. New connections resume the host's last
+// TLS session where the server allows it (see TlsClient).
+class HttpsSession {
+public:
+  // Exclusive use of the shared clients for one request (or a retry loop).
+  // Fetch tasks run one after another, the lock only guards against overlap.
+  class Lease {
+  public:
+    explicit Lease(const String &url, uint32_t waitMs = 30000);
+    ~Lease();
+    Lease(const Lease &) = delete;
+    Lease &operator=(const Lease &) = delete;
+
+    bool ok() const { return held; } // False if the session stayed busy
+    TlsClient &client();
+    HTTPClient &http();
+
+  private:
+    bool held = false;
+  };
+
+  // Parses the body of the current response through 'filter'. Streams it
+  // straight from the socket when the length is known; chunked responses
+  // are de-chunked into a buffer first.
+  static DeserializationError readJson(HTTPClient &http, JsonDocument &doc,
+                                       const JsonDocument &filter);
+
+  // Drops the connection; call before Wi-Fi goes down
+  static void close();
+};
+
+#endif // HTTPS_SESSION_H
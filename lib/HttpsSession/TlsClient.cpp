@@ -0,0 +1,346 @@
+#include "TlsClient.h"
+#include <Fnv1a.h>
+#include <Logger.h>
+#include <SPIFFSHelper.h>
+#include <esp_timer.h>
+#include <mbedtls/net_sockets.h>
+#include <memory>
+#include <time.h>
+#include <vector>
+
+// Struct members became private in mbedTLS 3
+#ifndef MBEDTLS_PRIVATE
+#define MBEDTLS_PRIVATE(member) member
+#endif
+
+#define TLS_SESSION_MAGIC 0x534C5454 // "TTLS"
+#define TLS_SESSION_PREFIX "/tls_"
+// Serialised sessions carry the peer certificate, about 1-2 KB
+#define TLS_SESSION_MAX_BYTES 3072
+
+struct SessionFileHeader {
+  uint32_t magic;
+  uint32_t savedAt; // Epoch
+  uint16_t length;  // Serialised session bytes that follow
+};
+
+// One file per host: "/tls_<FNV-1a of host>.bin"
+static String sessionPath(const char *host) {
+  char path[24];
+  snprintf(path, sizeof(path), TLS_SESSION_PREFIX "%08lx.bin",
+           (unsigned long)fnv1a((const uint8_t *)host, strlen(host)));
+  return String(path);
+}
+
+// Offers the stored session for 'host'; false if none is usable. 'hash'
+// identifies the stored bytes so an unchanged session is not rewritten.
+static bool loadSession(const char *host, mbedtls_ssl_context &ssl,
+                        mbedtls_ssl_session &session, uint32_t &hash) {
+  const String path = sessionPath(host);
+  if (!fileExists(path)) {
+    return false;
+  }
+  File file = openFileForRead(path);
+  SessionFileHeader header;
+  if (!file || file.read((uint8_t *)&header, sizeof(header)) != sizeof(header) ||
+      header.magic != TLS_SESSION_MAGIC || header.length == 0 ||
+      header.length > TLS_SESSION_MAX_BYTES) {
+    return false;
+  }
+  const time_t now = time(nullptr);
+  if (now > 100000 && now - (time_t)header.savedAt > TLS_SESSION_MAX_AGE) {
+    return false; // Stale, the server would refuse it
+  }
+
+  std::unique_ptr<uint8_t[]> blob(new (std::nothrow) uint8_t[header.length]);
+  if (!blob || file.read(blob.get(), header.length) != header.length) {
+    return false;
+  }
+  file.close();
+
+  hash = fnv1a(blob.get(), header.length);
+  return mbedtls_ssl_session_load(&session, blob.get(), header.length) == 0 &&
+         mbedtls_ssl_set_session(&ssl, &session) == 0;
+}
+
+static void saveSession(const char *host, const mbedtls_ssl_context &ssl,
+                        uint32_t storedHash) {
+  mbedtls_ssl_session session;
+  mbedtls_ssl_session_init(&session);
+  size_t length = 0;
+  std::unique_ptr<uint8_t[]> blob(new (std::nothrow) uint8_t[TLS_SESSION_MAX_BYTES]);
+  const bool saved = blob &&
+                     mbedtls_ssl_get_session(&ssl, &session) == 0 &&
+                     mbedtls_ssl_session_save(&session, blob.get(),
+                                              TLS_SESSION_MAX_BYTES,
+                                              &length) == 0;
+  mbedtls_ssl_session_free(&session);
+  if (!saved || length == 0) {
+    LOG_D("🔐 TLS session not stored");
+    return;
+  }
+  if (fnv1a(blob.get(), length) == storedHash) {
+    return; // Resumed without a new ticket, the file is still current
+  }
+
+  const String path = sessionPath(host);
+  File file = beginAtomicWrite(path);
+  if (!file) {
+    return;
+  }
+  const time_t now = time(nullptr);
+  SessionFileHeader header = {TLS_SESSION_MAGIC, (uint32_t)now,
+                              (uint16_t)length};
+  const bool complete =
+      file.write((const uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+      file.write(blob.get(), length) == length;
+  commitAtomicWrite(file, path, complete);
+}
+
+void TlsClient::forgetSessions() {
+  File root = APP_FS.open("/");
+  if (!root) {
+    return;
+  }
+  std::vector<String> paths;
+  for (File file = root.openNextFile(); file; file = root.openNextFile()) {
+    const String path = file.path();
+    if (path.startsWith(TLS_SESSION_PREFIX)) {
+      paths.push_back(path);
+    }
+  }
+  root.close();
+  for (const String &path : paths) {
+    APP_FS.remove(path);
+  }
+}
+
+// Transport for mbedTLS: the plain TCP side of this client
+static int sendBio(void *ctx, const unsigned char *buf, size_t len) {
+  WiFiClient *tcp = static_cast<WiFiClient *>(ctx);
+  const size_t sent = tcp->WiFiClient::write(buf, len);
+  return sent > 0 ? (int)sent : MBEDTLS_ERR_NET_SEND_FAILED;
+}
+
+static int recvBio(void *ctx, unsigned char *buf, size_t len) {
+  WiFiClient *tcp = static_cast<WiFiClient *>(ctx);
+  if (tcp->WiFiClient::available() <= 0) {
+    return tcp->WiFiClient::connected() ? MBEDTLS_ERR_SSL_WANT_READ
+                                        : MBEDTLS_ERR_NET_CONN_RESET;
+  }
+  const int got = tcp->WiFiClient::read(buf, len);
+  return got > 0 ? got : MBEDTLS_ERR_SSL_WANT_READ;
+}
+
+TlsClient::TlsClient() {
+  mbedtls_ssl_init(&ssl);
+  mbedtls_ssl_config_init(&conf);
+  mbedtls_ctr_drbg_init(&drbg);
+  mbedtls_entropy_init(&entropy);
+}
+
+TlsClient::~TlsClient() {
+  stop();
+  mbedtls_ssl_free(&ssl);
+  mbedtls_ssl_config_free(&conf);
+  mbedtls_ctr_drbg_free(&drbg);
+  mbedtls_entropy_free(&entropy);
+}
+
+int TlsClient::connect(IPAddress ip, uint16_t port) {
+  return connect(ip.toString().c_str(), port, _timeout);
+}
+
+int TlsClient::connect(IPAddress ip, uint16_t port, int32_t timeout) {
+  return connect(ip.toString().c_str(), port, timeout);
+}
+
+int TlsClient::connect(const char *host, uint16_t port) {
+  return connect(host, port, _timeout);
+}
+
+int TlsClient::connect(const char *host, uint16_t port, int32_t timeout) {
+  stop();
+  if (!WiFiClient::connect(host, port, timeout)) {
+    return 0;
+  }
+  if (!startTls(host, timeout)) {
+    stop();
+    return 0;
+  }
+  return 1;
+}
+
+bool TlsClient::startTls(const char *host, int32_t timeoutMs) {
+  freeTls();
+  mbedtls_ssl_init(&ssl);
+  mbedtls_ssl_config_init(&conf);
+  mbedtls_ctr_drbg_init(&drbg);
+  mbedtls_entropy_init(&entropy);
+  tlsActive = true;
+
+  if (mbedtls_ctr_drbg_seed(&drbg, mbedtls_entropy_func, &entropy, nullptr,
+                            0) != 0 ||
+      mbedtls_ssl_config_defaults(&conf, MBEDTLS_SSL_IS_CLIENT,
+                                  MBEDTLS_SSL_TRANSPORT_STREAM,
+                                  MBEDTLS_SSL_PRESET_DEFAULT) != 0) {
+    LOG_E("❌ TLS setup failed");
+    return false;
+  }
+  mbedtls_ssl_conf_authmode(&conf, MBEDTLS_SSL_VERIFY_NONE);
+  mbedtls_ssl_conf_rng(&conf, mbedtls_ctr_drbg_random, &drbg);
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+  mbedtls_ssl_conf_session_tickets(&conf, MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
+#endif
+  if (mbedtls_ssl_setup(&ssl, &conf) != 0 ||
+      mbedtls_ssl_set_hostname(&ssl, host) != 0) {
+    LOG_E("❌ TLS setup failed");
+    return false;
+  }
+  mbedtls_ssl_set_bio(&ssl, static_cast<WiFiClient *>(this), sendBio,
+                      recvBio, nullptr);
+
+  // A resumed handshake carries the offered session's master secret over,
+  // a full one derives a new one
+  mbedtls_ssl_session offered;
+  mbedtls_ssl_session_init(&offered);
+  uint32_t storedHash = 0;
+  const bool haveSession = loadSession(host, ssl, offered, storedHash);
+
+  const int64_t start = esp_timer_get_time();
+  int ret;
+  while ((ret = mbedtls_ssl_handshake(&ssl)) != 0) {
+    if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
+      break;
+    }
+    if ((esp_timer_get_time() - start) / 1000 > timeoutMs) {
+      break;
+    }
+    delay(1);
+  }
+  lastHandshakeMs = (uint32_t)((esp_timer_get_time() - start) / 1000);
+
+  if (ret != 0) {
+    mbedtls_ssl_session_free(&offered);
+    LOG_E("❌ TLS handshake failed: -0x%04x", -ret);
+    return false;
+  }
+
+  lastResumed = false;
+  if (haveSession) {
+    mbedtls_ssl_session current;
+    mbedtls_ssl_session_init(&current);
+    if (mbedtls_ssl_get_session(&ssl, &current) == 0) {
+      lastResumed = memcmp(current.MBEDTLS_PRIVATE(master),
+                           offered.MBEDTLS_PRIVATE(master),
+                           sizeof(current.MBEDTLS_PRIVATE(master))) == 0;
+    }
+    mbedtls_ssl_session_free(&current);
+  }
+  mbedtls_ssl_session_free(&offered);
+
+  LOG_I("🔐 TLS handshake %lu ms (%s)", (unsigned long)lastHandshakeMs,
+        lastResumed ? "resumed" : haveSession ? "full, session refused" : "full");
+  saveSession(host, ssl, haveSession ? storedHash : 0);
+  return true;
+}
+
+void TlsClient::freeTls() {
+  if (!tlsActive) {
+    return;
+  }
+  mbedtls_ssl_free(&ssl);
+  mbedtls_ssl_config_free(&conf);
+  mbedtls_ctr_drbg_free(&drbg);
+  mbedtls_entropy_free(&entropy);
+  tlsActive = false;
+}
+
+size_t TlsClient::write(uint8_t data) { return write(&data, 1); }
+
+size_t TlsClient::write(const uint8_t *buf, size_t size) {
+  if (!tlsActive) {
+    return 0;
+  }
+  size_t sent = 0;
+  const unsigned long start = millis();
+  while (sent < size) {
+    const int ret = mbedtls_ssl_write(&ssl, buf + sent, size - sent);
+    if (ret > 0) {
+      sent += ret;
+    } else if ((ret != MBEDTLS_ERR_SSL_WANT_READ &&
+                ret != MBEDTLS_ERR_SSL_WANT_WRITE) ||
+               millis() - start > (unsigned long)_timeout) {
+      break;
+    } else {
+      delay(1);
+    }
+  }
+  return sent;
+}
+
+int TlsClient::available() {
+  if (!tlsActive) {
+    return peeked >= 0 ? 1 : 0;
+  }
+  // A zero-length read pulls the next record in without consuming it
+  const int ret = mbedtls_ssl_read(&ssl, nullptr, 0);
+  if (ret < 0 && ret != MBEDTLS_ERR_SSL_WANT_READ &&
+      ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
+    return peeked >= 0 ? 1 : 0;
+  }
+  return (int)mbedtls_ssl_get_bytes_avail(&ssl) + (peeked >= 0 ? 1 : 0);
+}
+
+int TlsClient::read() {
+  uint8_t data;
+  return read(&data, 1) == 1 ? data : -1;
+}
+
+int TlsClient::read(uint8_t *buf, size_t size) {
+  if (size == 0) {
+    return 0;
+  }
+  int got = 0;
+  if (peeked >= 0) {
+    buf[got++] = (uint8_t)peeked;
+    peeked = -1;
+    if (size == 1) {
+      return got;
+    }
+  }
+  if (!tlsActive || available() <= 0) {
+    return got > 0 ? got : -1;
+  }
+  const int ret = mbedtls_ssl_read(&ssl, buf + got, size - got);
+  if (ret > 0) {
+    got += ret;
+  }
+  return got > 0 ? got : -1;
+}
+
+int TlsClient::peek() {
+  if (peeked < 0) {
+    uint8_t data;
+    if (tlsActive && available() > 0 &&
+        mbedtls_ssl_read(&ssl, &data, 1) == 1) {
+      peeked = data;
+    }
+  }
+  return peeked;
+}
+
+void TlsClient::flush() {}
+
+void TlsClient::stop() {
+  if (tlsActive && WiFiClient::connected()) {
+    mbedtls_ssl_close_notify(&ssl);
+  }
+  freeTls();
+  peeked = -1;
+  WiFiClient::stop();
+}
+
+uint8_t TlsClient::connected() {
+  return (tlsActive && WiFiClient::connected()) || available() > 0;
+}
@@ -0,0 +1,61 @@
+#ifndef TLS_CLIENT_H
+#define TLS_CLIENT_H
+
+#include <Arduino.h>
+#include <WiFiClient.h>
+#include <mbedtls/ctr_drbg.h>
+#include <mbedtls/entropy.h>
+#include <mbedtls/ssl.h>
+
+// Sessions older than this are not offered; servers rotate ticket keys
+// within about a day anyway
+#ifndef TLS_SESSION_MAX_AGE
+#define TLS_SESSION_MAX_AGE (24L * 3600L)
+#endif
+
+// TLS client (no certificate validation, like WiFiClientSecure with
+// setInsecure()) that resumes sessions. The session of every successful
+// handshake is saved per host on flash, so the first request after a deep
+// sleep can skip the full key exchange when the server accepts it.
+class TlsClient : public WiFiClient {
+public:
+  TlsClient();
+  ~TlsClient() override;
+
+  int connect(IPAddress ip, uint16_t port) override;
+  int connect(IPAddress ip, uint16_t port, int32_t timeout) override;
+  int connect(const char *host, uint16_t port) override;
+  int connect(const char *host, uint16_t port, int32_t timeout) override;
+
+  size_t write(uint8_t data) override;
+  size_t write(const uint8_t *buf, size_t size) override;
+  int available() override;
+  int read() override;
+  int read(uint8_t *buf, size_t size) override;
+  int peek() override;
+  void flush() override;
+  void stop() override;
+  uint8_t connected() override;
+
+  // Last handshake, for comparing full and resumed handshakes
+  uint32_t handshakeMillis() const { return lastHandshakeMs; }
+  bool resumed() const { return lastResumed; }
+
+  // Drops every stored session (e.g. on factory reset)
+  static void forgetSessions();
+
+private:
+  bool startTls(const char *host, int32_t timeoutMs);
+  void freeTls();
+
+  mbedtls_ssl_context ssl;
+  mbedtls_ssl_config conf;
+  mbedtls_ctr_drbg_context drbg;
+  mbedtls_entropy_context entropy;
+  bool tlsActive = false;
+  int peeked = -1; // Byte held back by peek(), -1 if none
+  uint32_t lastHandshakeMs = 0;
+  bool lastResumed = false;
+};
+
+#endif // TLS_CLIENT_H
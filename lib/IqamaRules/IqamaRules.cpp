@@ -0,0 +1,113 @@
+#include "IqamaRules.h"
+
+static const char *const RULE_KEYS[DaySchedule::IQAMA_COUNT] = {
+    "fajr", "dhuhr", "asr", "maghrib", "isha"};
+static const char *const JUMUAH_KEY = "jumuah";
+static const int FRIDAY = 5;
+
+uint16_t IqamaRules::evaluate(const IqamaRule &rule, uint16_t adhanMinutes) {
+  if (adhanMinutes >= DaySchedule::MINUTES_PER_DAY)
+    return DaySchedule::INVALID_MINUTES;
+
+  uint32_t iqama = adhanMinutes;
+  switch (rule.type) {
+  case IQAMA_RULE_FIXED_TIME:
+    // A fixed iqama that falls before the adhan (seasonal drift) is clamped
+    if (rule.value < DaySchedule::MINUTES_PER_DAY && rule.value > adhanMinutes)
+      iqama = rule.value;
+    break;
+  case IQAMA_RULE_ROUND_UP:
+    if (rule.value > 0)
+      iqama = (adhanMinutes / rule.value + 1) * rule.value;
+    break;
+  case IQAMA_RULE_OFFSET:
+  default:
+    iqama = adhanMinutes + rule.value;
+    break;
+  }
+  return (uint16_t)(iqama % DaySchedule::MINUTES_PER_DAY);
+}
+
+void IqamaRules::apply(const IqamaRuleSet &rules, DaySchedule &schedule,
+                       int weekday) {
+  for (uint8_t row = 0; row < DaySchedule::IQAMA_COUNT; ++row) {
+    const IqamaRule &rule =
+        (row == 1 && weekday == FRIDAY) ? rules.jumuah : rules.daily[row];
+    schedule.iqamas[row] = evaluate(rule, schedule.rowPrayer(row));
+  }
+}
+
+bool IqamaRules::isValid(const IqamaRule &rule) {
+  switch (rule.type) {
+  case IQAMA_RULE_FIXED_TIME:
+    return rule.value < DaySchedule::MINUTES_PER_DAY;
+  case IQAMA_RULE_ROUND_UP:
+    return rule.value > 0 && rule.value <= 120;
+  case IQAMA_RULE_OFFSET:
+    return rule.value <= 180;
+  default:
+    return false;
+  }
+}
+
+static bool ruleFromJson(JsonVariantConst json, IqamaRule &rule) {
+  if (json["fixed"].is<const char *>()) {
+    uint16_t minutes = DaySchedule::parseHHMM(json["fixed"].as<const char *>());
+    if (minutes == DaySchedule::INVALID_MINUTES)
+      return false;
+    rule.type = IQAMA_RULE_FIXED_TIME;
+    rule.value = minutes;
+  } else if (json["round"].is<int>()) {
+    int step = json["round"].as<int>();
+    if (step <= 0 || step > 120)
+      return false;
+    rule.type = IQAMA_RULE_ROUND_UP;
+    rule.value = step;
+  } else if (json["offset"].is<int>()) {
+    int offset = json["offset"].as<int>();
+    if (offset < 0 || offset > 180)
+      return false;
+    rule.type = IQAMA_RULE_OFFSET;
+    rule.value = offset;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+static void ruleToJson(const IqamaRule &rule, JsonObject json) {
+  if (rule.type == IQAMA_RULE_FIXED_TIME) {
+    char hhmm[6];
+    DaySchedule::formatHHMM(rule.value, hhmm);
+    json["fixed"] = hhmm; // copied, hhmm is a stack buffer
+  } else if (rule.type == IQAMA_RULE_ROUND_UP) {
+    json["round"] = rule.value;
+  } else {
+    json["offset"] = rule.value;
+  }
+}
+
+bool IqamaRules::fromJson(JsonVariantConst json, IqamaRuleSet &rules) {
+  if (!json.is<JsonObjectConst>())
+    return false;
+
+  IqamaRuleSet parsed = rules;
+  for (uint8_t row = 0; row < DaySchedule::IQAMA_COUNT; ++row) {
+    JsonVariantConst entry = json[RULE_KEYS[row]];
+    if (!entry.isNull() && !ruleFromJson(entry, parsed.daily[row]))
+      return false;
+  }
+  JsonVariantConst jumuah = json[JUMUAH_KEY];
+  if (!jumuah.isNull() && !ruleFromJson(jumuah, parsed.jumuah))
+    return false;
+
+  rules = parsed;
+  return true;
+}
+
+void IqamaRules::toJson(const IqamaRuleSet &rules, JsonObject json) {
+  for (uint8_t row = 0; row < DaySchedule::IQAMA_COUNT; ++row) {
+    ruleToJson(rules.daily[row], json[RULE_KEYS[row]].to<JsonObject>());
+  }
+  ruleToJson(rules.jumuah, json[JUMUAH_KEY].to<JsonObject>());
+}
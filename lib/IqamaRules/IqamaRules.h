@@ -0,0 +1,46 @@
+#ifndef IQAMA_RULES_H
+#define IQAMA_RULES_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <DaySchedule.h>
+
+// How the iqama of one prayer is derived from its adhan time
+enum IqamaRuleType : uint8_t {
+  IQAMA_RULE_OFFSET = 0,     // adhan + value minutes
+  IQAMA_RULE_FIXED_TIME = 1, // value = minutes since midnight (never before adhan)
+  IQAMA_RULE_ROUND_UP = 2,   // adhan rounded up to the next multiple of value
+};
+
+struct IqamaRule {
+  uint8_t type = IQAMA_RULE_OFFSET;
+  uint8_t reserved = 0;
+  uint16_t value = 0;
+};
+
+// One rule per row prayer (Fajr, Dhuhr, Asr, Maghrib, Isha) plus a separate
+// rule used for Dhuhr on Fridays (Jumu'ah). Stored in RTC memory and in
+// /prayer_config.json under "iqama".
+struct IqamaRuleSet {
+  IqamaRule daily[DaySchedule::IQAMA_COUNT];
+  IqamaRule jumuah;
+};
+
+class IqamaRules {
+public:
+  static uint16_t evaluate(const IqamaRule &rule, uint16_t adhanMinutes);
+
+  // Fills schedule.iqamas from schedule.prayers. weekday: 0 = Sunday.
+  static void apply(const IqamaRuleSet &rules, DaySchedule &schedule,
+                    int weekday);
+
+  // JSON form: {"fajr":{"offset":20},"dhuhr":{"round":15},
+  //             "jumuah":{"fixed":"13:30"}, ...}. Missing prayers keep their
+  //             current rule. Returns false on a malformed entry.
+  static bool fromJson(JsonVariantConst json, IqamaRuleSet &rules);
+  // Same limits as fromJson, for rules that arrive in binary form
+  static bool isValid(const IqamaRule &rule);
+  static void toJson(const IqamaRuleSet &rules, JsonObject json);
+};
+
+#endif // IQAMA_RULES_H
@@ -0,0 +1,222 @@
+#include "Logger.h"
+#include <soc/soc_memory_layout.h>
+#include <esp_ota_ops.h>
+#include <time.h>
+
+#define LOG_RING_MAGIC 0x4C4F4752 // "LOGR"
+
+// Records reference format strings in flash by address, so the ring is only
+// meaningful for the firmware image that wrote it (tagged by ELF hash).
+struct LogRing {
+  uint32_t magic;
+  uint32_t firmwareTag;
+  uint16_t head;  // Next slot to write
+  uint16_t count; // Valid records (<= LOG_RING_CAPACITY)
+  uint8_t wakeCycle;
+  LogRecord records[LOG_RING_CAPACITY];
+};
+
+RTC_DATA_ATTR static LogRing logRing;
+
+static const char *const LEVEL_TAGS[] = {"-", "E", "W", "I", "D"};
+static const char *const UNKNOWN_STR = "<str>";
+
+static uint32_t firmwareTag() {
+  static uint32_t tag = 0;
+  if (tag == 0) {
+    const esp_app_desc_t *desc = esp_ota_get_app_description();
+    memcpy(&tag, desc->app_elf_sha256, sizeof(tag));
+    tag |= 1; // Never 0, which means "not computed"
+  }
+  return tag;
+}
+
+static void ensureRing() {
+  if (logRing.magic != LOG_RING_MAGIC ||
+      logRing.firmwareTag != firmwareTag() ||
+      logRing.head >= LOG_RING_CAPACITY ||
+      logRing.count > LOG_RING_CAPACITY) {
+    memset(&logRing, 0, sizeof(logRing));
+    logRing.magic = LOG_RING_MAGIC;
+    logRing.firmwareTag = firmwareTag();
+  }
+}
+
+LogArg LogArg::from(const char *value) {
+  LogArg arg;
+  arg.type = STR;
+  // Only flash-resident strings outlive the call; RAM buffers do not
+  arg.bits = (uint32_t)(uintptr_t)(value && esp_ptr_in_drom(value)
+                                       ? value
+                                       : UNKNOWN_STR);
+  return arg;
+}
+
+void Logger::record(uint8_t level, const char *fmt, const LogArg *args,
+                    uint8_t argc) {
+  ensureRing();
+  LogRecord &rec = logRing.records[logRing.head];
+  const time_t now = time(nullptr);
+  rec.epoch = now > 100000 ? (uint32_t)now : 0;
+  rec.fmt = fmt;
+  rec.level = level;
+  rec.argc = argc > 4 ? 4 : argc;
+  rec.types = 0;
+  rec.wakeCycle = logRing.wakeCycle;
+  for (uint8_t i = 0; i < rec.argc; ++i) {
+    rec.types |= (args[i].type & 0x3) << (i * 2);
+    rec.args[i] = args[i].bits;
+  }
+
+  logRing.head = (logRing.head + 1) % LOG_RING_CAPACITY;
+  if (logRing.count < LOG_RING_CAPACITY) {
+    logRing.count++;
+  }
+}
+
+// Formats one conversion with the stored argument, converting between
+// numeric kinds if the record type does not match the specifier
+static int formatArg(char *out, size_t size, const char *spec, char conv,
+                     uint8_t type, uint32_t bits) {
+  float f;
+  memcpy(&f, &bits, sizeof(f));
+  switch (conv) {
+  case 'd':
+  case 'i':
+  case 'c':
+    return snprintf(out, size, spec,
+                    type == LogArg::FLOAT ? (int)f : (int)bits);
+  case 'u':
+  case 'x':
+  case 'X':
+  case 'o':
+    return snprintf(out, size, spec,
+                    type == LogArg::FLOAT ? (unsigned)f : (unsigned)bits);
+  case 'f':
+  case 'F':
+  case 'e':
+  case 'E':
+  case 'g':
+  case 'G':
+    return snprintf(out, size, spec,
+                    type == LogArg::FLOAT ? (double)f
+                    : type == LogArg::INT ? (double)(int32_t)bits
+                                          : (double)bits);
+  case 's':
+    return snprintf(out, size, spec,
+                    type == LogArg::STR ? (const char *)(uintptr_t)bits
+                                        : UNKNOWN_STR);
+  case 'p':
+    return snprintf(out, size, spec, (void *)(uintptr_t)bits);
+  default:
+    return 0;
+  }
+}
+
+size_t Logger::format(const LogRecord &rec, char *out, size_t outSize) {
+  if (outSize == 0) {
+    return 0;
+  }
+  size_t pos = 0;
+  if (rec.epoch != 0) {
+    time_t t = rec.epoch;
+    struct tm local;
+    localtime_r(&t, &local);
+    pos += snprintf(out, outSize, "[%02d:%02d:%02d #%u %s] ", local.tm_hour,
+                    local.tm_min, local.tm_sec, rec.wakeCycle,
+                    LEVEL_TAGS[rec.level <= LOG_LEVEL_DEBUG ? rec.level : 0]);
+  } else {
+    pos += snprintf(out, outSize, "[--:--:-- #%u %s] ", rec.wakeCycle,
+                    LEVEL_TAGS[rec.level <= LOG_LEVEL_DEBUG ? rec.level : 0]);
+  }
+
+  const char *p = rec.fmt ? rec.fmt : "";
+  uint8_t argIndex = 0;
+  while (*p && pos + 1 < outSize) {
+    if (*p != '%') {
+      out[pos++] = *p++;
+      continue;
+    }
+    if (p[1] == '%') {
+      out[pos++] = '%';
+      p += 2;
+      continue;
+    }
+
+    // Copy flags/width/precision, drop length modifiers (args are 32-bit)
+    char spec[16];
+    size_t specLen = 0;
+    spec[specLen++] = *p++;
+    while (*p && strchr("-+ #0123456789.", *p) && specLen < sizeof(spec) - 2) {
+      spec[specLen++] = *p++;
+    }
+    while (*p && strchr("hlzjt", *p)) {
+      p++;
+    }
+    const char conv = *p ? *p++ : 's';
+    spec[specLen++] = conv;
+    spec[specLen] = '\0';
+
+    if (argIndex >= rec.argc) {
+      continue; // More specifiers than captured arguments
+    }
+    const uint8_t type = (rec.types >> (argIndex * 2)) & 0x3;
+    int written = formatArg(out + pos, outSize - pos, spec, conv, type,
+                            rec.args[argIndex]);
+    argIndex++;
+    if (written > 0) {
+      pos += (size_t)written;
+    }
+  }
+  if (pos >= outSize) {
+    pos = outSize - 1;
+  }
+  out[pos] = '\0';
+  return pos;
+}
+
+uint16_t Logger::count() {
+  ensureRing();
+  return logRing.count;
+}
+
+bool Logger::get(uint16_t index, LogRecord &rec) {
+  ensureRing();
+  if (index >= logRing.count) {
+    return false;
+  }
+  const uint16_t oldest =
+      (logRing.head + LOG_RING_CAPACITY - logRing.count) % LOG_RING_CAPACITY;
+  rec = logRing.records[(oldest + index) % LOG_RING_CAPACITY];
+  return true;
+}
+
+void Logger::dump(Print &out) {
+  const uint16_t total = count();
+  out.printf("📜 %u log records\n", total);
+  char line[160];
+  LogRecord rec;
+  for (uint16_t i = 0; i < total; ++i) {
+    if (get(i, rec)) {
+      format(rec, line, sizeof(line));
+      out.println(line);
+    }
+  }
+}
+
+void Logger::clear() {
+  ensureRing();
+  logRing.head = 0;
+  logRing.count = 0;
+}
+
+void Logger::flush() {
+#if LOG_SINK == LOG_SINK_SERIAL
+  Serial.flush();
+#endif
+}
+
+void Logger::setWakeCycle(uint32_t cycle) {
+  ensureRing();
+  logRing.wakeCycle = (uint8_t)cycle;
+}
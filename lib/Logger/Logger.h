@@ -0,0 +1,141 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <Arduino.h>
+#include <type_traits>
+
+// Compile-time log levels. Anything above LOG_LEVEL expands to nothing, so
+// the format strings and arguments are not even evaluated. Override with
+// e.g. -DLOG_LEVEL=LOG_LEVEL_WARN in platformio.ini build_flags.
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+// Where enabled records go:
+//  - LOG_SINK_SERIAL: formatted and printed immediately (development)
+//  - LOG_SINK_RING:   stored as compact binary records in RTC memory and only
+//                     formatted when dumped (button wake, BLE), so the wake
+//                     path never waits on the UART
+#define LOG_SINK_SERIAL 0
+#define LOG_SINK_RING 1
+
+#ifndef LOG_SINK
+#define LOG_SINK LOG_SINK_SERIAL
+#endif
+
+#ifndef LOG_RING_CAPACITY
+#define LOG_RING_CAPACITY 64
+#endif
+
+// Format strings must not end with "\n", the sink adds the line break.
+// In ring mode each record keeps up to 4 arguments; strings are kept only
+// when they point to flash (literals), anything else is shown as "<str>".
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_E(fmt, ...) Logger::log(LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
+#else
+#define LOG_E(fmt, ...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_W(fmt, ...) Logger::log(LOG_LEVEL_WARN, fmt, ##__VA_ARGS__)
+#else
+#define LOG_W(fmt, ...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_I(fmt, ...) Logger::log(LOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#else
+#define LOG_I(fmt, ...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_D(fmt, ...) Logger::log(LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+#else
+#define LOG_D(fmt, ...) do {} while (0)
+#endif
+
+// One deferred argument, 32 bits wide (ints, floats, flash string pointers)
+struct LogArg {
+  enum Type : uint8_t { INT = 0, UINT = 1, FLOAT = 2, STR = 3 };
+  uint8_t type = INT;
+  uint32_t bits = 0;
+
+  template <typename T>
+  static typename std::enable_if<std::is_integral<T>::value ||
+                                     std::is_enum<T>::value,
+                                 LogArg>::type
+  from(T value) {
+    LogArg arg;
+    arg.type = std::is_signed<T>::value ? INT : UINT;
+    arg.bits = (uint32_t)value;
+    return arg;
+  }
+  static LogArg from(double value) {
+    LogArg arg;
+    arg.type = FLOAT;
+    float f = (float)value;
+    memcpy(&arg.bits, &f, sizeof(f));
+    return arg;
+  }
+  static LogArg from(const char *value);
+  static LogArg from(const void *value) {
+    return from((uint32_t)(uintptr_t)value);
+  }
+};
+
+// Binary record as stored in the RTC ring (28 bytes)
+struct LogRecord {
+  uint32_t epoch;    // time(nullptr) when logged, 0 if the RTC was unset
+  const char *fmt;   // Format string literal (flash, stable across sleep)
+  uint8_t level;
+  uint8_t argc;
+  uint8_t types;     // 2 bits per argument (LogArg::Type)
+  uint8_t wakeCycle; // Low byte of the wake counter, groups records per wake
+  uint32_t args[4];
+};
+
+class Logger {
+public:
+  template <typename... Args>
+  static void log(uint8_t level, const char *fmt, Args... args) {
+    static_assert(sizeof...(Args) <= 4,
+                  "log records hold at most 4 arguments");
+#if LOG_SINK == LOG_SINK_RING
+    const LogArg packed[sizeof...(Args) + 1] = {LogArg::from(args)...,
+                                                 LogArg()};
+    record(level, fmt, packed, sizeof...(Args));
+#else
+    (void)level;
+    Serial.printf(fmt, args...);
+    Serial.write('\n');
+#endif
+  }
+
+  // Stores one binary record (ring sink)
+  static void record(uint8_t level, const char *fmt, const LogArg *args,
+                     uint8_t argc);
+
+  // Formats a record into out (always NUL-terminated); returns its length
+  static size_t format(const LogRecord &rec, char *out, size_t outSize);
+
+  // Number of records held, oldest first for index 0
+  static uint16_t count();
+  static bool get(uint16_t index, LogRecord &rec);
+
+  // Formats every stored record to out, oldest first
+  static void dump(Print &out);
+  static void clear();
+
+  // Before deep sleep: drains the UART in serial mode, no-op for the ring
+  static void flush();
+
+  static void setWakeCycle(uint32_t cycle);
+};
+
+#endif // LOGGER_H
@@ -3,12 +3,18 @@
 #include <ArduinoJson.h>
 #include <FS.h>
 #include <HTTPClient.h>
-#include <SPIFFS.h>
-#include <WiFiClientSecure.h>
+#include <HttpCache.h>
+#include <HttpsSession.h>
+#include <SPIFFSHelper.h>
 
 #define TEMP_JSON_PATH "/temp.json"
 #define MAX_RETRIES 3
 
+// Test builds point this at tools/http_cache_mock.py
+#ifndef MAWAQIT_API_URL
+#define MAWAQIT_API_URL "https://mawaqit.net"
+#endif
+
 // Define a larger JSON document size
 const size_t JSON_DOC_SIZE = 48 * 1024; // 48 KB, increased from a smaller value
 
@@ -42,32 +48,47 @@ void MAWAQITManager::fetchTask(void *parameter) {
     vTaskDelete(nullptr);
     return;
   }
-  String url = "https://mawaqit.net/api/3.0/mosque/" + params->mosqueUUID +
+  String url = MAWAQIT_API_URL "/api/3.0/mosque/" + params->mosqueUUID +
                "/times?calendar";
   Serial.printf("🌐 Fetching from: %s\n", url.c_str());
-  WiFiClientSecure client;
-  client.setInsecure();
-  client.setTimeout(10000);
-  HTTPClient https;
-  if (!https.begin(client, url)) {
+  HttpsSession::Lease lease(url);
+  HTTPClient &https = lease.http();
+  if (!lease.ok() || !https.begin(lease.client(), url)) {
     Serial.println("❌ HTTPS.begin() failed");
   } else {
     https.addHeader("Api-Access-Token", MAWAQITManager::getInstance().apiKey);
     https.setTimeout(20000); // 20 seconds for large files
+    const bool haveCopy = fileExists(MOSQUE_FILE);
+    HttpCache::prepare(https, url, haveCopy);
     int httpCode = https.GET();
-    if (httpCode != HTTP_CODE_OK) {
+    if (httpCode == HTTP_CODE_NOT_MODIFIED) {
+      Serial.println("✅ Mosque calendar unchanged (304)");
+      success = true;
+    } else if (httpCode != HTTP_CODE_OK) {
       Serial.printf("❌ HTTP GET failed: %d\n", httpCode);
     } else {
+      const HttpCache::Validators validators = HttpCache::validators(https);
       // Open file for writing
-      File file = SPIFFS.open(MOSQUE_FILE, FILE_WRITE);
+      File file = beginAtomicWrite(MOSQUE_FILE);
       if (!file) {
         Serial.println("❌ Failed to open file for writing");
       } else {
-        // Use writeToStream which handles chunked encoding properly
-        int totalBytes = https.writeToStream(&file);
-        file.close();
+        // Use writeToStream which handles chunked encoding properly; the
+        // body is hashed on the way to flash
+        HashingStream sink(file);
+        int totalBytes = https.writeToStream(&sink);
+        const bool unchanged =
+            haveCopy && HttpCache::sameBody(url, sink.value());
+        // Same calendar as before: keep the current file, drop the copy
+        commitAtomicWrite(file, MOSQUE_FILE, totalBytes > 1000 && !unchanged);
+        if (totalBytes > 1000 && !unchanged) {
+          HttpCache::store(url, validators, sink.value());
+        }
 
-        if (totalBytes > 0) {
+        if (unchanged) {
+          Serial.println("✅ Mosque calendar unchanged (same hash)");
+          success = true;
+        } else if (totalBytes > 0) {
           Serial.printf("📦 Downloaded %d bytes\n", totalBytes);
           Serial.printf("✅ Saved %d bytes\n", totalBytes);
           success = (totalBytes > 1000);
@@ -118,17 +139,14 @@ void MAWAQITManager::fetchInfoTask(void *parameter) {
   }
 
   // API endpoint
-  String url = "https://mawaqit.net/api/3.0/mosque/" + params->mosqueUUID +
+  String url = MAWAQIT_API_URL "/api/3.0/mosque/" + params->mosqueUUID +
                "/info?calendar";
   Serial.printf("🌐 Fetching mosque info from: %s\n", url.c_str());
 
-  WiFiClientSecure client;
-  client.setInsecure(); // Disable certificate check
-  // client.setBufferSizes(512, 512);    // Reduce RAM usage
-  client.setTimeout(10000); // 10s timeout
-
-  HTTPClient https;
-  if (!https.begin(client, url)) {
+  // Shared client: the times request that follows reuses this connection
+  HttpsSession::Lease lease(url);
+  HTTPClient &https = lease.http();
+  if (!lease.ok() || !https.begin(lease.client(), url)) {
     Serial.println("❌ HTTPS.begin() failed for mosque info");
   } else {
     https.addHeader("Api-Access-Token", MAWAQITManager::getInstance().apiKey);
@@ -142,7 +160,7 @@ void MAWAQITManager::fetchInfoTask(void *parameter) {
       Serial.printf("📦 Received mosque info: %d bytes\n", payload.length());
 
       // Save to SPIFFS
-      File file = SPIFFS.open("/mosque_info.json", FILE_WRITE);
+      File file = APP_FS.open("/mosque_info.json", FILE_WRITE);
       if (file) {
         file.print(payload);
         file.close();
@@ -169,7 +187,6 @@ void MAWAQITManager::fetchInfoTask(void *parameter) {
     }
 
     https.end();
-    client.stop();
   }
 
   // Return mosque name (instead of file path) via callback
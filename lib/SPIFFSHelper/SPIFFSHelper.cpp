@@ -1,19 +1,73 @@
 #include "SPIFFSHelper.h"
-#include <ArduinoJson.h>
+#include <AppState.h>
+#include <Logger.h>
+#ifdef FS_BACKEND_LITTLEFS
+#include <SPIFFS.h>
+#endif
 
 #define MAIN_JSON_FILE "/calendar.json"
 
+#ifdef FS_BACKEND_LITTLEFS
+// Settings worth carrying over from a SPIFFS image of an older firmware;
+// calendars, events and caches are simply downloaded again
+static const char *const MIGRATED_FILES[] = {
+    WIFI_CRED_FILE, PRAYER_CONFIG_FILE, "/mosque_config.json"};
+static const size_t MIGRATED_COUNT =
+    sizeof(MIGRATED_FILES) / sizeof(MIGRATED_FILES[0]);
+static const size_t MIGRATED_FILE_MAX = 4096;
+
+// The partition did not mount as LittleFS. If it still holds SPIFFS, keep
+// the settings in RAM, format, and write them back, so an update does not
+// send the device back to BLE setup.
+static bool formatKeepingSpiffsSettings() {
+  String saved[MIGRATED_COUNT];
+  const bool fromSpiffs = SPIFFS.begin(false);
+  if (fromSpiffs) {
+    for (size_t i = 0; i < MIGRATED_COUNT; i++) {
+      File file = SPIFFS.open(MIGRATED_FILES[i], FILE_READ);
+      if (!file || file.size() > MIGRATED_FILE_MAX) {
+        continue;
+      }
+      char buffer[256];
+      size_t bytesRead;
+      saved[i].reserve(file.size());
+      while ((bytesRead = file.read((uint8_t *)buffer, sizeof(buffer))) > 0) {
+        saved[i].concat(buffer, bytesRead);
+      }
+      file.close();
+    }
+    SPIFFS.end();
+    LOG_W("⚠️ SPIFFS image found, converting to LittleFS");
+  }
+
+  if (!APP_FS.begin(true)) {
+    return false;
+  }
+  for (size_t i = 0; i < MIGRATED_COUNT; i++) {
+    if (saved[i].length() > 0) {
+      writeJsonFile(MIGRATED_FILES[i], saved[i]);
+    }
+  }
+  return true;
+}
+#endif
+
 bool setupSPIFFS() {
-  if (!SPIFFS.begin(true)) { // "true" will format SPIFFS if it fails
-    Serial.println("⚠️ SPIFFS initialization failed!");
+#ifdef FS_BACKEND_LITTLEFS
+  const bool mounted = APP_FS.begin(false) || formatKeepingSpiffsSettings();
+#else
+  const bool mounted = APP_FS.begin(true); // Formats the partition if needed
+#endif
+  if (!mounted) {
+    LOG_E("❌ Filesystem initialization failed!");
     return false;
   }
-  Serial.println("✅ SPIFFS initialized successfully.");
+  LOG_D("✅ Filesystem mounted");
   return true;
 }
 void deleteFile(const char *path) {
-  if (SPIFFS.exists(path)) {
-    if (SPIFFS.remove(path)) {
+  if (APP_FS.exists(path)) {
+    if (APP_FS.remove(path)) {
       Serial.printf("🗑️ Deleted file: %s\n", path);
     } else {
       Serial.printf("❌ Failed to delete file: %s\n", path);
@@ -23,113 +77,397 @@ void deleteFile(const char *path) {
   }
 }
 
-String readJsonFile(const String &jsonPath) {
-  Serial.println("📂 Reading large JSON file from SPIFFS...");
+// Writes go to "<path>.tmp". LittleFS then renames it over the old file.
+// SPIFFS cannot rename over an existing file, so there the complete temp
+// first becomes "<path>.new" and the old file is dropped: a reset at any
+// point leaves either the old file or a complete ".new" to recover.
+static String tempPath(const String &path) { return path + ".tmp"; }
+static String readyPath(const String &path) { return path + ".new"; }
+
+bool fileExists(const String &path) {
+  if (APP_FS.exists(path)) {
+    return true;
+  }
+  const String ready = readyPath(path);
+  if (APP_FS.exists(ready) && APP_FS.rename(ready, path)) {
+    LOG_W("⚠️ Recovered interrupted write of %s", path.c_str());
+    return true;
+  }
+  return false;
+}
+
+File openFileForRead(const String &path) {
+  fileExists(path);
+  return APP_FS.open(path, FILE_READ);
+}
+
+File beginAtomicWrite(const String &path) {
+  return APP_FS.open(tempPath(path), FILE_WRITE);
+}
 
-  File file = SPIFFS.open(jsonPath, "r");
+File openPendingWrite(const String &path, const char *mode) {
+  return APP_FS.open(tempPath(path), mode);
+}
+
+size_t pendingAtomicWriteSize(const String &path) {
+  const String tmp = tempPath(path);
+  if (!APP_FS.exists(tmp)) {
+    return 0;
+  }
+  File file = APP_FS.open(tmp, FILE_READ);
   if (!file) {
-    Serial.println("❌ Failed to open file!");
-    return "{}"; // Return an empty JSON object in case of error
+    return 0;
   }
+  size_t size = file.size();
+  file.close();
+  return size;
+}
 
-  String jsonData = "";
-  const size_t bufferSize = 2048; // Size of each chunk
-  char buffer[bufferSize];
+bool commitAtomicWrite(File &file, const String &path, bool complete) {
+  const String tmp = tempPath(path);
+  file.close();
+  if (!complete) {
+    APP_FS.remove(tmp);
+    return false;
+  }
+#ifdef FS_BACKEND_LITTLEFS
+  // LittleFS replaces the destination in one metadata commit
+  if (APP_FS.rename(tmp, path)) {
+    return true;
+  }
+#else
+  const String ready = readyPath(path);
+  if (APP_FS.exists(ready)) {
+    APP_FS.remove(ready); // Stale from an older interrupted write
+  }
+  if (APP_FS.rename(tmp, ready) &&
+      (!APP_FS.exists(path) || APP_FS.remove(path)) &&
+      APP_FS.rename(ready, path)) {
+    return true;
+  }
+#endif
+  LOG_E("❌ Failed to replace %s", path.c_str());
+  return false;
+}
 
-  // Read the file in chunks
-  while (file.available()) {
-    size_t bytesRead = file.readBytes(buffer, bufferSize);
-    jsonData +=
-        String(buffer).substring(0, bytesRead); // Append the chunk to jsonData
+bool readJsonFile(const String &jsonPath, JsonDocument &doc) {
+  File file = openFileForRead(jsonPath);
+  if (!file) {
+    LOG_W("⚠️ Failed to open %s", jsonPath.c_str());
+    return false;
   }
+  // Parse straight from the file stream: no intermediate copy of the text
+  DeserializationError error = deserializeJson(doc, file);
+  file.close();
+  if (error) {
+    LOG_E("❌ JSON parse failed: %s", error.c_str());
+    return false;
+  }
+  return true;
+}
 
+String readJsonFile(const String &jsonPath) {
+  File file = openFileForRead(jsonPath);
+  if (!file) {
+    LOG_E("❌ Failed to open file!");
+    return "{}"; // Return an empty JSON object in case of error
+  }
+
+  // One allocation sized to the file (malloc moves large blocks to PSRAM),
+  // filled in chunks without temporaries
+  const size_t fileSize = file.size();
+  String jsonData;
+  if (!jsonData.reserve(fileSize)) {
+    LOG_E("❌ Out of memory for %u bytes", (unsigned)fileSize);
+    file.close();
+    return "{}";
+  }
+
+  char buffer[512];
+  size_t bytesRead;
+  while ((bytesRead = file.read((uint8_t *)buffer, sizeof(buffer))) > 0) {
+    jsonData.concat(buffer, bytesRead);
+  }
   file.close();
 
-  Serial.printf("✅ Read %d bytes from file.\n", jsonData.length());
+  LOG_D("✅ Read %u bytes from %s", jsonData.length(), jsonPath.c_str());
   return jsonData;
 }
 
 bool writeJsonFile(const String &filename, const String &jsonData) {
   Serial.printf("\r💾 Writing JSON to: %s", filename.c_str());
 
-  File file = SPIFFS.open(filename, "w");
+  File file = beginAtomicWrite(filename);
   if (!file) {
     Serial.printf("\r❌ Failed to open file for writing: %s\n",
                   filename.c_str());
     return false;
   }
 
-  file.print(jsonData);
-  file.close();
+  const bool complete = file.print(jsonData) == jsonData.length();
+  if (!commitAtomicWrite(file, filename, complete)) {
+    Serial.printf("\r❌ Failed to write: %s\n", filename.c_str());
+    return false;
+  }
 
   Serial.printf("\r✅ JSON saved successfully: %s\n", filename.c_str());
   return true;
 }
 
-bool splitCalendarJson(const String &rawJsonPath, const bool &isIqama) {
-  Serial.println("📂 Loading main JSON file...");
-  File file = SPIFFS.open(rawJsonPath, "r");
-  if (!file) {
-    Serial.println("❌ Failed to open file!");
-    return false;
-  }
+// Minimal pull tokenizer over a File: one small read buffer, no DOM. Only
+// what the MAWAQIT splitter needs (objects, arrays, short strings, skipping).
+class JsonStreamScanner {
+public:
+  explicit JsonStreamScanner(File &file) : file_(file) {}
 
-  size_t fileSize = file.size();
-  Serial.printf("📦 File size: %d bytes\n", fileSize);
+  int next() {
+    if (pos_ == len_) {
+      len_ = file_.read(buf_, sizeof(buf_));
+      pos_ = 0;
+      if (len_ == 0) {
+        return -1;
+      }
+    }
+    return buf_[pos_++];
+  }
 
-  // Debug: Read first 100 characters to check file content
-  char preview[101];
-  size_t previewLen = file.readBytes(preview, min((size_t)100, fileSize));
-  preview[previewLen] = '\0';
-  Serial.printf("📄 First %d chars: %s\n", previewLen, preview);
-  file.seek(0); // Reset file pointer to beginning
+  // Next non-whitespace character
+  int nextToken() {
+    int c;
+    do {
+      c = next();
+    } while (c == ' ' || c == '\n' || c == '\r' || c == '\t');
+    return c;
+  }
 
-  // Use a fixed-size JsonDocument with memory from PSRAM if available
-  // Allocate 50KB for the document
-  JsonDocument doc;
+  // Reads the rest of a string whose opening quote was consumed; longer
+  // strings are truncated but still consumed entirely
+  bool readString(char *out, size_t outSize) {
+    size_t n = 0;
+    for (;;) {
+      int c = next();
+      if (c < 0) {
+        return false;
+      }
+      if (c == '"') {
+        break;
+      }
+      if (c == '\\') {
+        c = next();
+        if (c < 0) {
+          return false;
+        }
+        if (c == 'u') { // Not needed for keys/times; keep a placeholder
+          for (int i = 0; i < 4; ++i)
+            next();
+          c = '?';
+        } else if (c == 'n') {
+          c = '\n';
+        } else if (c == 't') {
+          c = '\t';
+        }
+      }
+      if (n + 1 < outSize) {
+        out[n++] = (char)c;
+      }
+    }
+    out[n] = '\0';
+    return true;
+  }
 
-  DeserializationError error = deserializeJson(doc, file);
-  file.close();
+  // Skips one value whose first character 'c' was already consumed
+  bool skipValue(int c) {
+    int depth = 0;
+    for (;;) {
+      if (c < 0) {
+        return false;
+      }
+      if (c == '"') {
+        for (c = next(); c != '"'; c = next()) {
+          if (c < 0) {
+            return false;
+          }
+          if (c == '\\') {
+            next();
+          }
+        }
+      } else if (c == '{' || c == '[') {
+        depth++;
+      } else if (c == '}' || c == ']') {
+        depth--;
+      }
+      if (depth == 0) {
+        // Scalars (numbers, true, null) end before the next separator
+        if (c != '"' && c != '}' && c != ']') {
+          while ((c = peek()) >= 0 && c != ',' && c != '}' && c != ']' &&
+                 c != ' ' && c != '\n' && c != '\r' && c != '\t') {
+            next();
+          }
+        }
+        return true;
+      }
+      c = next();
+    }
+  }
 
-  if (error) {
-    Serial.print("❌ JSON parsing failed: ");
-    Serial.println(error.f_str());
-    Serial.printf("⚠️ Error code: %d\n", error.code());
-    return false;
+private:
+  int peek() {
+    int c = next();
+    if (c >= 0) {
+      pos_--;
+    }
+    return c;
   }
-  String mainKey = isIqama ? "iqamaCalendar" : "calendar";
-  String jsonKey = isIqama ? "iqamaCalendar" : "prayerCalender";
-  String fileName = isIqama ? "/iqama_times_month_" : "/prayer_times_month_";
-  if (doc.containsKey(mainKey)) {
-    Serial.println(mainKey + " found!");
-  } else {
-    Serial.println("⚠️" + mainKey + " key not found!");
+
+  File &file_;
+  uint8_t buf_[256];
+  size_t pos_ = 0;
+  size_t len_ = 0;
+};
+
+// Copies one month object { "1": ["06:51", ...], ... } to a compact month
+// file, day by day, in the layout CalendarManager reads
+static bool writeMonth(JsonStreamScanner &in, const String &filename,
+                       int month, const char *calendarKey) {
+  File out = beginAtomicWrite(filename);
+  if (!out) {
+    LOG_E("❌ Failed to open file for writing: %s", filename.c_str());
     return false;
   }
+  out.printf("{\"month\":%d,\"%s\":{", month, calendarKey);
 
-  JsonArray calendar = doc[mainKey].as<JsonArray>();
+  char day[8];
+  char value[16];
+  bool firstDay = true;
+  bool ok = false;
+  for (;;) {
+    int c = in.nextToken();
+    if (c == '}') {
+      ok = true;
+      break;
+    }
+    if (c == ',') {
+      continue;
+    }
+    if (c != '"' || !in.readString(day, sizeof(day)) || in.nextToken() != ':') {
+      break;
+    }
+    c = in.nextToken();
+    if (c != '[') {
+      if (!in.skipValue(c)) {
+        break;
+      }
+      continue;
+    }
 
-  for (int month = 0; month < calendar.size(); month++) {
-    if (calendar[month].is<JsonObject>()) {
-      DynamicJsonDocument monthDoc(2048);
-      monthDoc["month"] = month + 1;
-      monthDoc[jsonKey] = calendar[month];
-      String monthJson;
-      serializeJson(monthDoc, monthJson);
+    out.printf(firstDay ? "\"%s\":[" : ",\"%s\":[", day);
+    firstDay = false;
+    bool firstValue = true;
+    while ((c = in.nextToken()) != ']') {
+      if (c == ',') {
+        continue;
+      }
+      if (c != '"' || !in.readString(value, sizeof(value))) {
+        c = -1;
+        break;
+      }
+      out.printf(firstValue ? "\"%s\"" : ",\"%s\"", value);
+      firstValue = false;
+    }
+    if (c < 0) {
+      break;
+    }
+    out.print(']');
+  }
+  out.print("}}");
+  return commitAtomicWrite(out, filename, ok);
+}
 
-      String filename = fileName + String(month + 1) + ".json";
-      if (writeJsonFile(filename, monthJson)) {
-        Serial.printf("\r✅ Saved: %s", filename.c_str());
-      } else {
-        Serial.printf("\r❌ Failed to save: %s",
-                      filename.c_str()); // Also same line
-        return false;
+// Splits one calendar array (12 month objects) into per-month files
+static int splitMonths(JsonStreamScanner &in, const char *filePrefix,
+                       const char *calendarKey) {
+  if (in.nextToken() != '[') {
+    return -1;
+  }
+  int month = 0;
+  int written = 0;
+  for (;;) {
+    int c = in.nextToken();
+    if (c == ']') {
+      return written;
+    }
+    if (c == ',') {
+      continue;
+    }
+    month++;
+    if (c != '{') {
+      LOG_W("⚠️ Month %d not found or invalid!", month);
+      if (!in.skipValue(c)) {
+        return -1;
       }
+      continue;
+    }
+    String filename = String(filePrefix) + String(month) + ".json";
+    if (!writeMonth(in, filename, month, calendarKey)) {
+      LOG_E("❌ Failed to save: %s", filename.c_str());
+      return -1;
+    }
+    written++;
+  }
+}
+
+bool splitCalendarJson(const String &rawJsonPath) {
+  File file = openFileForRead(rawJsonPath);
+  if (!file) {
+    LOG_E("❌ Failed to open file!");
+    return false;
+  }
+  LOG_I("📂 Splitting %u bytes of MAWAQIT JSON", (unsigned)file.size());
+
+  // One pass over the document: both calendars are copied as they stream
+  // past, every other member is skipped without being stored
+  JsonStreamScanner in(file);
+  int prayerMonths = -1;
+  bool ok = in.nextToken() == '{';
+  char key[24];
+  while (ok) {
+    int c = in.nextToken();
+    if (c == '}') {
+      break;
+    }
+    if (c == ',') {
+      continue;
+    }
+    if (c != '"' || !in.readString(key, sizeof(key)) || in.nextToken() != ':') {
+      ok = false;
+      break;
+    }
+    // iqamaCalendar is skipped: iqamas come from the configured rules
+    if (strcmp(key, "calendar") == 0) {
+      prayerMonths =
+          splitMonths(in, PRAYER_TIME_FILE_NAME, "prayerCalender");
+      ok = prayerMonths >= 0;
     } else {
-      Serial.printf("\r⚠️ Month %d not found or invalid!", month + 1);
+      ok = in.skipValue(in.nextToken());
     }
   }
-  Serial.println();
+  file.close();
 
+  if (!ok) {
+    LOG_E("❌ JSON parsing failed");
+    return false;
+  }
+  if (prayerMonths <= 0) {
+    LOG_W("⚠️ calendar key not found!");
+    return false;
+  }
+  // Iqama month files from older firmware are no longer read
+  for (int month = 1; month <= 12; month++) {
+    const String iqamaPath = IQAMA_TIME_FILE_NAME + String(month) + ".json";
+    if (APP_FS.exists(iqamaPath)) {
+      APP_FS.remove(iqamaPath);
+    }
+  }
+  LOG_I("✅ Saved %d prayer months", prayerMonths);
   return true;
-}
\ No newline at end of file
+}
@@ -2,12 +2,45 @@
 #define SPIFFS_HELPER_H
 
 #include <Arduino.h>
+#include <ArduinoJson.h>
 #include <FS.h>
-#include <SPIFFS.h> // Use LittleFS if configured
 
+// Filesystem backend, chosen at build time. Build with -DFS_BACKEND_LITTLEFS
+// (and board_build.filesystem = littlefs) for LittleFS, SPIFFS otherwise.
+#ifdef FS_BACKEND_LITTLEFS
+#include <LittleFS.h>
+#define APP_FS LittleFS
+#else
+#include <SPIFFS.h>
+#define APP_FS SPIFFS
+#endif
+
+// Mounts APP_FS, on every boot and wake. With LittleFS, a partition still
+// holding an older firmware's SPIFFS image keeps its settings files.
 bool setupSPIFFS();
+// exists() that first finishes a replace cut short by a reset
+bool fileExists(const String &path);
+// Opens a file for reading, recovering it like fileExists()
+File openFileForRead(const String &path);
+// Atomic replace: write to the File from beginAtomicWrite(), then
+// commitAtomicWrite() swaps it in. Until then, and whenever 'complete' is
+// false, the previous file stays intact.
+File beginAtomicWrite(const String &path);
+// Opens the temp file of an unfinished atomic write: FILE_APPEND continues
+// it (e.g. an upload resumed after a disconnect), FILE_READ checks it
+// before the commit
+File openPendingWrite(const String &path, const char *mode);
+// Bytes already written to an unfinished atomic write, 0 if none
+size_t pendingAtomicWriteSize(const String &path);
+bool commitAtomicWrite(File &file, const String &path, bool complete = true);
+// Deserialises a file straight from its stream; false if missing or invalid
+bool readJsonFile(const String &jsonPath, JsonDocument &doc);
+// Whole file as text in one pre-sized buffer ("{}" if it cannot be read)
 String readJsonFile(const String &jsonPath);
 bool writeJsonFile(const String &filename, const String &jsonData);
-bool splitCalendarJson(const String &rawJsonPath, const bool &isIqama = false);
+// Streams a MAWAQIT mosque document into per-month prayer files in a single
+// pass, without building a DOM. Its iqama calendar is not kept: iqamas are
+// derived from the configured rules.
+bool splitCalendarJson(const String &rawJsonPath);
 void deleteFile(const char *path);
 #endif
\ No newline at end of file
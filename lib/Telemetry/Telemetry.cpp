@@ -0,0 +1,123 @@
+#include "Telemetry.h"
+#include "AppStateManager.h"
+#include <FetchBackoff.h>
+#include <Logger.h>
+#include <WakeProfiler.h>
+#include <WiFiManager.h>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+
+static_assert(TelemetryRecord::PHASES == WAKE_PHASE_COUNT,
+              "TelemetryRecord::PHASES out of step with WakePhase");
+static_assert(TelemetryRecord::PATHS == WAKE_PATH_COUNT,
+              "TelemetryRecord::PATHS out of step with WakePath");
+static_assert(TelemetryRecord::SOURCES == FETCH_SOURCE_COUNT,
+              "TelemetryRecord::SOURCES out of step with FetchSource");
+
+struct Counters {
+  uint32_t sleepSeconds = 0;
+  uint32_t fullRefreshes = 0;
+  uint32_t partialRefreshes = 0;
+  uint32_t wifiSessions = 0;
+  uint32_t wifiMillis = 0;
+  uint32_t wifiLongestMillis = 0;
+  uint32_t minFreeHeap = UINT32_MAX;
+  uint32_t minStackFree = UINT32_MAX;
+  uint64_t chargeNah = 0; // nAh, so short fast wakes are not rounded away
+};
+
+RTC_DATA_ATTR static Counters counters;
+
+void Telemetry::countRefresh(bool full) {
+  if (full) {
+    counters.fullRefreshes++;
+  } else {
+    counters.partialRefreshes++;
+  }
+}
+
+void Telemetry::endWake(uint32_t sleepSeconds) {
+  // Connect to disconnect, not the network phase: Wi-Fi stays up until
+  // handleSleeping turns it off
+  const WiFiManager::RadioUsage radio = WiFiManager::radioUsage();
+  counters.wifiSessions += radio.sessions;
+  counters.wifiMillis += radio.onMillis;
+  if (radio.longestMillis > counters.wifiLongestMillis) {
+    counters.wifiLongestMillis = radio.longestMillis;
+  }
+  counters.sleepSeconds += sleepSeconds;
+
+  // uA x us / 3.6e6 = nAh; the coming sleep is charged up front
+  const uint64_t awakeUs = esp_timer_get_time();
+  counters.chargeNah += (awakeUs * TELEMETRY_ACTIVE_UA +
+                         (uint64_t)radio.onMillis * 1000 *
+                             TELEMETRY_RADIO_UA) /
+                            3600000ULL +
+                        (uint64_t)sleepSeconds * TELEMETRY_SLEEP_UA * 1000 /
+                            3600;
+
+  const uint32_t minHeap = ESP.getMinFreeHeap();
+  if (minHeap < counters.minFreeHeap) {
+    counters.minFreeHeap = minHeap;
+  }
+  const uint32_t stackFree = uxTaskGetStackHighWaterMark(nullptr);
+  if (stackFree < counters.minStackFree) {
+    counters.minStackFree = stackFree;
+    LOG_D("📉 Loop task stack low-water mark %lu bytes",
+          (unsigned long)stackFree);
+  }
+}
+
+static uint16_t batteryMillivolts() {
+#if BATTERY_ADC_PIN >= 0
+  return analogReadMilliVolts(BATTERY_ADC_PIN) * BATTERY_DIVIDER;
+#else
+  return TelemetryRecord::NO_BATTERY;
+#endif
+}
+
+static uint32_t average(uint64_t total, uint32_t count) {
+  return count ? (uint32_t)(total / count) : 0;
+}
+
+void Telemetry::snapshot(TelemetryRecord::Record &r) {
+  memset(&r, 0, sizeof(r));
+  r.version = TelemetryRecord::VERSION;
+  r.size = sizeof(r);
+  r.wakeCycles = rtcData.wakeCycleCount;
+  r.awakeSeconds = rtcData.cumulativeAwakeSeconds;
+  r.sleepSeconds = counters.sleepSeconds;
+  r.fullRefreshes = counters.fullRefreshes;
+  r.partialRefreshes = counters.partialRefreshes;
+  r.wifiSessions = counters.wifiSessions;
+  r.wifiMillis = counters.wifiMillis;
+  r.wifiLongestMillis = counters.wifiLongestMillis;
+  r.radioSecondsToday = rtcData.backoff.radioSeconds;
+
+  // This wake counts too, it has not reached endWake() yet
+  r.freeHeap = ESP.getFreeHeap();
+  r.minFreeHeap = min(counters.minFreeHeap, ESP.getMinFreeHeap());
+  r.largestFreeBlock = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+  r.minStackFree = min(counters.minStackFree,
+                       (uint32_t)uxTaskGetStackHighWaterMark(nullptr));
+  r.chargeUsedUah = counters.chargeNah / 1000;
+  r.batteryMillivolts = batteryMillivolts();
+
+  for (uint8_t p = 0; p < WAKE_PATH_COUNT; ++p) {
+    const WakeProfiler::PathStats &s = WakeProfiler::stats((WakePath)p);
+    TelemetryRecord::Path &out = r.paths[p];
+    out.wakes = s.wakes;
+    out.avgMicros = average(s.totalMicros, s.wakes);
+    out.avgEnergy = average(s.totalEnergy, s.wakes);
+    for (uint8_t i = 0; i < WAKE_PHASE_COUNT; ++i) {
+      out.avgPhaseMicros[i] = average(s.phaseMicros[i], s.wakes);
+    }
+  }
+
+  for (uint8_t i = 0; i < FETCH_SOURCE_COUNT; ++i) {
+    const FetchSource source = (FetchSource)i;
+    FetchBackoff::totals(source, r.fetches[i].successes,
+                         r.fetches[i].failures);
+    r.fetches[i].consecutiveFailures = FetchBackoff::failures(source);
+  }
+}
@@ -0,0 +1,38 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <Arduino.h>
+#include "TelemetryRecord.h"
+
+// Current draw behind the charge estimate; typical ESP32-S3 board figures,
+// override per hardware
+#ifndef TELEMETRY_ACTIVE_UA
+#define TELEMETRY_ACTIVE_UA 45000 // Awake, radio off
+#endif
+#ifndef TELEMETRY_RADIO_UA
+#define TELEMETRY_RADIO_UA 80000 // On top of the above while Wi-Fi is up
+#endif
+#ifndef TELEMETRY_SLEEP_UA
+#define TELEMETRY_SLEEP_UA 150 // Deep sleep, regulator and panel included
+#endif
+
+// ADC pin of a battery voltage divider (-1 = not fitted) and its ratio
+#ifndef BATTERY_ADC_PIN
+#define BATTERY_ADC_PIN -1
+#endif
+#ifndef BATTERY_DIVIDER
+#define BATTERY_DIVIDER 2
+#endif
+
+// Field counters for the BLE telemetry characteristic. Kept in RTC memory
+// like the WakeProfiler averages, so they cover every wake since power-on.
+class Telemetry {
+public:
+  static void countRefresh(bool full);
+  // Folds this wake into the counters; call right before deep sleep
+  static void endWake(uint32_t sleepSeconds);
+  // Counters so far plus live heap and battery readings
+  static void snapshot(TelemetryRecord::Record &record);
+};
+
+#endif // TELEMETRY_H
@@ -0,0 +1,79 @@
+#ifndef TELEMETRY_RECORD_H
+#define TELEMETRY_RECORD_H
+
+// Value of the BLE telemetry characteristic: counters kept in RTC memory
+// since the last power-on. Plain C++ so host tools share it (see
+// tools/telemetry_decode.cpp).
+//
+// One Record, little endian, no padding. Fields are only ever appended;
+// 'size' tells a decoder how much of the record the device sent.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace TelemetryRecord {
+
+constexpr uint8_t VERSION = 1;
+constexpr uint8_t PHASES = 8;  // WakePhase (WakeProfiler.h)
+constexpr uint8_t PATHS = 3;   // WakePath: boot, full, fast
+constexpr uint8_t SOURCES = 5; // FetchSource: wifi ... ntp, adhan
+constexpr uint16_t NO_BATTERY = 0;
+
+// Averages over all wakes of one path
+struct Path {
+  uint32_t wakes;
+  uint32_t avgMicros;
+  uint32_t avgPhaseMicros[PHASES];
+  uint32_t avgEnergy; // MHz*ms
+};
+
+struct Fetch {
+  uint32_t successes;
+  uint32_t failures;
+  uint8_t consecutiveFailures; // Current backoff level
+  uint8_t reserved[3];
+};
+
+struct Record {
+  uint8_t version;
+  uint8_t reserved;
+  uint16_t size; // sizeof(Record) of the sending firmware
+  uint32_t wakeCycles;
+  uint32_t awakeSeconds;
+  uint32_t sleepSeconds;
+  uint32_t fullRefreshes;
+  uint32_t partialRefreshes;
+  uint32_t wifiSessions;      // Connect to disconnect, failed ones too
+  uint32_t wifiMillis; // Radio-on time of all sessions
+  uint32_t wifiLongestMillis;
+  uint32_t radioSecondsToday; // Against the daily radio budget
+  uint32_t freeHeap;          // When the record was taken
+  uint32_t minFreeHeap;       // Lowest over all wakes
+  uint32_t largestFreeBlock;
+  uint32_t minStackFree;  // Loop task, bytes, lowest over all wakes
+  uint32_t chargeUsedUah; // Estimated from time awake, on radio and asleep
+  uint16_t batteryMillivolts; // NO_BATTERY without a sense divider
+  uint16_t reserved2;
+  Path paths[PATHS];
+  Fetch fetches[SOURCES];
+};
+
+static_assert(sizeof(Path) == 44, "Path must stay 44 bytes");
+static_assert(sizeof(Fetch) == 12, "Fetch must stay 12 bytes");
+static_assert(sizeof(Record) == 256, "Record must stay 256 bytes");
+
+// Accepts records from older (shorter) and newer (longer) firmware; fields
+// the sender did not have are zero
+inline bool decode(const uint8_t *data, size_t length, Record &record) {
+  memset(&record, 0, sizeof(record));
+  if (length < 4 || data[0] == 0) {
+    return false;
+  }
+  memcpy(&record, data, length < sizeof(record) ? length : sizeof(record));
+  return true;
+}
+
+} // namespace TelemetryRecord
+
+#endif // TELEMETRY_RECORD_H
@@ -1,6 +1,10 @@
 #include "RTCManager.h"
 #include <Arduino.h>
 #include <ArduinoJson.h>
+#include <AppStateManager.h>
+#include <TimeSnapshot.h>
+#include <esp_sntp.h>
+#include <sys/time.h>
 
 RTCManager &RTCManager::getInstance() {
   static RTCManager instance;
@@ -10,6 +14,19 @@ RTCManager &RTCManager::getInstance() {
 RTC_DATA_ATTR bool RTCManager::timeSynced = false;
 RTC_DATA_ATTR bool RTCManager::manualTimeSet = false;
 
+// Drift model tuning
+static const float ERROR_BUDGET_SECONDS = 20.0f; // Countdown has 1 min resolution
+static const float UNCALIBRATED_PPM = 200.0f; // RC slow clock before any estimate
+static const float CALIBRATED_PPM = 20.0f;    // Residual after compensation
+static const float MAX_DRIFT_PPM = 1000.0f;
+static const float DRIFT_GAIN = 0.5f;          // Weight of each new measurement
+static const time_t MIN_DRIFT_INTERVAL = 6L * 3600;
+// The phone sends whole seconds and BLE adds latency: about a second of
+// noise, which needs two days to weigh under CALIBRATED_PPM
+static const time_t PHONE_MIN_DRIFT_INTERVAL = 48L * 3600;
+static const time_t MAX_SYNC_INTERVAL = 14L * 24 * 3600;
+static const time_t NTP_RETRY_INTERVAL = 3600;
+
 void RTCManager::setRtcTimeFromISO8601(const String &iso8601Time) {
   struct tm tm;
   if (strptime(iso8601Time.c_str(), "%Y-%m-%dT%H:%M:%S", &tm) != NULL) {
@@ -23,21 +40,20 @@ void RTCManager::setRtcTimeFromISO8601(const String &iso8601Time) {
   }
 }
 time_t RTCManager::getEpochTime() {
-  struct tm timeinfo;
-  if (getLocalTime(&timeinfo)) {
-    time_t epochTime = mktime(&timeinfo);
-    return epochTime;
-  } else {
+  TimeSnapshot now = TimeSnapshot::now();
+  if (!now.valid) {
     Serial.println("❌ Failed to get current epoch time");
     return 0;
   }
+  return now.epoch;
 }
 void RTCManager::printTime() {
-  struct tm timeinfo;
-  if (!getLocalTime(&timeinfo)) {
+  TimeSnapshot now = TimeSnapshot::now();
+  if (!now.valid) {
     Serial.println("❌ Failed to get time");
     return;
   }
+  const struct tm &timeinfo = now.local;
 
   Serial.printf("⏰ Current RTC Time: %04d-%02d-%02d %02d:%02d:%02d\n",
                 timeinfo.tm_year + 1900, timeinfo.tm_mon + 1, timeinfo.tm_mday,
@@ -59,8 +75,9 @@ void RTCManager::setTimeToSpecificHourAndMinute(int newHour, int newMinute,
     Serial.println("❌ Manual time setting is already set.");
     return;
   }
-  struct tm timeinfo;
-  if (getLocalTime(&timeinfo)) {
+  TimeSnapshot now = TimeSnapshot::now();
+  if (now.valid) {
+    struct tm timeinfo = now.local;
     timeinfo.tm_hour = newHour;
     timeinfo.tm_min = newMinute;
     if (newMonth > 0 && newDay > 0) {
@@ -79,42 +96,177 @@ void RTCManager::setTimeToSpecificHourAndMinute(int newHour, int newMinute,
   }
 }
 
-bool RTCManager::syncTimeFromNTPWithOffset(int maxRetries, uint32_t timeoutMs, int timezoneOffsetSeconds) {
-  if (timezoneOffsetSeconds == 0) {
-    Serial.println("⏰ Syncing time from NTP (UTC)");
-  } else {
-    int hours = timezoneOffsetSeconds / 3600;
-    int minutes = (abs(timezoneOffsetSeconds) % 3600) / 60;
-    Serial.printf("⏰ Syncing time from NTP (UTC%+d:%02d)\n", hours, minutes);
-  }
+bool RTCManager::syncTimeFromNTP(int maxRetries, uint32_t timeoutMs,
+                                 const char *posixTz) {
+  Serial.printf("⏰ Syncing time from NTP (TZ=%s)\n", posixTz);
 
-  configTime(timezoneOffsetSeconds, 0, "pool.ntp.org", "time.nist.gov");
+  // RTC reading just before SNTP steps the clock, to measure drift
+  struct timeval before;
+  gettimeofday(&before, nullptr);
+  const unsigned long startMillis = millis();
+  rtcData.lastNtpAttempt = before.tv_sec;
+
+  configTzTime(posixTz, "pool.ntp.org", "time.nist.gov");
 
   Serial.println("⏳ Waiting for NTP time sync...");
-  
-  int attempts = 0;
-  const int maxAttempts = maxRetries * 10;
-  struct tm timeinfo;
-  
-  while (!getLocalTime(&timeinfo) && attempts < maxAttempts) {
-    delay(100);
-    attempts++;
-    if (attempts % 10 == 0) {
-      Serial.printf("⏳ Waiting... (%d/%d)\n", attempts / 10, maxRetries);
-      }
-    }
 
-  if (attempts >= maxAttempts) {
-    Serial.println("❌ Failed to sync time from NTP (timeout)");
-    return false;
+  // The RTC keeps a plausible time across deep sleep, so wait for SNTP
+  // itself rather than for getLocalTime() to succeed. maxRetries requests
+  // are spread over timeoutMs: a lost reply costs one interval, not the sync.
+  const uint32_t retryMs = timeoutMs / (maxRetries > 0 ? maxRetries : 1);
+  int requests = 1;
+  while (sntp_get_sync_status() != SNTP_SYNC_STATUS_COMPLETED) {
+    const unsigned long elapsed = millis() - startMillis;
+    if (elapsed >= timeoutMs) {
+      Serial.println("❌ Failed to sync time from NTP (timeout)");
+      return false;
     }
+    if (requests < maxRetries && elapsed >= requests * retryMs) {
+      requests++;
+      Serial.printf("⏳ No reply yet, asking again (%d/%d)\n", requests,
+                    maxRetries);
+      configTzTime(posixTz, "pool.ntp.org", "time.nist.gov");
+    }
+    delay(100);
+  }
+
+  struct timeval after;
+  gettimeofday(&after, nullptr);
+  if (before.tv_sec > 100000) {
+    const double rtcNow = before.tv_sec + before.tv_usec / 1e6 +
+                          (millis() - startMillis) / 1000.0;
+    const double ntpNow = after.tv_sec + after.tv_usec / 1e6;
+    updateDriftModel(rtcNow - ntpNow, after.tv_sec, MIN_DRIFT_INTERVAL);
+  }
+  rtcData.lastNtpSync = after.tv_sec;
+  rtcData.lastDriftCorrection = after.tv_sec;
 
   Serial.println("✅ NTP time sync complete");
   timeSynced = true;
   
+  struct tm timeinfo;
+  localtime_r(&after.tv_sec, &timeinfo);
   Serial.printf("⏰ Synced Time: %04d-%02d-%02d %02d:%02d:%02d\n",
                 timeinfo.tm_year + 1900, timeinfo.tm_mon + 1, timeinfo.tm_mday,
                 timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec);
 
       return true;
 }
+
+void RTCManager::syncTimeFromPhone(time_t epoch, uint32_t ageMillis) {
+  struct timeval before;
+  gettimeofday(&before, nullptr);
+  const int64_t phoneUs = (int64_t)epoch * 1000000LL + ageMillis * 1000LL;
+  struct timeval after = {(time_t)(phoneUs / 1000000LL),
+                          (suseconds_t)(phoneUs % 1000000LL)};
+  settimeofday(&after, nullptr);
+
+  if (before.tv_sec > 100000) {
+    const double rtcNow = before.tv_sec + before.tv_usec / 1e6;
+    updateDriftModel(rtcNow - phoneUs / 1e6, after.tv_sec,
+                     PHONE_MIN_DRIFT_INTERVAL);
+  }
+  rtcData.lastNtpSync = after.tv_sec;
+  rtcData.lastNtpAttempt = after.tv_sec;
+  rtcData.lastDriftCorrection = after.tv_sec;
+  timeSynced = true;
+  Serial.println("✅ RTC set from the phone's clock");
+}
+
+void RTCManager::updateDriftModel(double offsetSeconds, time_t syncedAt,
+                                  time_t minInterval) {
+  if (rtcData.lastNtpSync == 0 || syncedAt <= rtcData.lastNtpSync) {
+    Serial.printf("⏱️ RTC offset %+.3fs (no baseline for drift yet)\n",
+                  offsetSeconds);
+    return;
+  }
+  const double interval = (double)(syncedAt - rtcData.lastNtpSync);
+  if (interval < minInterval) {
+    Serial.printf("⏱️ RTC offset %+.3fs (interval too short for drift)\n",
+                  offsetSeconds);
+    return;
+  }
+
+  // Wakes already removed rtcDriftPpm, so the offset is the residual error
+  const double residualPpm = offsetSeconds / interval * 1e6;
+  float drift = rtcData.rtcDriftPpm;
+  drift += rtcData.driftSamples == 0 ? residualPpm : DRIFT_GAIN * residualPpm;
+  rtcData.rtcDriftPpm = constrain(drift, -MAX_DRIFT_PPM, MAX_DRIFT_PPM);
+  if (rtcData.driftSamples < 255) {
+    rtcData.driftSamples++;
+  }
+
+  Serial.printf("⏱️ RTC offset %+.3fs over %.1fh -> drift %+.1f ppm (%u samples)\n",
+                offsetSeconds, interval / 3600.0, rtcData.rtcDriftPpm,
+                rtcData.driftSamples);
+}
+
+void RTCManager::applyDriftCorrection() {
+  struct timeval tv;
+  gettimeofday(&tv, nullptr);
+  if (tv.tv_sec < 100000) {
+    return; // RTC not set
+  }
+  if (rtcData.lastDriftCorrection == 0 ||
+      tv.tv_sec <= rtcData.lastDriftCorrection ||
+      rtcData.rtcDriftPpm == 0.0f) {
+    rtcData.lastDriftCorrection = tv.tv_sec;
+    return;
+  }
+
+  const int64_t elapsedUs =
+      (int64_t)(tv.tv_sec - rtcData.lastDriftCorrection) * 1000000LL;
+  const int64_t correctionUs =
+      (int64_t)(elapsedUs * (double)rtcData.rtcDriftPpm / 1e6);
+  const int64_t nowUs =
+      (int64_t)tv.tv_sec * 1000000LL + tv.tv_usec - correctionUs;
+  tv.tv_sec = nowUs / 1000000LL;
+  tv.tv_usec = nowUs % 1000000LL;
+  settimeofday(&tv, nullptr);
+  rtcData.lastDriftCorrection = tv.tv_sec;
+}
+
+float RTCManager::predictedErrorSeconds() {
+  time_t now = time(nullptr);
+  if (rtcData.lastNtpSync == 0 || now <= rtcData.lastNtpSync) {
+    return 0.0f;
+  }
+  const float uncertaintyPpm =
+      rtcData.driftSamples == 0 ? UNCALIBRATED_PPM : CALIBRATED_PPM;
+  return (now - rtcData.lastNtpSync) * uncertaintyPpm / 1e6f;
+}
+
+bool RTCManager::isSyncDue() {
+  time_t now = time(nullptr);
+  if (now < 100000 || rtcData.lastNtpSync == 0) {
+    return false; // Boot path owns the first sync
+  }
+  if (now - rtcData.lastNtpAttempt < NTP_RETRY_INTERVAL) {
+    return false;
+  }
+  return predictedErrorSeconds() > ERROR_BUDGET_SECONDS ||
+         now - rtcData.lastNtpSync > MAX_SYNC_INTERVAL;
+}
+
+time_t RTCManager::nextSyncTime() {
+  if (rtcData.lastNtpSync == 0) {
+    return 0;
+  }
+  const float uncertaintyPpm =
+      rtcData.driftSamples == 0 ? UNCALIBRATED_PPM : CALIBRATED_PPM;
+  time_t due = rtcData.lastNtpSync +
+               (time_t)(ERROR_BUDGET_SECONDS * 1e6f / uncertaintyPpm);
+  if (due > rtcData.lastNtpSync + MAX_SYNC_INTERVAL) {
+    due = rtcData.lastNtpSync + MAX_SYNC_INTERVAL;
+  }
+  if (due < rtcData.lastNtpAttempt + NTP_RETRY_INTERVAL) {
+    due = rtcData.lastNtpAttempt + NTP_RETRY_INTERVAL;
+  }
+  return due;
+}
+
+uint64_t RTCManager::compensatedSleepMicros(uint32_t seconds) {
+  // A fast RTC finishes the timer early; stretch it by the same ratio
+  const double scale = 1.0 + (double)rtcData.rtcDriftPpm / 1e6;
+  return (uint64_t)((double)seconds * 1000000.0 * scale);
+}
@@ -27,10 +27,31 @@ public:
   bool isTimeSynced();
   void setTimeToSpecificHourAndMinute(int newHour, int newMinute,
                                       int newMonth = 0, int newDay = 0);
-  bool syncTimeFromNTPWithOffset(int maxRetries = 3,
-                                 uint32_t timeoutMs = 10000,
-                                 int timezoneOffsetSeconds = 0);
+  // posixTz is applied with configTzTime so DST rules survive the sync.
+  // timeoutMs bounds the whole wait; maxRetries requests are spread over it.
+  bool syncTimeFromNTP(int maxRetries = 3, uint32_t timeoutMs = 10000,
+                       const char *posixTz = "UTC0");
   time_t getEpochTime();
+  // Phone clock sent over BLE (offline setups never reach NTP): set like an
+  // NTP sync, drift model included. ageMillis is how long ago the phone
+  // read 'epoch'.
+  void syncTimeFromPhone(time_t epoch, uint32_t ageMillis = 0);
+
+  // Drift model: each NTP sync measures how far the RTC slow clock wandered
+  // since the previous one and refines rtcData.rtcDriftPpm. Wakes correct the
+  // clock with it, so NTP is only needed when the remaining uncertainty
+  // could exceed the error budget.
+  void applyDriftCorrection();
+  float predictedErrorSeconds();
+  bool isSyncDue();
+  // Epoch at which isSyncDue() will next turn true, 0 if not scheduled
+  time_t nextSyncTime();
+  // Timer value that makes a sleep of 'seconds' real seconds on a drifting RTC
+  uint64_t compensatedSleepMicros(uint32_t seconds);
+
+private:
+  void updateDriftModel(double offsetSeconds, time_t syncedAt,
+                        time_t minInterval);
 };
 
 #endif // RTC_MANAGER_H
\ No newline at end of file
@@ -0,0 +1,129 @@
+#include "TimezoneRules.h"
+#include "AppStateManager.h"
+#include <Logger.h>
+
+// A year plus slack so both transitions of any DST rule are within reach
+static const time_t TRANSITION_HORIZON = 400L * 24 * 3600;
+static const time_t SEARCH_STEP = 24L * 3600;
+
+static bool isDst(time_t t) {
+  struct tm local;
+  localtime_r(&t, &local);
+  return local.tm_isdst > 0;
+}
+
+void TimezoneRules::apply() {
+  setenv("TZ", current(), 1);
+  tzset();
+}
+
+const char *TimezoneRules::current() {
+  if (rtcData.posixTz[0] != '\0') {
+    return rtcData.posixTz;
+  }
+  static char derived[24];
+  fromOffset(rtcData.timezoneOffsetSeconds, derived, sizeof(derived));
+  return derived;
+}
+
+void TimezoneRules::fromOffset(int offsetSeconds, char *out, size_t outSize) {
+  // POSIX offsets are west-positive: UTC+1 is written "-1"
+  const char sign = offsetSeconds >= 0 ? '+' : '-';
+  const char posixSign = offsetSeconds >= 0 ? '-' : '+';
+  const int absSeconds = abs(offsetSeconds);
+  const int hours = absSeconds / 3600;
+  const int minutes = (absSeconds % 3600) / 60;
+  snprintf(out, outSize, "<%c%02d%02d>%c%d:%02d", sign, hours, minutes,
+           posixSign, hours, minutes);
+}
+
+bool TimezoneRules::isValid(const char *posixTz) {
+  if (!posixTz) {
+    return false;
+  }
+  const size_t len = strlen(posixTz);
+  if (len < 4 || len >= sizeof(rtcData.posixTz)) {
+    return false;
+  }
+  if (!isalpha((unsigned char)posixTz[0]) && posixTz[0] != '<') {
+    return false;
+  }
+  bool hasDigit = false;
+  for (size_t i = 0; i < len; ++i) {
+    const unsigned char c = posixTz[i];
+    if (c < 0x21 || c > 0x7E) {
+      return false;
+    }
+    hasDigit |= isdigit(c) != 0;
+  }
+  return hasDigit;
+}
+
+time_t TimezoneRules::nextTransition(time_t from, time_t horizonSeconds) {
+  const bool startDst = isDst(from);
+  time_t lo = from;
+  time_t hi = 0;
+
+  // Coarse scan by day, then bisect to the exact second
+  for (time_t t = from + SEARCH_STEP; t <= from + horizonSeconds;
+       t += SEARCH_STEP) {
+    if (isDst(t) != startDst) {
+      hi = t;
+      break;
+    }
+    lo = t;
+  }
+  if (hi == 0) {
+    return 0;
+  }
+
+  while (hi - lo > 1) {
+    const time_t mid = lo + (hi - lo) / 2;
+    if (isDst(mid) == startDst) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+  return hi;
+}
+
+static void scheduleTransition(time_t now) {
+  time_t next = TimezoneRules::nextTransition(now, TRANSITION_HORIZON);
+  // No DST in this zone: re-check after the horizon instead of every wake
+  rtcData.nextTzTransition = next != 0 ? next : now + TRANSITION_HORIZON;
+
+  if (next == 0) {
+    LOG_I("🕐 No DST transition within %d days",
+          (int)(TRANSITION_HORIZON / (24 * 3600)));
+    return;
+  }
+  struct tm local;
+  localtime_r(&next, &local);
+  LOG_I("🕐 Next DST transition: %02d/%02d %02d:%02d", local.tm_mday,
+        local.tm_mon + 1, local.tm_hour, local.tm_min);
+}
+
+bool TimezoneRules::checkTransition(time_t now) {
+  if (now < 100000) {
+    return false; // RTC not set yet
+  }
+  if (rtcData.nextTzTransition == 0) {
+    scheduleTransition(now);
+    return false;
+  }
+  if (now < rtcData.nextTzTransition) {
+    return false;
+  }
+
+  const bool switched = isDst(rtcData.nextTzTransition - 1) != isDst(now);
+  scheduleTransition(now);
+  return switched;
+}
+
+uint32_t TimezoneRules::secondsUntilTransition(time_t now) {
+  if (rtcData.nextTzTransition <= now) {
+    return 0;
+  }
+  return (uint32_t)(rtcData.nextTzTransition - now);
+}
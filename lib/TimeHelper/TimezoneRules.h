@@ -0,0 +1,38 @@
+#ifndef TIMEZONE_RULES_H
+#define TIMEZONE_RULES_H
+
+#include <Arduino.h>
+#include <time.h>
+
+// POSIX TZ handling ("CET-1CEST,M3.5.0,M10.5.0/3"). The rules live in
+// rtcData.posixTz and are applied to newlib with setenv/tzset on every wake,
+// so DST switches happen locally without NTP or re-provisioning. Devices
+// provisioned with only a fixed offset get an equivalent "<+01>-1:00" zone.
+class TimezoneRules {
+public:
+  // Applies the configured zone to the C library (TZ is lost in deep sleep)
+  static void apply();
+
+  // Zone string currently in effect (configured rules or derived from the
+  // fixed offset)
+  static const char *current();
+
+  // Builds a fixed-offset POSIX zone; offset is seconds east of UTC
+  static void fromOffset(int offsetSeconds, char *out, size_t outSize);
+
+  // Cheap sanity check for BLE/config input; tzset() itself cannot fail
+  static bool isValid(const char *posixTz);
+
+  // First instant after 'from' where tm_isdst flips, searched up to
+  // horizonSeconds ahead. Returns 0 when the zone has no transition in range.
+  static time_t nextTransition(time_t from, time_t horizonSeconds);
+
+  // Tracks rtcData.nextTzTransition. Returns true once when 'now' has passed
+  // the scheduled transition, then schedules the following one.
+  static bool checkTransition(time_t now);
+
+  // Seconds until the scheduled transition, or 0 if none is pending
+  static uint32_t secondsUntilTransition(time_t now);
+};
+
+#endif // TIMEZONE_RULES_H
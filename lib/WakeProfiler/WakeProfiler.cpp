@@ -0,0 +1,111 @@
+#include "WakeProfiler.h"
+#include <CpuGovernor.h>
+#include <Logger.h>
+#include <esp_timer.h>
+
+static const char *const PHASE_NAMES[WAKE_PHASE_COUNT] = {
+    "boot", "rtc", "plan", "fs", "display", "render", "network", "sleep"};
+static const char *const PATH_NAMES[WAKE_PATH_COUNT] = {"boot", "full",
+                                                        "fast"};
+
+// Averages survive deep sleep so fast and full wakes can be compared
+RTC_DATA_ATTR static WakeProfiler::PathStats pathStats[WAKE_PATH_COUNT];
+
+static uint32_t phaseUs[WAKE_PHASE_COUNT];
+static uint32_t phaseMhzMs[WAKE_PHASE_COUNT];
+static uint16_t phaseClock[WAKE_PHASE_COUNT]; // Last clock seen per phase
+static WakePhase current = WAKE_PHASE_BOOT;
+static int64_t phaseStart = 0;
+static WakePath path = WAKE_PATH_BOOT;
+
+void WakeProfiler::begin() {
+  memset(phaseUs, 0, sizeof(phaseUs));
+  memset(phaseMhzMs, 0, sizeof(phaseMhzMs));
+  memset(phaseClock, 0, sizeof(phaseClock));
+  current = WAKE_PHASE_BOOT;
+  phaseStart = 0; // esp_timer counts from app start
+  path = WAKE_PATH_BOOT;
+  enter(WAKE_PHASE_RTC_LOAD);
+}
+
+void WakeProfiler::setPath(WakePath newPath) {
+  path = newPath;
+  if (path != WAKE_PATH_BOOT) {
+    CpuGovernor::apply(current);
+  }
+}
+
+void WakeProfiler::enter(WakePhase phase) {
+  const int64_t now = esp_timer_get_time();
+  if (current < WAKE_PHASE_COUNT) {
+    // The clock only changes on phase boundaries, so the current one is
+    // the one the closing phase ran at
+    const uint32_t us = (uint32_t)(now - phaseStart);
+    const uint32_t mhz = getCpuFrequencyMhz();
+    phaseUs[current] += us;
+    phaseMhzMs[current] += (uint32_t)((uint64_t)us * mhz / 1000);
+    phaseClock[current] = (uint16_t)mhz;
+  }
+  current = phase;
+  phaseStart = now;
+  if (path != WAKE_PATH_BOOT) {
+    CpuGovernor::apply(phase);
+  }
+}
+
+void WakeProfiler::finish() {
+  enter(WAKE_PHASE_COUNT);
+
+  uint64_t total = 0;
+  uint64_t energy = 0;
+  for (uint8_t i = 0; i < WAKE_PHASE_COUNT; ++i) {
+    total += phaseUs[i];
+    energy += phaseMhzMs[i];
+    if (phaseUs[i] > 0) {
+      LOG_D("⏱️ %s: %lu us @ %u MHz = %lu MHz*ms", PHASE_NAMES[i],
+            (unsigned long)phaseUs[i], phaseClock[i],
+            (unsigned long)phaseMhzMs[i]);
+    }
+  }
+
+  PathStats &s = pathStats[path];
+  s.wakes++;
+  s.totalMicros += total;
+  s.totalEnergy += energy;
+  for (uint8_t i = 0; i < WAKE_PHASE_COUNT; ++i) {
+    s.phaseMicros[i] += phaseUs[i];
+    s.phaseEnergy[i] += phaseMhzMs[i];
+  }
+
+  const PathStats &fast = pathStats[WAKE_PATH_FAST];
+  const PathStats &full = pathStats[WAKE_PATH_FULL];
+  LOG_I("⏱️ %s wake %lu ms, %lu MHz*ms", PATH_NAMES[path],
+        (unsigned long)(total / 1000), (unsigned long)energy);
+  LOG_I("⏱️ avg fast %lu ms / %lu MHz*ms, full %lu ms / %lu MHz*ms",
+        (unsigned long)(fast.wakes ? fast.totalMicros / fast.wakes / 1000 : 0),
+        (unsigned long)(fast.wakes ? fast.totalEnergy / fast.wakes : 0),
+        (unsigned long)(full.wakes ? full.totalMicros / full.wakes / 1000 : 0),
+        (unsigned long)(full.wakes ? full.totalEnergy / full.wakes : 0));
+}
+
+WakePhase WakeProfiler::currentPhase() { return current; }
+
+uint32_t WakeProfiler::phaseMicros(WakePhase phase) {
+  return phase < WAKE_PHASE_COUNT ? phaseUs[phase] : 0;
+}
+
+uint32_t WakeProfiler::phaseEnergy(WakePhase phase) {
+  return phase < WAKE_PHASE_COUNT ? phaseMhzMs[phase] : 0;
+}
+
+const WakeProfiler::PathStats &WakeProfiler::stats(WakePath which) {
+  return pathStats[which < WAKE_PATH_COUNT ? which : WAKE_PATH_BOOT];
+}
+
+const char *WakeProfiler::phaseName(WakePhase phase) {
+  return phase < WAKE_PHASE_COUNT ? PHASE_NAMES[phase] : "";
+}
+
+const char *WakeProfiler::pathName(WakePath which) {
+  return which < WAKE_PATH_COUNT ? PATH_NAMES[which] : "";
+}
@@ -0,0 +1,57 @@
+#ifndef WAKE_PROFILER_H
+#define WAKE_PROFILER_H
+
+#include <Arduino.h>
+
+// Named phases of one wake. Time is attributed to the phase that is active,
+// from esp_timer start (app entry) until deep sleep. Energy is reported as
+// time x CPU clock (MHz*ms), a relative figure for comparing clock policies.
+enum WakePhase : uint8_t {
+  WAKE_PHASE_BOOT = 0,     // App start until setup() runs
+  WAKE_PHASE_RTC_LOAD,     // RTC block validation, TZ, drift correction
+  WAKE_PHASE_SCHEDULE,     // Deciding what this wake has to do
+  WAKE_PHASE_FS_MOUNT,     // SPIFFS mount
+  WAKE_PHASE_DISPLAY_INIT, // SPI + panel init
+  WAKE_PHASE_RENDER,       // Building and pushing the frame
+  WAKE_PHASE_NETWORK,      // Wi-Fi, TLS, downloads, parsing
+  WAKE_PHASE_SLEEP,        // Bookkeeping before deep sleep
+  WAKE_PHASE_COUNT
+};
+
+enum WakePath : uint8_t {
+  WAKE_PATH_BOOT = 0, // Cold boot / button wake, not averaged
+  WAKE_PATH_FULL,     // Timer wake through the state machine
+  WAKE_PATH_FAST,     // Timer wake that only ticked the countdown
+  WAKE_PATH_COUNT
+};
+
+class WakeProfiler {
+public:
+  struct PathStats {
+    uint32_t wakes = 0;
+    uint64_t totalMicros = 0;
+    uint64_t phaseMicros[WAKE_PHASE_COUNT] = {};
+    uint64_t totalEnergy = 0; // MHz*ms
+    uint64_t phaseEnergy[WAKE_PHASE_COUNT] = {};
+  };
+
+  // Call first thing in setup(); everything before it counts as BOOT
+  static void begin();
+  // Timer wakes (FULL/FAST) hand the CPU clock to CpuGovernor; boot and
+  // button wakes keep the default clock for BLE/Wi-Fi setup
+  static void setPath(WakePath path);
+  // Closes the running phase and starts 'phase' at its governed clock
+  static void enter(WakePhase phase);
+  // Closes the wake: logs the phase breakdown and folds it into the
+  // per-path averages kept in RTC memory
+  static void finish();
+
+  static WakePhase currentPhase();
+  static uint32_t phaseMicros(WakePhase phase); // This wake so far
+  static uint32_t phaseEnergy(WakePhase phase); // MHz*ms, this wake so far
+  static const PathStats &stats(WakePath path);
+  static const char *phaseName(WakePhase phase);
+  static const char *pathName(WakePath path);
+};
+
+#endif // WAKE_PROFILER_H
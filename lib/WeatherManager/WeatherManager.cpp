@@ -1,10 +1,15 @@
 #include "WeatherManager.h"
 #include "AppStateManager.h"
 #include <ArduinoJson.h>
-#include <HTTPClient.h>
-#include <WiFiClientSecure.h>
+#include <HttpCache.h>
+#include <HttpsSession.h>
 #include <time.h>
 
+// Test builds point this at tools/http_cache_mock.py
+#ifndef OPEN_METEO_API_URL
+#define OPEN_METEO_API_URL "https://api.open-meteo.com"
+#endif
+
 extern RTCData rtcData;
 
 struct FetchParams {
@@ -18,6 +23,86 @@ WeatherManager &WeatherManager::getInstance() {
   return instance;
 }
 
+// Map WMO weather codes to descriptions
+const char *WeatherManager::describe(uint8_t weatherCode) {
+  if (weatherCode == 0) {
+    return "Clear";
+  } else if (weatherCode >= 1 && weatherCode <= 3) {
+    return "Cloudy";
+  } else if (weatherCode >= 45 && weatherCode <= 48) {
+    return "Fog";
+  } else if (weatherCode >= 51 && weatherCode <= 67) {
+    return "Rain";
+  } else if (weatherCode >= 71 && weatherCode <= 77) {
+    return "Snow";
+  } else if (weatherCode >= 80 && weatherCode <= 82) {
+    return "Rain";
+  } else if (weatherCode >= 85 && weatherCode <= 86) {
+    return "Snow";
+  } else if (weatherCode >= 95 && weatherCode <= 99) {
+    return "Storm";
+  }
+  return "Unknown";
+}
+
+// Entry nearest to 'now' (switches at half past), -1 outside the forecast
+static int forecastIndex(time_t now) {
+  const WeatherForecast &f = rtcData.weather;
+  if (f.count == 0 || now + 1800 < f.start) {
+    return -1;
+  }
+  const int index = (int)((now - f.start + 1800) / 3600);
+  return index < f.count ? index : -1;
+}
+
+bool WeatherManager::applyForecast(time_t now) {
+  const int index = forecastIndex(now);
+  if (index < 0) {
+    return false; // Keep the last shown values until the next fetch
+  }
+  const WeatherForecast &f = rtcData.weather;
+  const float temp = f.temp[index];
+  const char *description = describe(f.code[index]);
+  if (temp == rtcData.currentTemp &&
+      strcmp(description, rtcData.weatherDesc) == 0) {
+    return false;
+  }
+  rtcData.currentTemp = temp;
+  strncpy(rtcData.weatherDesc, description, sizeof(rtcData.weatherDesc) - 1);
+  rtcData.weatherDesc[sizeof(rtcData.weatherDesc) - 1] = '\0';
+  return true;
+}
+
+time_t WeatherManager::nextChange(time_t now) {
+  const int index = forecastIndex(now);
+  if (index < 0) {
+    return 0;
+  }
+  const WeatherForecast &f = rtcData.weather;
+  for (int i = index + 1; i < f.count; ++i) {
+    if (f.temp[i] != f.temp[index] ||
+        strcmp(describe(f.code[i]), describe(f.code[index])) != 0) {
+      return f.start + (time_t)i * 3600 - 1800;
+    }
+  }
+  return 0;
+}
+
+int WeatherManager::hoursRemaining(time_t now) {
+  const WeatherForecast &f = rtcData.weather;
+  const time_t end = f.start + (time_t)f.count * 3600;
+  return end > now ? (int)((end - now) / 3600) : 0;
+}
+
+void WeatherManager::useDaySnapshot(time_t dayStart, int8_t temperature,
+                                    uint8_t weatherCode) {
+  WeatherForecast &f = rtcData.weather;
+  f.start = dayStart;
+  f.count = 24;
+  memset(f.temp, temperature, f.count);
+  memset(f.code, weatherCode, f.count);
+}
+
 void WeatherManager::asyncFetchWeather(float latitude, float longitude,
                                         FetchCallback callback) {
   FetchParams *params = new FetchParams{latitude, longitude, callback};
@@ -27,40 +112,58 @@ void WeatherManager::asyncFetchWeather(float latitude, float longitude,
 void WeatherManager::fetchTask(void *parameter) {
   FetchParams *params = static_cast<FetchParams *>(parameter);
 
-  // Build Open-Meteo API URL
-  // Format: https://api.open-meteo.com/v1/forecast?latitude=X&longitude=Y&current=temperature_2m,weather_code
-  String url = "https://api.open-meteo.com/v1/forecast?";
+  // Build Open-Meteo API URL: hourly forecast from the current hour on,
+  // with unix timestamps so no timezone handling is needed here
+  String url = OPEN_METEO_API_URL "/v1/forecast?";
   url += "latitude=" + String(params->latitude, 6);
   url += "&longitude=" + String(params->longitude, 6);
-  url += "&current=temperature_2m,weather_code";
+  url += "&hourly=temperature_2m,weather_code&timeformat=unixtime";
+  url += "&forecast_hours=" + String(WeatherForecast::HOURS);
 
   Serial.printf("🌤️ Fetching weather from Open-Meteo: %s\n", url.c_str());
 
   bool success = false;
   const int MAX_RETRIES = 2;
   int httpCode = -1;
-  String payload = "";
 
-  // Retry loop
-  for (int attempt = 1; attempt <= MAX_RETRIES + 1; attempt++) {
-    HTTPClient http;
-    WiFiClientSecure client;
-    client.setInsecure(); // Skip certificate validation
+  // Only the hourly series is materialised, the rest of the body is skipped
+  JsonDocument filter;
+  filter["hourly"]["time"] = true;
+  filter["hourly"]["temperature_2m"] = true;
+  filter["hourly"]["weather_code"] = true;
+  JsonDocument doc;
+  DeserializationError error = DeserializationError::EmptyInput;
 
+  // The forecast is parsed while it streams in, so only a 304 can spare
+  // work here; ask for one while the stored forecast still has hours left
+  const bool haveCopy = hoursRemaining(time(nullptr)) > 0;
+  HttpCache::Validators validators;
+
+  // One client for all attempts: a retry reuses the open connection
+  HttpsSession::Lease lease(url);
+  HTTPClient &http = lease.http();
+
+  // Retry loop
+  for (int attempt = 1; lease.ok() && attempt <= MAX_RETRIES + 1; attempt++) {
     if (attempt > 1) {
       Serial.printf("🔄 Retry attempt %d/%d for Open-Meteo\n", attempt - 1, MAX_RETRIES);
       delay(2000); // Wait 2 seconds between retries
     }
 
-    http.begin(client, url);
+    http.begin(lease.client(), url);
     http.setTimeout(15000);
+    HttpCache::prepare(http, url, haveCopy);
     httpCode = http.GET();
 
     if (httpCode == HTTP_CODE_OK) {
-      payload = http.getString();
-      Serial.printf("✅ Received %d bytes from Open-Meteo\n", payload.length());
+      validators = HttpCache::validators(http);
+      error = HttpsSession::readJson(http, doc, filter);
+      Serial.println("✅ Received Open-Meteo forecast");
       http.end();
       break; // Success, exit retry loop
+    } else if (httpCode == HTTP_CODE_NOT_MODIFIED) {
+      http.end();
+      break;
     } else {
       Serial.printf("❌ Open-Meteo request failed, code: %d (attempt %d/%d)\n", 
                     httpCode, attempt, MAX_RETRIES + 1);
@@ -73,52 +176,50 @@ void WeatherManager::fetchTask(void *parameter) {
     }
   }
 
-  if (httpCode == HTTP_CODE_OK) {
-
-    JsonDocument doc;
-    DeserializationError error = deserializeJson(doc, payload);
-
+  if (httpCode == HTTP_CODE_NOT_MODIFIED) {
+    Serial.println("✅ Weather forecast unchanged (304)");
+    rtcData.weatherLastUpdate = time(nullptr);
+    AppStateManager::save();
+    success = true;
+  } else if (httpCode == HTTP_CODE_OK) {
     if (!error) {
-      JsonObject current = doc["current"];
-      if (current) {
-        float temp = current["temperature_2m"] | 0.0;
-        int weatherCode = current["weather_code"] | 0;
-
-        // Map WMO weather codes to descriptions
-        const char *description = "Unknown";
-        if (weatherCode == 0) {
-          description = "Clear";
-        } else if (weatherCode >= 1 && weatherCode <= 3) {
-          description = "Cloudy";
-        } else if (weatherCode >= 45 && weatherCode <= 48) {
-          description = "Fog";
-        } else if (weatherCode >= 51 && weatherCode <= 67) {
-          description = "Rain";
-        } else if (weatherCode >= 71 && weatherCode <= 77) {
-          description = "Snow";
-        } else if (weatherCode >= 80 && weatherCode <= 82) {
-          description = "Rain";
-        } else if (weatherCode >= 85 && weatherCode <= 86) {
-          description = "Snow";
-        } else if (weatherCode >= 95 && weatherCode <= 99) {
-          description = "Storm";
+      JsonArray times = doc["hourly"]["time"];
+      JsonArray temps = doc["hourly"]["temperature_2m"];
+      JsonArray codes = doc["hourly"]["weather_code"];
+      if (times.size() > 0 && temps.size() >= times.size() &&
+          codes.size() >= times.size()) {
+        WeatherForecast forecast;
+        forecast.start = times[0].as<time_t>();
+        for (JsonVariant t : times) {
+          if (forecast.count == WeatherForecast::HOURS) {
+            break;
+          }
+          const uint8_t i = forecast.count;
+          // Hourly series: every entry must sit on its expected slot
+          if (t.as<time_t>() != forecast.start + (time_t)i * 3600) {
+            break;
+          }
+          forecast.temp[i] = (int8_t)constrain(lroundf(temps[i] | 0.0f), -128, 127);
+          forecast.code[i] = (uint8_t)(codes[i] | 0);
+          forecast.count++;
         }
 
-        // Save to RTC memory
-        rtcData.currentTemp = temp;
-        strncpy(rtcData.weatherDesc, description, sizeof(rtcData.weatherDesc) - 1);
-        rtcData.weatherDesc[sizeof(rtcData.weatherDesc) - 1] = '\0';
+        // Save to RTC memory; only the validators matter for the cache
+        rtcData.weather = forecast;
+        HttpCache::store(url, validators, 0);
         
         // Use epoch time (not millis) for proper interval checking
         time_t now = time(nullptr);
         rtcData.weatherLastUpdate = now;
+        applyForecast(now);
 
         AppStateManager::save();
 
-        Serial.printf("🌤️ Weather updated: %.1f°C, %s\n", temp, description);
+        Serial.printf("🌤️ Weather forecast stored: %u hours, now %.0f°C, %s\n",
+                      forecast.count, rtcData.currentTemp, rtcData.weatherDesc);
         success = true;
       } else {
-        Serial.println("❌ No 'current' data in Open-Meteo response");
+        Serial.println("❌ No 'hourly' data in Open-Meteo response");
       }
     } else {
       Serial.printf("❌ Failed to parse Open-Meteo JSON: %s\n", error.c_str());
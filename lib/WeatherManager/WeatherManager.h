@@ -3,6 +3,17 @@
 
 #include <Arduino.h>
 #include <functional>
+#include <time.h>
+
+// Hourly forecast kept in RTC memory. The entry for the current hour is
+// picked locally on each wake, so Wi-Fi is only needed to refresh it.
+struct WeatherForecast {
+  static constexpr uint8_t HOURS = 48;
+  time_t start = 0;  // UTC epoch of the first hour
+  uint8_t count = 0; // Valid entries
+  int8_t temp[HOURS] = {};  // Degrees Celsius, rounded
+  uint8_t code[HOURS] = {}; // WMO weather code
+};
 
 class WeatherManager {
 private:
@@ -18,6 +29,20 @@ public:
   using FetchCallback = std::function<void(bool success)>;
 
   void asyncFetchWeather(float latitude, float longitude, FetchCallback callback);
+
+  // Copies the forecast hour nearest to 'now' into rtcData.currentTemp and
+  // weatherDesc; returns true if what the screen shows changed
+  static bool applyForecast(time_t now);
+  // When applyForecast() will next change the shown weather, 0 if not
+  // within the stored forecast
+  static time_t nextChange(time_t now);
+  // Forecast hours left after 'now'
+  static int hoursRemaining(time_t now);
+  // Replaces the forecast with one value for the 24 hours from dayStart
+  // (a daily snapshot from an uploaded calendar)
+  static void useDaySnapshot(time_t dayStart, int8_t temperature,
+                             uint8_t weatherCode);
+  static const char *describe(uint8_t weatherCode);
 };
 
 #endif // WEATHER_MANAGER_H
@@ -6,6 +6,42 @@
 #include <SPIFFSHelper.h>
 #include <vector>
 
+// Plain statics: a deep sleep wake starts them from zero
+static WiFiManager::RadioUsage radioUsageSoFar;
+static unsigned long radioOnSince = 0;
+static bool radioOn = false;
+
+static uint32_t openSessionMillis() {
+  return radioOn ? millis() - radioOnSince : 0;
+}
+
+void WiFiManager::radioOff() {
+  if (WiFi.getMode() != WIFI_OFF) {
+    WiFi.disconnect(true);
+    WiFi.mode(WIFI_OFF);
+  }
+  if (radioOn) {
+    const uint32_t ms = openSessionMillis();
+    radioOn = false;
+    radioUsageSoFar.sessions++;
+    radioUsageSoFar.onMillis += ms;
+    if (ms > radioUsageSoFar.longestMillis) {
+      radioUsageSoFar.longestMillis = ms;
+    }
+  }
+}
+
+WiFiManager::RadioUsage WiFiManager::radioUsage() {
+  RadioUsage usage = radioUsageSoFar;
+  const uint32_t open = openSessionMillis();
+  if (open > 0) {
+    usage.sessions++;
+    usage.onMillis += open;
+    usage.longestMillis = max(usage.longestMillis, open);
+  }
+  return usage;
+}
+
 WiFiManager::WiFiManager() {
   WiFi.setAutoReconnect(false);
   WiFi.mode(WIFI_STA);
@@ -57,8 +93,8 @@ void WiFiManager::asyncConnect(const char *ssid, const char *password) {
 }
 
 void WiFiManager::asyncConnectWithSavedCredentials() {
-  String wifiJsonString = readJsonFile(WIFI_CRED_FILE);
-  if (wifiJsonString.isEmpty() || wifiJsonString == "{}") {
+  JsonDocument doc;
+  if (!readJsonFile(WIFI_CRED_FILE, doc) || doc.size() == 0) {
     Serial.println("⚠️ No valid Wi-Fi credentials found - "
                    "asyncConnectWithSavedCredentials");
     // Trigger failure callback to allow fallback to BLE
@@ -66,16 +102,6 @@ void WiFiManager::asyncConnectWithSavedCredentials() {
       WiFiManager::getInstance().onWifiFailedToConnect();
     }
     return;
-  }
-  DynamicJsonDocument doc(256);
-  DeserializationError errorParsingWifi = deserializeJson(doc, wifiJsonString);
-  if (errorParsingWifi) {
-    Serial.println("❌ JSON parse failed");
-    // Trigger failure callback
-    if (WiFiManager::getInstance().onWifiFailedToConnect) {
-      WiFiManager::getInstance().onWifiFailedToConnect();
-    }
-    return;
   } else {
     String ssid = doc["ssid"].as<String>();
     String password = doc["password"].as<String>();
@@ -124,6 +150,11 @@ void WiFiManager::scanTask(void *parameter) {
 void WiFiManager::connectTask(void *parameter) {
   ConnectParams *params = static_cast<ConnectParams *>(parameter);
   bool connected = false;
+  if (!radioOn) {
+    // Retries and a failed connect count too: the radio is up throughout
+    radioOn = true;
+    radioOnSince = millis();
+  }
 
   for (int attempt = 1; attempt <= WIFI_MAX_RETRIES; attempt++) {
     Serial.printf("🔄 Attempt %d/%d: Connecting to %s\n", attempt, WIFI_MAX_RETRIES, params->ssid);
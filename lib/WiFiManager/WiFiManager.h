@@ -16,6 +16,14 @@ struct ScanResult {
 
 class WiFiManager {
 public:
+  // Radio-on time of this wake, from each connect attempt to the
+  // radioOff() that ends it
+  struct RadioUsage {
+    uint32_t sessions = 0;
+    uint32_t onMillis = 0;
+    uint32_t longestMillis = 0;
+  };
+
   using ConnectionCallback = std::function<void(bool success)>;
   using ScanCallback = std::function<void(std::vector<ScanResult>)>;
   using WifiConnectedCallback = std::function<void()>;
@@ -29,6 +37,13 @@ public:
   void asyncConnect(const char *ssid, const char *password);
   void asyncConnectWithSavedCredentials();
 
+  // Disconnects and powers the radio down, closing the open session. Static
+  // so that wakes which never used Wi-Fi do not construct the manager (its
+  // constructor starts the radio).
+  static void radioOff();
+  // This wake's sessions so far; one still open counts up to now
+  static RadioUsage radioUsage();
+
 private:
   WiFiManager();
   WiFiManager(const WiFiManager &) = delete;
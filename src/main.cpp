@@ -7,9 +7,13 @@
 #include "WiFiManager.h"
 #include <AppState.h>
 #include <Arduino.h>
+#include <algorithm>
+#include <atomic>
 #include <ArduinoJson.h>
 #include <BLEManager.h>
+#include <BleProtocol.h>
 #include <CalendarManager.h>
+#include <CalendarUpload.h>
 #include <Fonts/FreeMonoBold18pt7b.h>
 #include <Fonts/FreeMonoBold24pt7b.h>
 #include <Fonts/FreeMonoBold9pt7b.h>
@@ -17,11 +21,20 @@
 // MAWAQIT API - Commented out, replaced with alternative API
 // #include <MAWAQITManager.h>
 #include <AladhanManager.h>
+#include <AudioManager.h>
+#include <FetchBackoff.h>
+#include <HttpsSession.h>
 #include <RTCManager.h>
+#include <TimezoneRules.h>
+#include <TimeSnapshot.h>
+#include <Logger.h>
+#include <Telemetry.h>
+#include <WakeProfiler.h>
 #include <SPI.h>
 #include <esp_wifi.h>
 #include <WeatherManager.h>
 #include <AppStateManager.h>
+#include <IqamaRules.h>
 
 // Pins for E-paper
 #define EPD_CS 10
@@ -40,8 +53,10 @@ GxEPD2_BW<GxEPD2_750_T7, GxEPD2_750_T7::HEIGHT>
 struct RenderState {
   bool initialized;
   int lastHighlight;
-  char times[5][6];       // Fajr..Isha بصيغة "HH:MM"
-  char nextPrayerTime[6]; // HH:MM format for calculating countdown in sleep
+  uint16_t times[5];          // Fajr..Isha, minutes since midnight
+  uint16_t nextPrayerMinutes; // For calculating countdown in sleep
+  time_t renderPlanUntil; // First instant the frame needs more than a countdown
+  time_t fastPathUntil;   // renderPlanUntil capped by the next network task
 };
 // RTC slow memory state (optional)
 RTC_DATA_ATTR RenderState g_renderState;
@@ -50,13 +65,20 @@ RTC_DATA_ATTR RenderState g_renderState;
 RTC_DATA_ATTR unsigned long g_sleepStartMillis = 0;
 
 CalendarManager calendarManager;
+// Clock reading taken once per wake, shared by the render and scheduling code
+TimeSnapshot g_wakeTime;
 unsigned int sleepDuration = 60; // in seconds, default fallback
 const char *PRAYER_NAMES[] = {"Fajr", "Sunrise", "Dhuhr",
                               "Asr",  "Maghrib", "Isha"};
+const char *PRAYER_NAMES_ROW[5] = {"Fajr", "Dhuhr", "Asr", "Maghrib", "Isha"};
 
 const unsigned long mosqueUpdateInterval = 6UL * 60UL * 60UL; // 6 hours
 const unsigned long userEventsUpdateInterval = 10UL * 60UL;   // 10 minutes
-const unsigned long weatherUpdateInterval = 60UL * 60UL;      // 1 hour
+// The 48 h hourly forecast is picked from locally each wake; refreshing it
+// twice a day keeps at least 36 h in hand
+const unsigned long weatherUpdateInterval = 12UL * 60UL * 60UL; // 12 hours
+const time_t CALENDAR_RETRY_SECONDS = 60 * 60; // While coverage is alarming
+bool g_calendarAlarm = false; // Prayer data on flash is about to run out
 bool isFetching = false;
 
 AppState state = BOOTING;
@@ -68,13 +90,42 @@ String g_receivedSSID = "";
 String g_receivedPassword = "";
 String g_receivedMosqueUUID = ""; // Legacy, kept for backward compatibility
 int g_receivedTimezoneOffset = 0;
+String g_receivedPosixTz = "";      // Optional DST rules ("posix_tz")
+String g_receivedTimezoneName = ""; // Optional IANA name ("timezone_name")
 // NEW: Location-based prayer times configuration
 float g_receivedLatitude = 0.0;
 float g_receivedLongitude = 0.0;
 int g_receivedCalculationMethod = 4; // Default: Umm Al-Qura (Makkah)
+// Optional iqama rules ("iqama" object in the BLE config JSON)
+IqamaRuleSet g_receivedIqamaRules;
+bool g_hasReceivedIqamaRules = false;
+int g_receivedHijriAdjustment = 0;
+uint32_t g_receivedCurrentTime = 0; // Phone clock for offline setup
+bool g_calendarUploaded = false;    // A calendar came in this BLE session
 // WiFi connection retry counter
 int g_wifiRetryCount = 0;
 const int MAX_WIFI_RETRIES = 3; // After 3 failed attempts, fall back to BLE
+// Set to sleep longer than the usual minute (boot-time Wi-Fi backoff)
+uint32_t g_minSleepSeconds = 0;
+// Settings window: BLE stays open after a button wake for single-field
+// changes (BleProtocol MSG_SETTINGS) without re-provisioning
+bool g_settingsWindowPending = false;
+BleProtocol::Config g_pendingSettings; // Validated in the BLE task
+uint32_t g_pendingSettingsMillis = 0;  // When it arrived, for its clock
+// Release/acquire hands the struct over between the cores: the flag is
+// only seen set once the copy above is complete
+std::atomic<bool> g_hasPendingSettings(false);
+std::atomic<bool> g_logRequested(false); // MSG_LOG_REQUEST, sent by the loop
+// Earliest clock a phone may set (2024-01-01); older means a broken clock
+const uint32_t MIN_PHONE_EPOCH = 1704067200;
+// The calculation method or zone changed: the cached days are stale until
+// the current month is refetched. Survives deep sleep until then.
+RTC_DATA_ATTR bool g_calendarStale = false;
+const unsigned long SETTINGS_WINDOW_IDLE_MS = 60UL * 1000UL;
+const unsigned long SETTINGS_WINDOW_MAX_MS = 5UL * 60UL * 1000UL;
+const unsigned long TELEMETRY_INTERVAL_MS = 2000; // While the window is open
+
+void handleSleeping(bool redrawStatusBar = true);
 
 //--------------------------------------------------------------------------
 bool shouldFetchBasedOnInterval(unsigned long lastUpdateSeconds,
@@ -82,7 +133,7 @@ bool shouldFetchBasedOnInterval(unsigned long lastUpdateSeconds,
                                 const char *label = nullptr) {
   time_t now = RTCManager::getInstance().getEpochTime();
   if (now < 100000) {
-    Serial.println("⚠️ Skipping fetch: RTC not synced yet.");
+    LOG_W("⚠️ Skipping fetch: RTC not synced yet.");
     return false;
   }
 
@@ -92,7 +143,7 @@ bool shouldFetchBasedOnInterval(unsigned long lastUpdateSeconds,
 
   if (lastUpdateSeconds == 0) {
     if (label)
-      Serial.printf("🆕 [%s] No previous update. Should fetch.\n", label);
+      LOG_I("🆕 [%s] No previous update. Should fetch.", label);
     return true;
   }
 
@@ -100,33 +151,25 @@ bool shouldFetchBasedOnInterval(unsigned long lastUpdateSeconds,
 
   if (elapsed >= intervalSeconds) {
     if (label) {
-      Serial.printf("⏱️ [%s] It's been %lu seconds. Fetching now...\n", label,
-                    elapsed);
+      LOG_I("⏱️ [%s] It's been %lu seconds. Fetching now...", label,
+            elapsed);
     }
     return true;
   } else {
     if (label) {
       unsigned long remaining =
           intervalSeconds > elapsed ? intervalSeconds - elapsed : 0;
-      unsigned long elapsedH = elapsed / 3600;
-      unsigned long elapsedM = (elapsed % 3600) / 60;
-      unsigned long remainingH = remaining / 3600;
-      unsigned long remainingM = (remaining % 3600) / 60;
-      Serial.printf(
-          "🕰️ [%s] Only %luh %lum elapsed. Next fetch in %luh %lum.\n", label,
-          elapsedH, elapsedM, remainingH, remainingM);
+      LOG_D("🕰️ [%s] Only %lum elapsed. Next fetch in %lum.", label,
+            elapsed / 60, remaining / 60);
     }
     return false;
   }
 }
 
-Countdown calculateCountdownToNextPrayer(const String &nextPrayer,
+Countdown calculateCountdownToNextPrayer(uint16_t nextPrayerMinutes,
                                          const struct tm &now) {
   int currentSeconds = now.tm_hour * 3600 + now.tm_min * 60 + now.tm_sec;
-
-  int prayerHour = nextPrayer.substring(0, 2).toInt();
-  int prayerMin = nextPrayer.substring(3, 5).toInt();
-  int prayerSeconds = prayerHour * 3600 + prayerMin * 60;
+  int prayerSeconds = nextPrayerMinutes * 60;
 
   int diffSeconds = prayerSeconds - currentSeconds;
   if (diffSeconds < 0) {
@@ -150,220 +193,203 @@ Countdown calculateCountdownToNextPrayer(const String &nextPrayer,
   return result;
 }
 
-bool isLaterThan(int hour, int minute, const String &timeStr) {
-  int h = timeStr.substring(0, 2).toInt();
-  int m = timeStr.substring(3, 5).toInt();
+// Location shown on screen, the same on the full and the countdown-only
+// path: the city name, or the coordinates when there is none or it is
+// mostly in a script the fonts cannot draw
+String locationLabel() {
+  String displayName = String(rtcData.cityName);
 
-  if (h > hour)
-    return true;
-  if (h == hour && m > minute)
-    return true;
-  return false;
+  // Count displayable characters (Latin script + numbers + punctuation)
+  int displayableCount = 0;
+  int totalCount = displayName.length();
+
+  for (int i = 0; i < totalCount; i++) {
+    unsigned char c = displayName[i];
+    // Accept: A-Z, a-z, 0-9, space, comma, period, dash, apostrophe,
+    // extended ASCII (128-255) for accented letters (é, ñ, etc.)
+    // and degree symbol (176/°)
+    if ((c >= 32 && c <= 126) ||  // Standard ASCII printable
+        (c >= 128 && c <= 255)) {  // Extended ASCII (accented letters)
+      displayableCount++;
+    }
+  }
+
+  // Empty, or under 50% displayable (likely non-Latin script): coordinates
+  if (totalCount == 0 || displayableCount < (totalCount * 0.5)) {
+    displayName = String(rtcData.latitude, 2) + "°, " +
+                  String(rtcData.longitude, 2) + "°";
+    LOG_D("📝 Using coordinates as location name");
+  } else {
+    LOG_D("📝 Using location name: %s", displayName.c_str());
+  }
+  return displayName;
 }
 
 void executeMainTask() {
-  setCpuFrequencyMhz(80);  // TEST: Lower frequency to save power
-  Serial.printf("⚙️ CPU now running at: %d MHz\n", getCpuFrequencyMhz());
+  WakeProfiler::enter(WAKE_PHASE_SCHEDULE); // Also sets the CPU clock
+  g_renderState.renderPlanUntil = 0; // Set again once this frame is drawn
+  LOG_D("⚙️ CPU now running at: %d MHz", getCpuFrequencyMhz());
   
   // Ensure timezone is configured before any time operations
   // This is the single "before all" hook for rendering
-  configTime(rtcData.timezoneOffsetSeconds, 0, nullptr, nullptr);
+  TimezoneRules::apply();
   
   unsigned long startTime = millis();
 
-  // Use city name from RTC memory instead of mosque name
-  String displayLocationName = String(rtcData.cityName);
-  if (displayLocationName.isEmpty()) {
-    // Fallback to coordinates if no city name
-    displayLocationName = String(rtcData.latitude, 2) + "°, " + String(rtcData.longitude, 2) + "°";
+  g_wakeTime = TimeSnapshot::now();
+  if (!g_wakeTime.valid) {
+    LOG_E("❌ Failed to get time (RTC not set).");
+    return;
   }
-  Serial.printf("📍 Location: %s\n", displayLocationName.c_str());
+  const struct tm &timeinfo = g_wakeTime.local;
 
-  struct tm timeinfo;
-  if (!getLocalTime(&timeinfo)) {
-    Serial.println("❌ Failed to get time.");
-    return;
+  // The clock jumps at a DST switch; redraw everything once
+  if (TimezoneRules::checkTransition(g_wakeTime.epoch)) {
+    LOG_I("🕐 DST transition - now %s",
+          timeinfo.tm_isdst > 0 ? "summer time" : "standard time");
+    g_renderState.initialized = false;
   }
 
   int currentSecond = timeinfo.tm_sec;
-  Serial.printf("🕒 %02d:%02d:%02d  📅 %02d/%02d/%04d\n", timeinfo.tm_hour,
-                timeinfo.tm_min, currentSecond, timeinfo.tm_mday,
-                timeinfo.tm_mon + 1, timeinfo.tm_year + 1900);
+  LOG_I("🕒 %02d:%02d:%02d", timeinfo.tm_hour, timeinfo.tm_min,
+        currentSecond);
+  LOG_D("📅 %02d/%02d/%04d", timeinfo.tm_mday, timeinfo.tm_mon + 1,
+        timeinfo.tm_year + 1900);
 
   TodayAndNextDayPrayerTimes todayAndNextDayPrayerTimes =
-      calendarManager.fetchTodayAndNextDayPrayerTimes(timeinfo.tm_mon + 1,
-                                                      timeinfo.tm_mday);
-
-  std::vector<String> todayPrayer = todayAndNextDayPrayerTimes.todayPrayerTimes;
-  std::vector<String> todayIqama = todayAndNextDayPrayerTimes.todayIqamaTimes;
-  std::vector<String> nextDayPrayer =
-      todayAndNextDayPrayerTimes.nextDayPrayerTimes;
-  std::vector<String> nextDayIqama =
-      todayAndNextDayPrayerTimes.nextDayIqamaTimes;
+      calendarManager.fetchTodayAndNextDayPrayerTimes(
+          timeinfo.tm_year + 1900, timeinfo.tm_mon + 1, timeinfo.tm_mday,
+          timeinfo.tm_wday);
 
-  bool isShowNextDayPrayers = false;
-  struct NextPrayerInfo {
-    String time;
-    String name;
-  } nextPrayerInfo;
-
-  if (todayPrayer.empty() || todayIqama.empty() || nextDayPrayer.empty() ||
-      nextDayIqama.empty()) {
-    Serial.println("❌ Missing prayer times or iqama times!");
+  if (!todayAndNextDayPrayerTimes.isValid()) {
+    LOG_E("❌ Missing prayer times or iqama times!");
     return;
   }
 
-  for (size_t i = 0; i < todayPrayer.size(); ++i) {
-    if (isLaterThan(timeinfo.tm_hour, timeinfo.tm_min, todayPrayer[i])) {
-      nextPrayerInfo.time = todayPrayer[i];
-      nextPrayerInfo.name = PRAYER_NAMES[i];
-      break;
-    }
+  // Next prayer today, or tomorrow's Fajr once Isha has passed
+  // Weather for this hour comes from the stored forecast; it lives in the
+  // header, which only a full render redraws. Past the fetched forecast an
+  // uploaded calendar's snapshot for the day stands in.
+  int8_t snapshotTemp;
+  uint8_t snapshotCode;
+  if (WeatherManager::hoursRemaining(g_wakeTime.epoch) == 0 &&
+      CalendarManager::uploadedWeather(timeinfo.tm_year + 1900,
+                                       timeinfo.tm_mon + 1, timeinfo.tm_mday,
+                                       snapshotTemp, snapshotCode)) {
+    const time_t dayStart = g_wakeTime.epoch - timeinfo.tm_hour * 3600 -
+                            timeinfo.tm_min * 60 - timeinfo.tm_sec;
+    WeatherManager::useDaySnapshot(dayStart, snapshotTemp, snapshotCode);
+  }
+  if (WeatherManager::applyForecast(g_wakeTime.epoch)) {
+    LOG_D("🌤️ Forecast hour changed the shown weather");
+    g_renderState.initialized = false;
   }
 
-  if (nextPrayerInfo.time.isEmpty() || nextPrayerInfo.name.isEmpty()) {
-    nextPrayerInfo.time = nextDayPrayer[0];
-    nextPrayerInfo.name = PRAYER_NAMES[0];
+  const uint16_t nowMinutes = g_wakeTime.minutes();
+  bool isShowNextDayPrayers = false;
+  int nextPrayerIndex =
+      todayAndNextDayPrayerTimes.today.nextPrayerIndex(nowMinutes);
+  if (nextPrayerIndex < 0) {
+    nextPrayerIndex = DaySchedule::FAJR;
     isShowNextDayPrayers = true;
   }
 
-  if (nextPrayerInfo.time.isEmpty() || nextPrayerInfo.name.isEmpty()) {
-    Serial.println("❌ No next prayer found!");
-    return;
-  }
+  const DaySchedule &schedule = isShowNextDayPrayers
+                                    ? todayAndNextDayPrayerTimes.nextDay
+                                    : todayAndNextDayPrayerTimes.today;
+  const uint16_t nextPrayerMinutes = schedule.prayers[nextPrayerIndex];
+  const char *nextPrayerName = PRAYER_NAMES[nextPrayerIndex];
 
-  String FAJR, SUNRISE, DHUHR, ASR, MAGHRIB, ISHA;
-  String IQAMA_Fajr, IQAMA_Dhuhr, IQAMA_Asr, IQAMA_Maghrib, IQAMA_Isha;
-
-  if (isShowNextDayPrayers) {
-    FAJR = nextDayPrayer[0];
-    SUNRISE = nextDayPrayer[1];
-    DHUHR = nextDayPrayer[2];
-    ASR = nextDayPrayer[3];
-    MAGHRIB = nextDayPrayer[4];
-    ISHA = nextDayPrayer[5];
-    IQAMA_Fajr = nextDayIqama[0];
-    IQAMA_Dhuhr = nextDayIqama[1];
-    IQAMA_Asr = nextDayIqama[2];
-    IQAMA_Maghrib = nextDayIqama[3];
-    IQAMA_Isha = nextDayIqama[4];
-  } else {
-    FAJR = todayPrayer[0];
-    SUNRISE = todayPrayer[1];
-    DHUHR = todayPrayer[2];
-    ASR = todayPrayer[3];
-    MAGHRIB = todayPrayer[4];
-    ISHA = todayPrayer[5];
-    IQAMA_Fajr = todayIqama[0];
-    IQAMA_Dhuhr = todayIqama[1];
-    IQAMA_Asr = todayIqama[2];
-    IQAMA_Maghrib = todayIqama[3];
-    IQAMA_Isha = todayIqama[4];
-  }
-
-  Countdown countdown = calculateCountdownToNextPrayer(nextPrayerInfo.time, timeinfo);
+  Countdown countdown = calculateCountdownToNextPrayer(nextPrayerMinutes, timeinfo);
   char countdownStr[16];
   sprintf(countdownStr, "%02d:%02d", countdown.hours, countdown.minutes);
 
-  String title = String("✨══════•••••• Prayer times for ") +
-                 (isShowNextDayPrayers ? "tomorrow" : "today") +
-                 " ••••••══════✨";
-
-  Serial.println(title.c_str());
-  Serial.printf("  ⏰ %s  %s\n", FAJR.c_str(), IQAMA_Fajr.c_str());
-  Serial.printf("  🌅 %s\n", SUNRISE.c_str());
-  Serial.printf("  ⏰ %s  %s\n", DHUHR.c_str(), IQAMA_Dhuhr.c_str());
-  Serial.printf("  ⏰ %s  %s\n", ASR.c_str(), IQAMA_Asr.c_str());
-  Serial.printf("  ⏰ %s  %s\n", MAGHRIB.c_str(), IQAMA_Maghrib.c_str());
-  Serial.printf("  ⏰ %s  %s\n", ISHA.c_str(), IQAMA_Isha.c_str());
-  Serial.printf("  ⏳%s in %02d:%02d\n", nextPrayerInfo.name.c_str(),
-                countdown.hours, countdown.minutes);
-  Serial.println("✨══════•••••••••••••••••••••••••••••••••══════✨");
+  LOG_D("✨══════•••••• Prayer times for %s ••••••══════✨",
+        isShowNextDayPrayers ? "tomorrow" : "today");
+  for (uint8_t i = 0; i < DaySchedule::PRAYER_COUNT; ++i) {
+    char prayerStr[6];
+    DaySchedule::formatHHMM(schedule.prayers[i], prayerStr);
+    if (i == DaySchedule::SUNRISE) {
+      LOG_D("  🌅 %s", prayerStr);
+      continue;
+    }
+    char iqamaStr[6];
+    DaySchedule::formatHHMM(schedule.iqamas[i == 0 ? 0 : i - 1], iqamaStr);
+    LOG_D("  ⏰ %s  %s", prayerStr, iqamaStr);
+  }
+  LOG_I("  ⏳%s in %02d:%02d", nextPrayerName, countdown.hours,
+        countdown.minutes);
+  LOG_D("✨══════•••••••••••••••••••••••••••••••••══════✨");
 
   // ---------- E-paper display with status bar ----------
-  const char *PRAYER_NAMES_ROW[5] = {"Fajr", "Dhuhr", "Asr", "Maghrib", "Isha"};
-  const char *prayerTimesRow[5] = {FAJR.c_str(), DHUHR.c_str(), ASR.c_str(),
-                                   MAGHRIB.c_str(), ISHA.c_str()};
-
-  // NEW: Create iqama times array (Note: No Sunrise iqama, so we skip index 1)
-  const char *iqamaTimesRow[5] = {IQAMA_Fajr.c_str(), IQAMA_Dhuhr.c_str(),
-                                  IQAMA_Asr.c_str(), IQAMA_Maghrib.c_str(),
-                                  IQAMA_Isha.c_str()};
-
+  WakeProfiler::enter(WAKE_PHASE_RENDER);
   GxEPD2Adapter<decltype(display)> epdAdapter(display);
   ScreenUI ui(epdAdapter, /*screenW*/ 800, /*screenH*/ 480);
   ScreenLayout L = ui.computeLayout();
 
   int highlightIndex = ScreenUI::getNextPrayerIndex(
-      prayerTimesRow, timeinfo.tm_hour, timeinfo.tm_min);
-
-  // Calculate current awake time to include in display
-  unsigned long currentAwakeSeconds = rtcData.cumulativeAwakeSeconds;
-  if (rtcData.wakeStartMillis > 0) {
-    currentAwakeSeconds += (millis() - rtcData.wakeStartMillis) / 1000;
-  }
-
-  // Get status information (with awake time counter and cycles)
-  StatusInfo statusInfo = StatusBar::getStatusInfo(g_bleAdvertising, currentAwakeSeconds, rtcData.wakeCycleCount);
+      schedule, timeinfo.tm_hour, timeinfo.tm_min);
 
-  // Use city name instead of mosque name
-  String displayName = displayLocationName;
-
-  // Count displayable characters (Latin script + numbers + punctuation)
-  int displayableCount = 0;
-  int totalCount = displayName.length();
-
-  for (int i = 0; i < totalCount; i++) {
-    unsigned char c = displayName[i];
-    // Accept: A-Z, a-z, 0-9, space, comma, period, dash, apostrophe, 
-    // extended ASCII (128-255) for accented letters (é, ñ, etc.)
-    // and degree symbol (176/°)
-    if ((c >= 32 && c <= 126) ||  // Standard ASCII printable
-        (c >= 128 && c <= 255)) {  // Extended ASCII (accented letters)
-      displayableCount++;
-    }
-  }
-
-  // If less than 50% of characters are displayable, it's likely non-Latin script
-  if (totalCount == 0 || displayableCount < (totalCount * 0.5)) {
-    displayName = String(rtcData.latitude, 2) + "°, " + String(rtcData.longitude, 2) + "°";
-    Serial.println("📝 Using coordinates as location name (non-Latin script not displayable)");
-  } else {
-    Serial.printf("📝 Using location name: %s\n", displayName.c_str());
-  }
+  StatusInfo statusInfo =
+      StatusBar::getStatusInfo(g_wakeTime, g_bleAdvertising);
 
+  const String displayName = locationLabel();
   const char *LOCATION_NAME = displayName.c_str();
 
   if (!g_renderState.initialized) {
     // First time: Full render
     ui.fullRenderWithStatusBar(L, LOCATION_NAME, countdownStr, PRAYER_NAMES_ROW,
-                               prayerTimesRow, iqamaTimesRow, highlightIndex,
-                               statusInfo);
+                               schedule, highlightIndex, statusInfo,
+                               g_wakeTime);
+    Telemetry::countRefresh(true);
   } else if (g_renderState.lastHighlight != highlightIndex) {
     // Prayer changed: Do full refresh
-    Serial.println("🔄 Prayer changed - doing full refresh");
+    LOG_I("🔄 Prayer changed - doing full refresh");
     ui.fullRenderWithStatusBar(L, LOCATION_NAME, countdownStr, PRAYER_NAMES_ROW,
-                               prayerTimesRow, iqamaTimesRow, highlightIndex,
-                               statusInfo);
+                               schedule, highlightIndex, statusInfo,
+                               g_wakeTime);
+    Telemetry::countRefresh(true);
   } else {
     // Same prayer: Only update countdown and status bar (minimal partial
     // refresh)
-    Serial.println("⏱️ Same prayer - only updating countdown");
+    LOG_I("⏱️ Same prayer - only updating countdown");
     ui.partialRenderWithStatusBar(L, LOCATION_NAME, countdownStr,
-                                  PRAYER_NAMES_ROW, prayerTimesRow,
-                                  iqamaTimesRow, highlightIndex, statusInfo);
+                                  PRAYER_NAMES_ROW, schedule, highlightIndex,
+                                  statusInfo, g_wakeTime);
+    Telemetry::countRefresh(false);
   }
 
   // persist (optional)
   g_renderState.initialized = true;
   g_renderState.lastHighlight = highlightIndex;
   for (int i = 0; i < 5; ++i) {
-    snprintf(g_renderState.times[i], sizeof g_renderState.times[i], "%s",
-             prayerTimesRow[i]);
+    g_renderState.times[i] = schedule.rowPrayer(i);
   }
   // Store next prayer time for countdown calculation in sleep handler
-  snprintf(g_renderState.nextPrayerTime, sizeof g_renderState.nextPrayerTime,
-           "%s", nextPrayerInfo.time.c_str());
+  g_renderState.nextPrayerMinutes = nextPrayerMinutes;
+
+  // Until the countdown target passes, midnight (date, Hijri, schedule
+  // cache) or a DST switch, later wakes only need to tick the countdown
+  const time_t midnight = g_wakeTime.epoch - (timeinfo.tm_hour * 3600 +
+                                              timeinfo.tm_min * 60 +
+                                              timeinfo.tm_sec);
+  time_t planUntil = midnight + 24 * 3600;
+  if (!isShowNextDayPrayers) {
+    planUntil = midnight + nextPrayerMinutes * 60;
+  }
+  if (rtcData.nextTzTransition > g_wakeTime.epoch &&
+      rtcData.nextTzTransition < planUntil) {
+    planUntil = rtcData.nextTzTransition;
+  }
+  g_renderState.renderPlanUntil = planUntil;
+
+  // The render at each prayer time plans the adhan of the next one
+  if (nextPrayerIndex != DaySchedule::SUNRISE && AudioManager::hasAdhan()) {
+    AudioManager::schedule(midnight + (isShowNextDayPrayers ? 24 * 3600 : 0) +
+                           nextPrayerMinutes * 60);
+  } else {
+    AudioManager::schedule(0);
+  }
 }
 
 //-------------------------end main execute-------------------------------------
@@ -446,7 +472,6 @@ void fetchPrayerTimesIfDue() {
                   Serial.printf("📂 Valid prayer times file ready at: %s\n",
                                 path);
                   splitCalendarJson(MOSQUE_FILE);
-                  splitCalendarJson(MOSQUE_FILE, true);
                   rtcData.mosqueLastUpdateMillis =
                       RTCManager::getInstance().getEpochTime();
                   AppStateManager::save();
@@ -464,189 +489,345 @@ void fetchPrayerTimesIfDue() {
 // NEW PRAYER TIMES API - Aladhan Implementation
 // ============================================================================
 
+// Fetches months missing from the look-ahead window one by one (Wi-Fi must
+// be up), then calls done. Cheap when coverage is complete: no request.
+void prefetchCalendar(std::function<void()> done) {
+  TimeSnapshot now = TimeSnapshot::now();
+  int year = 0;
+  int month = 0;
+  if (!now.valid || (rtcData.latitude == 0.0 && rtcData.longitude == 0.0) ||
+      CalendarManager::coverageDays(now.local, CALENDAR_COVERAGE_DAYS, &year,
+                                    &month) >= CALENDAR_COVERAGE_DAYS) {
+    done();
+    return;
+  }
+
+  LOG_I("📅 Prefetching prayer times for %d/%d", month, year);
+  rtcData.lastCalendarAttempt = now.epoch;
+  AladhanManager::getInstance().asyncFetchMonthlyPrayerTimes(
+      rtcData.latitude, rtcData.longitude, rtcData.calculationMethod, month,
+      year, rtcData.timezoneName, [done](bool success, const char *path) {
+        if (!success) {
+          LOG_W("⚠️ Prefetch failed (will retry on the next Wi-Fi session)");
+          done();
+          return;
+        }
+        prefetchCalendar(done); // Next gap, if any
+      });
+}
+
+// Downloads the adhan the first time Wi-Fi is up, then calls done
+void downloadAdhanIfMissing(std::function<void()> done) {
+  // A failed download is not repeated on every Wi-Fi session: it costs
+  // megabytes of radio time, so it waits out its own backoff
+  if (!ADHAN_ENABLED || AudioManager::hasAdhan() ||
+      !FetchBackoff::ready(FETCH_ADHAN, time(nullptr))) {
+    done();
+    return;
+  }
+  AudioManager::getInstance().asyncDownloadAdhan([done](bool success) {
+    if (success) {
+      FetchBackoff::success(FETCH_ADHAN);
+    } else {
+      LOG_W("⚠️ Adhan download failed (retried after a backoff)");
+      FetchBackoff::failure(FETCH_ADHAN, time(nullptr));
+    }
+    done();
+  });
+}
+
+// Last step of a Wi-Fi session: weather if due, then render or sleep
+void fetchWeatherIfDue() {
+  if (!shouldFetchBasedOnInterval(rtcData.weatherLastUpdate,
+                                  weatherUpdateInterval, "WEATHER") ||
+      !FetchBackoff::ready(FETCH_WEATHER, time(nullptr))) {
+    state = SLEEPING;
+    return;
+  }
+  LOG_I("🌤️ Also fetching weather (chaining in same session)...");
+  WeatherManager::getInstance().asyncFetchWeather(
+      rtcData.latitude, rtcData.longitude, [](bool success) {
+        if (success) {
+          LOG_I("✅ Weather fetched successfully");
+          FetchBackoff::success(FETCH_WEATHER);
+          g_renderState.initialized = false;
+          state = RUNNING_MAIN_TASK;
+        } else {
+          LOG_W("⚠️ Failed to fetch weather (will retry later)");
+          FetchBackoff::failure(FETCH_WEATHER, time(nullptr));
+          state = SLEEPING;
+        }
+      });
+}
+
 void fetchPrayerTimesFromAladhan() {
-  Serial.println("📡 Fetching prayer times from Aladhan API...");
+  LOG_I("📡 Fetching prayer times from Aladhan API...");
+  rtcData.lastCalendarAttempt = time(nullptr);
 
   // Check if location is configured
   if (rtcData.latitude == 0.0 && rtcData.longitude == 0.0) {
-    Serial.println("⚠️ No location configured. Please configure via BLE first.");
+    LOG_W("⚠️ No location configured. Please configure via BLE first.");
     state = SLEEPING;
     return;
   }
 
-  Serial.printf("📍 Location: %.6f, %.6f (Method: %d)\n", 
-                rtcData.latitude, rtcData.longitude, rtcData.calculationMethod);
+  LOG_I("📍 Location: %.4f, %.4f (Method: %d)", rtcData.latitude,
+        rtcData.longitude, rtcData.calculationMethod);
 
   WiFiManager::getInstance().asyncConnectWithSavedCredentials();
 
   WiFiManager::getInstance().onWifiFailedToConnectCallback([]() {
-    Serial.println("❌ Failed to connect to Wi-Fi to fetch prayer times (will retry in 6 hours)");
+    LOG_E("❌ Failed to connect to Wi-Fi to fetch prayer times (backing off)");
     // Reset retry count to prevent device restart during periodic tasks
     rtcData.wifiRetryCount = 0;
+    FetchBackoff::failure(FETCH_WIFI, time(nullptr));
     AppStateManager::save();
     state = SLEEPING;
   });
 
   WiFiManager::getInstance().onWifiConnectedCallback([]() {
-    Serial.println("✅ Connected to Wi-Fi for Aladhan fetch.");
-    
+    LOG_I("✅ Connected to Wi-Fi for Aladhan fetch.");
+
     // Reset retry count on successful connection during periodic tasks
     rtcData.wifiRetryCount = 0;
+    FetchBackoff::success(FETCH_WIFI);
     AppStateManager::save();
 
     // Get current date for fetching
-    struct tm timeinfo;
-    if (!getLocalTime(&timeinfo)) {
-      Serial.println("❌ Failed to get time for prayer times fetch");
+    TimeSnapshot now = TimeSnapshot::now();
+    if (!now.valid) {
+      LOG_E("❌ Failed to get time for prayer times fetch");
       state = SLEEPING;
       return;
     }
+    const struct tm &timeinfo = now.local;
 
     int currentMonth = timeinfo.tm_mon + 1;
     int currentYear = timeinfo.tm_year + 1900;
 
-    Serial.printf("📅 Fetching prayer times for %d/%d\n", currentMonth, currentYear);
+    LOG_I("📅 Fetching prayer times for %d/%d", currentMonth, currentYear);
 
-    // Fetch current month
+    // Refresh the current month, then fill the look-ahead window and the
+    // weather in the same Wi-Fi session
     AladhanManager::getInstance().asyncFetchMonthlyPrayerTimes(
         rtcData.latitude, rtcData.longitude, rtcData.calculationMethod,
-        currentMonth, currentYear,
+        currentMonth, currentYear, rtcData.timezoneName,
         [currentMonth, currentYear](bool success, const char *path) {
           if (success) {
-            Serial.printf("✅ Prayer times for %d/%d fetched successfully\n",
-                          currentMonth, currentYear);
-            
-            // Files are already split and saved by AladhanManager
-            // No need to call splitCalendarJson
-            
+            LOG_I("✅ Prayer times for %d/%d fetched successfully",
+                  currentMonth, currentYear);
             // Update last fetch time
             rtcData.mosqueLastUpdateMillis =
                 RTCManager::getInstance().getEpochTime();
-            AppStateManager::save();
-
-            // Fetch next month if we're in the last week
-            struct tm timeinfo;
-            if (getLocalTime(&timeinfo) && timeinfo.tm_mday >= 24) {
-              int nextMonth = currentMonth + 1;
-              int nextYear = currentYear;
-              if (nextMonth > 12) {
-                nextMonth = 1;
-                nextYear++;
-              }
-
-              Serial.printf("📅 Also fetching next month: %d/%d\n", nextMonth, nextYear);
-              
-              AladhanManager::getInstance().asyncFetchMonthlyPrayerTimes(
-                  rtcData.latitude, rtcData.longitude, rtcData.calculationMethod,
-                  nextMonth, nextYear,
-                  [nextMonth, nextYear](bool success, const char *path) {
-                    if (success) {
-                      Serial.printf("✅ Prayer times for %d/%d saved\n",
-                                    nextMonth, nextYear);
-                    }
-                    // Check if weather also needs fetching (chain in same WiFi session)
-                    if (shouldFetchBasedOnInterval(rtcData.weatherLastUpdate,
-                                                   weatherUpdateInterval, "WEATHER")) {
-                      Serial.println("🌤️ Also fetching weather (chaining in same session)...");
-                      WeatherManager::getInstance().asyncFetchWeather(
-                          rtcData.latitude, rtcData.longitude, [](bool success) {
-                            if (success) {
-                              Serial.println("✅ Weather fetched successfully");
-                              g_renderState.initialized = false;
-                              state = RUNNING_MAIN_TASK;
-                            } else {
-                              Serial.println("⚠️ Failed to fetch weather (will retry later)");
-                              state = SLEEPING;
-                            }
-                          });
-                    } else {
-                      state = SLEEPING;
-                    }
-                  });
-            } else {
-              // No next month needed, check if weather needs fetching
-              if (shouldFetchBasedOnInterval(rtcData.weatherLastUpdate,
-                                             weatherUpdateInterval, "WEATHER")) {
-                Serial.println("🌤️ Also fetching weather (chaining in same session)...");
-                WeatherManager::getInstance().asyncFetchWeather(
-                    rtcData.latitude, rtcData.longitude, [](bool success) {
-                      if (success) {
-                        Serial.println("✅ Weather fetched successfully");
-                        g_renderState.initialized = false;
-                        state = RUNNING_MAIN_TASK;
-                      } else {
-                        Serial.println("⚠️ Failed to fetch weather (will retry later)");
-                        state = SLEEPING;
-                      }
-                    });
-              } else {
-                state = SLEEPING;
-              }
+            FetchBackoff::success(FETCH_PRAYER);
+            if (g_calendarStale) {
+              CalendarManager::invalidateCache();
+              g_renderState.initialized = false;
+              g_calendarStale = false;
             }
+            AppStateManager::save();
           } else {
-            Serial.println("⚠️ Failed to fetch prayer times from Aladhan");
-            // Still check if weather needs fetching even if prayer times failed
-            if (shouldFetchBasedOnInterval(rtcData.weatherLastUpdate,
-                                           weatherUpdateInterval, "WEATHER")) {
-              Serial.println("🌤️ Fetching weather (prayer times fetch failed)...");
-              WeatherManager::getInstance().asyncFetchWeather(
-                  rtcData.latitude, rtcData.longitude, [](bool success) {
-                    if (success) {
-                      Serial.println("✅ Weather fetched successfully");
-                      g_renderState.initialized = false;
-                      state = RUNNING_MAIN_TASK;
-                    } else {
-                      Serial.println("⚠️ Failed to fetch weather (will retry later)");
-                      state = SLEEPING;
-                    }
-                  });
-            } else {
-              state = SLEEPING;
-            }
+            LOG_W("⚠️ Failed to fetch prayer times from Aladhan");
+            FetchBackoff::failure(FETCH_PRAYER, time(nullptr));
           }
+          prefetchCalendar([]() {
+            downloadAdhanIfMissing([]() { fetchWeatherIfDue(); });
+          });
         });
   });
 }
 
+// Persist the location/timezone/iqama configuration to SPIFFS so it can be
+// restored into RTC memory after a power loss
+void savePrayerConfig() {
+  JsonDocument doc;
+  doc["latitude"] = serialized(String(rtcData.latitude, 6));
+  doc["longitude"] = serialized(String(rtcData.longitude, 6));
+  doc["calculation_method"] = rtcData.calculationMethod;
+  doc["timezone_offset"] = rtcData.timezoneOffsetSeconds;
+  if (rtcData.posixTz[0] != '\0') {
+    doc["posix_tz"] = rtcData.posixTz;
+  }
+  if (rtcData.timezoneName[0] != '\0') {
+    doc["timezone_name"] = rtcData.timezoneName;
+  }
+  if (rtcData.cityName[0] != '\0') {
+    doc["city_name"] = rtcData.cityName;
+  }
+  IqamaRules::toJson(rtcData.iqamaRules, doc["iqama"].to<JsonObject>());
+  doc["hijri_adjustment"] = rtcData.hijriAdjustmentDays;
+  if (rtcData.offlineMode) {
+    doc["offline"] = true;
+  }
+
+  String configJson;
+  serializeJson(doc, configJson);
+  writeJsonFile(PRAYER_CONFIG_FILE, configJson);
+}
+
+// Caps the render plan with the next periodic network task, so a
+// countdown-only wake never skips a fetch or an NTP resync
+void planFastPath() {
+  time_t until = g_renderState.renderPlanUntil;
+  const time_t now = g_wakeTime.epoch;
+  // A source in backoff (or out of radio budget) is not due before then
+  const time_t prayerFetch = FetchBackoff::earliest(
+      FETCH_PRAYER, rtcData.mosqueLastUpdateMillis + mosqueUpdateInterval,
+      now);
+  const time_t weatherFetch = FetchBackoff::earliest(
+      FETCH_WEATHER, rtcData.weatherLastUpdate + weatherUpdateInterval, now);
+  time_t ntpSync = RTCManager::getInstance().nextSyncTime();
+  if (ntpSync != 0)
+    ntpSync = FetchBackoff::earliest(FETCH_NTP, ntpSync, now);
+  const time_t weatherChange = WeatherManager::nextChange(now);
+  if (weatherChange != 0 && weatherChange < until)
+    until = weatherChange;
+  if (rtcData.offlineMode) {
+    g_renderState.fastPathUntil = until; // Nothing is ever fetched
+    return;
+  }
+  if (prayerFetch < until)
+    until = prayerFetch;
+  if (weatherFetch < until)
+    until = weatherFetch;
+  if (ntpSync != 0 && ntpSync < until)
+    until = ntpSync;
+  const time_t calendarRetry = FetchBackoff::earliest(
+      FETCH_PRAYER, rtcData.lastCalendarAttempt + CALENDAR_RETRY_SECONDS, now);
+  if (g_calendarAlarm && calendarRetry < until)
+    until = calendarRetry;
+  g_renderState.fastPathUntil = until;
+}
+
+bool isCountdownOnlyWake(const TimeSnapshot &now) {
+  return now.valid && g_renderState.initialized &&
+         now.epoch < g_renderState.fastPathUntil;
+}
+
+// Minimal wake: no filesystem, no state machine; the panel is brought up
+// only for the countdown/status bar partial refresh, then back to sleep
+void runCountdownTick(const TimeSnapshot &now) {
+  WakeProfiler::setPath(WAKE_PATH_FAST);
+  g_wakeTime = now;
+
+  Countdown countdown =
+      calculateCountdownToNextPrayer(g_renderState.nextPrayerMinutes, now.local);
+  char countdownStr[16];
+  sprintf(countdownStr, "%02d:%02d", countdown.hours, countdown.minutes);
+  LOG_I("⚡ Countdown-only wake (%02d:%02d left)", countdown.hours,
+        countdown.minutes);
+
+  WakeProfiler::enter(WAKE_PHASE_DISPLAY_INIT);
+  display.init(0, false); // No serial diagnostics, no initial full update
+  display.setRotation(0);
+
+  WakeProfiler::enter(WAKE_PHASE_RENDER);
+  GxEPD2Adapter<decltype(display)> epdAdapter(display);
+  ScreenUI ui(epdAdapter, /*screenW*/ 800, /*screenH*/ 480);
+  ScreenLayout L = ui.computeLayout();
+
+  StatusInfo statusInfo = StatusBar::getStatusInfo(now, false);
+  // Partial refresh only touches the countdown and status bar regions
+  const String displayName = locationLabel();
+  ui.partialRenderWithStatusBar(L, displayName.c_str(), countdownStr,
+                                PRAYER_NAMES_ROW, rtcData.today,
+                                g_renderState.lastHighlight, statusInfo, now);
+  Telemetry::countRefresh(false);
+
+  handleSleeping(false); // Status bar was just drawn
+}
+
 void setup() {
+  WakeProfiler::begin();
   Serial.begin(115200);
-  delay(300);
 
   // Check wake cause FIRST - before any other initialization
   esp_sleep_wakeup_cause_t cause = esp_sleep_get_wakeup_cause();
 
   if (cause == ESP_SLEEP_WAKEUP_TIMER) {
-    // Woke from deep sleep timer - fast path
-    Serial.println("\n⏰ Woke from DEEP SLEEP by timer");
+    // Woke from deep sleep timer - no console delay, filesystem and display
+    // are only brought up once we know this wake needs them
+    LOG_D("⏰ Woke from DEEP SLEEP by timer");
+    WakeProfiler::setPath(WAKE_PATH_FULL);
     
-    // Mount SPIFFS (needed for prayer times data)
-    if (!SPIFFS.begin(false)) {
-      Serial.println("❌ SPIFFS mount failed on wake");
+    // Load RTC data (validates magic, schema version and CRC). If the block
+    // was lost or its layout changed, config must come back from SPIFFS, so
+    // fall back to the full boot path.
+    if (!AppStateManager::load()) {
+      LOG_W("⚠️ RTC state reset on wake - running full boot");
+      display.init(115200, false);
+      display.setRotation(0);
+      state = BOOTING;
+      return;
     }
     
-    // Load RTC data (validates magic)
-    AppStateManager::load();
-    
-    // Re-apply timezone offset (lost during deep sleep since it's stored in RAM)
+    // Sleeping out a boot-time Wi-Fi backoff: the clock was never set, so
+    // go through the boot path again to connect and sync
+    if (!RTCManager::getInstance().isTimeSynced()) {
+      LOG_I("🔄 Time never synced - retrying the boot path");
+      display.init(115200, false);
+      display.setRotation(0);
+      state = BOOTING;
+      return;
+    }
+
+    // Re-apply timezone rules (TZ lives in RAM and is lost during deep sleep)
     // RTC time is preserved, but timezone config needs to be re-applied
-    configTime(rtcData.timezoneOffsetSeconds, 0, nullptr, nullptr);
-    Serial.printf("🌍 Timezone restored: UTC%+d\n", rtcData.timezoneOffsetSeconds / 3600);
+    TimezoneRules::apply();
+    LOG_I("🌍 Timezone restored: %s", TimezoneRules::current());
+
+    // Remove the RTC slow clock drift accumulated during the last sleep
+    RTCManager::getInstance().applyDriftCorrection();
     
     // Update awake tracking
     rtcData.wakeCycleCount++;
     rtcData.wakeStartMillis = millis();
-    Serial.printf("⏰ Wake cycle #%lu started\n", rtcData.wakeCycleCount);
+    Logger::setWakeCycle(rtcData.wakeCycleCount);
+    LOG_D("⏰ Wake cycle #%lu started", rtcData.wakeCycleCount);
+
+    // Minimal wake: the plan saved last time says only the countdown moves
+    WakeProfiler::enter(WAKE_PHASE_SCHEDULE);
+    TimeSnapshot now = TimeSnapshot::now();
+    const bool adhanWake = AudioManager::isDue(now.epoch);
+    if (!adhanWake && isCountdownOnlyWake(now)) {
+      runCountdownTick(now); // Goes straight back to deep sleep
+    }
+    g_renderState.fastPathUntil = 0; // Re-planned at the end of this wake
+
+    // Mount the filesystem (needed for prayer times data). Same helper as a
+    // cold boot: a partition still in SPIFFS is converted, not wiped.
+    WakeProfiler::enter(WAKE_PHASE_FS_MOUNT);
+    if (!setupSPIFFS()) {
+      LOG_E("❌ Filesystem mount failed on wake");
+    }
+
+    // Pre-roll wake: returns once the adhan plays, so the frame below is
+    // drawn for the new prayer while it continues
+    if (adhanWake) {
+      AudioManager::startAdhan();
+    }
     
     // Initialize display without initial full update (skip full refresh on wake)
+    WakeProfiler::enter(WAKE_PHASE_DISPLAY_INIT);
     display.init(115200, false);  // false = no initial full update
     display.setRotation(0);
     
     // Skip full boot, jump to main task
     state = RUNNING_MAIN_TASK;
     return;
-  } else if (cause == ESP_SLEEP_WAKEUP_EXT0) {
+  }
+
+#if LOG_SINK == LOG_SINK_SERIAL
+  delay(300); // Let the USB console attach; not needed for the RTC log ring
+#endif
+  if (cause == ESP_SLEEP_WAKEUP_EXT0) {
     Serial.println("\n🔘 Woke from DEEP SLEEP by BOOT button!");
     Serial.println("💡 Continue normal boot for factory reset handling");
+    // Button wakes are when someone is watching the console: print the
+    // records the timer wakes kept in RTC memory
+    Logger::dump(Serial);
+    // Once the screen is up to date, BLE opens for settings changes
+    g_settingsWindowPending = true;
     // Fall through to normal boot
   } else if (cause != ESP_SLEEP_WAKEUP_UNDEFINED) {
     Serial.printf("\n⏰ Woke from deep sleep (cause=%d)\n", (int)cause);
@@ -667,12 +848,14 @@ void setup() {
 }
 
 void handleBooting() {
-  if (!SPIFFS.begin(true)) {
-    Serial.println("❌ Failed to mount SPIFFS");
+  // The first boot after an update from a SPIFFS firmware converts the
+  // partition and keeps the Wi-Fi and prayer settings
+  if (!setupSPIFFS()) {
+    Serial.println("❌ Failed to mount filesystem");
     state = FETAL_ERROR;
     return;
   }
-  Serial.println("✅ SPIFFS mounted successfully");
+  Serial.println("✅ Filesystem mounted successfully");
   AppStateManager::load();
   
   // Don't start tracking awake time on first boot - only after first sleep
@@ -680,40 +863,53 @@ void handleBooting() {
   Serial.println("⏰ Initial boot - awake time tracking will start after first sleep");
 
   // Restore configuration from SPIFFS if available
-  if (SPIFFS.exists("/prayer_config.json")) {
-    String configJson = readJsonFile("/prayer_config.json");
-    if (!configJson.isEmpty() && configJson != "{}") {
-      StaticJsonDocument<512> doc;
-      DeserializationError err = deserializeJson(doc, configJson);
-      if (!err) {
-        rtcData.latitude = doc["latitude"] | 0.0;
-        rtcData.longitude = doc["longitude"] | 0.0;
-        rtcData.calculationMethod = doc["calculation_method"] | 4;
-        rtcData.timezoneOffsetSeconds = doc["timezone_offset"] | 0;
-        
-        // Restore city name if available
-        if (doc.containsKey("city_name")) {
-          String cityName = doc["city_name"].as<String>();
-          if (!cityName.isEmpty()) {
-            strncpy(rtcData.cityName, cityName.c_str(), sizeof(rtcData.cityName) - 1);
-            rtcData.cityName[sizeof(rtcData.cityName) - 1] = '\0';
-          }
-        }
-        
-        AppStateManager::save(); // Save restored values to RTC memory
-        
-        int hours = rtcData.timezoneOffsetSeconds / 3600;
-        int minutes = (abs(rtcData.timezoneOffsetSeconds) % 3600) / 60;
-        Serial.println("📦 Configuration restored from SPIFFS:");
-        Serial.printf("   Location: %.6f, %.6f\n", rtcData.latitude, rtcData.longitude);
-        Serial.printf("   Timezone: UTC%+d:%02d (%d seconds)\n", hours, minutes, rtcData.timezoneOffsetSeconds);
-        Serial.printf("   Calculation Method: %d\n", rtcData.calculationMethod);
-        if (rtcData.cityName[0] != '\0') {
-          Serial.printf("   City: %s\n", rtcData.cityName);
+  if (fileExists(PRAYER_CONFIG_FILE)) {
+    JsonDocument doc;
+    if (readJsonFile(PRAYER_CONFIG_FILE, doc)) {
+      rtcData.latitude = doc["latitude"] | 0.0;
+      rtcData.longitude = doc["longitude"] | 0.0;
+      rtcData.calculationMethod = doc["calculation_method"] | 4;
+      rtcData.timezoneOffsetSeconds = doc["timezone_offset"] | 0;
+      strlcpy(rtcData.posixTz, doc["posix_tz"] | "", sizeof(rtcData.posixTz));
+      strlcpy(rtcData.timezoneName, doc["timezone_name"] | "",
+              sizeof(rtcData.timezoneName));
+      rtcData.nextTzTransition = 0; // Re-derived from the restored rules
+      TimezoneRules::apply();
+      
+      // Restore city name if available
+      if (doc.containsKey("city_name")) {
+        String cityName = doc["city_name"].as<String>();
+        if (!cityName.isEmpty()) {
+          strncpy(rtcData.cityName, cityName.c_str(), sizeof(rtcData.cityName) - 1);
+          rtcData.cityName[sizeof(rtcData.cityName) - 1] = '\0';
         }
-      } else {
-        Serial.println("⚠️ Failed to parse prayer_config.json");
       }
+
+      if (!doc["iqama"].isNull() &&
+          !IqamaRules::fromJson(doc["iqama"], rtcData.iqamaRules)) {
+        Serial.println("⚠️ Invalid iqama rules in prayer_config.json");
+      }
+      rtcData.hijriAdjustmentDays =
+          constrain((int)(doc["hijri_adjustment"] | 0), -2, 2);
+      rtcData.hijri.date.month = 0; // Recompute with restored adjustment
+      rtcData.offlineMode = doc["offline"] | false;
+      
+      AppStateManager::save(); // Save restored values to RTC memory
+      
+      int hours = rtcData.timezoneOffsetSeconds / 3600;
+      int minutes = (abs(rtcData.timezoneOffsetSeconds) % 3600) / 60;
+      Serial.println("📦 Configuration restored from SPIFFS:");
+      Serial.printf("   Location: %.6f, %.6f\n", rtcData.latitude, rtcData.longitude);
+      Serial.printf("   Timezone: UTC%+d:%02d (%d seconds)\n", hours, minutes, rtcData.timezoneOffsetSeconds);
+      if (rtcData.posixTz[0] != '\0') {
+        Serial.printf("   TZ rules: %s\n", rtcData.posixTz);
+      }
+      Serial.printf("   Calculation Method: %d\n", rtcData.calculationMethod);
+      if (rtcData.cityName[0] != '\0') {
+        Serial.printf("   City: %s\n", rtcData.cityName);
+      }
+    } else {
+      Serial.println("⚠️ Failed to parse prayer_config.json");
     }
   } else {
     Serial.println("ℹ️ No saved configuration found in SPIFFS");
@@ -764,19 +960,30 @@ void handleBooting() {
       rtcData.bootCount = 0;
       rtcData.mosqueUUID[0] = '\0';
       rtcData.timezoneOffsetSeconds = 0;
+      rtcData.posixTz[0] = '\0';
+      rtcData.timezoneName[0] = '\0';
+      rtcData.nextTzTransition = 0;
       rtcData.latitude = 0.0;
       rtcData.longitude = 0.0;
       rtcData.calculationMethod = 4;
       rtcData.cityName[0] = '\0';
+      rtcData.iqamaRules = IqamaRuleSet();
+      rtcData.hijriAdjustmentDays = 0;
+      rtcData.hijri.date.month = 0;
+      rtcData.offlineMode = false;
+      g_calendarStale = false;
+      CalendarManager::removeStoredMonths(); // Also drops the RTC caches
+      CalendarManager::removeUploadedCalendar();
       AppStateManager::save();
 
       // Delete SPIFFS files
-      if (SPIFFS.exists("/wifi.json"))
-        SPIFFS.remove("/wifi.json");
-      if (SPIFFS.exists("/mosque_config.json"))
-        SPIFFS.remove("/mosque_config.json");
-      if (SPIFFS.exists("/prayer_config.json"))
-        SPIFFS.remove("/prayer_config.json");
+      if (APP_FS.exists("/wifi.json"))
+        APP_FS.remove("/wifi.json");
+      if (APP_FS.exists("/mosque_config.json"))
+        APP_FS.remove("/mosque_config.json");
+      if (APP_FS.exists(PRAYER_CONFIG_FILE))
+        APP_FS.remove(PRAYER_CONFIG_FILE);
+      TlsClient::forgetSessions();
 
       Serial.println("✅ Factory reset complete. Starting BLE setup...");
       state = ADVERTISING_BLE;
@@ -795,6 +1002,12 @@ void handleCheckingTime() {
     state = RUNNING_MAIN_TASK;
   } else {
     Serial.println("❌ Time not synced");
+    if (rtcData.offlineMode) {
+      // No Wi-Fi here; the phone has to set the clock again
+      Serial.println("📴 Offline setup - waiting for the clock over BLE");
+      state = ADVERTISING_BLE;
+      return;
+    }
     // Try to connect with saved credentials first
     state = CONNECTING_WIFI_WITH_SAVED_CREDENTIALS;
   }
@@ -811,6 +1024,7 @@ void handleConnectingWifiWithSavedCredentials() {
     g_bleAdvertising = false; // Clear BLE advertising flag
     // Reset retry counter on successful connection
     rtcData.wifiRetryCount = 0;
+    FetchBackoff::success(FETCH_WIFI);
     AppStateManager::save();
     
     // Check if weather needs to be fetched on boot
@@ -821,9 +1035,11 @@ void handleConnectingWifiWithSavedCredentials() {
           rtcData.latitude, rtcData.longitude, [](bool success) {
             if (success) {
               Serial.println("✅ Weather fetched on boot");
+              FetchBackoff::success(FETCH_WEATHER);
               g_renderState.initialized = false; // Force full refresh
             } else {
               Serial.println("⚠️ Failed to fetch weather on boot (will retry later)");
+              FetchBackoff::failure(FETCH_WEATHER, time(nullptr));
             }
             state = SYNCING_TIME;
           });
@@ -837,8 +1053,8 @@ void handleConnectingWifiWithSavedCredentials() {
     Serial.println("❌ Failed to connect to Wi-Fi (callback triggered)");
 
     // Check if we have any saved credentials at all
-    String wifiJsonString = readJsonFile(WIFI_CRED_FILE);
-    if (wifiJsonString.isEmpty() || wifiJsonString == "{}") {
+    JsonDocument wifiDoc;
+    if (!readJsonFile(WIFI_CRED_FILE, wifiDoc) || wifiDoc.size() == 0) {
       Serial.println("⚠️ No saved WiFi credentials - starting BLE immediately");
       state = ADVERTISING_BLE;
       return;
@@ -846,6 +1062,7 @@ void handleConnectingWifiWithSavedCredentials() {
 
     // If we have credentials but they failed, use retry logic
     rtcData.wifiRetryCount++;
+    FetchBackoff::failure(FETCH_WIFI, time(nullptr));
     AppStateManager::save();
 
     if (rtcData.wifiRetryCount >= MAX_WIFI_RETRIES) {
@@ -856,10 +1073,14 @@ void handleConnectingWifiWithSavedCredentials() {
       AppStateManager::save();
       state = ADVERTISING_BLE;
     } else {
-      Serial.printf("🔄 WiFi retry %d/%d. Restarting device...\n",
-                    rtcData.wifiRetryCount, MAX_WIFI_RETRIES);
-      delay(1000);
-      ESP.restart();
+      // Wait out the backoff in deep sleep instead of restarting right
+      // away; the timer wake runs the boot path again (time never synced)
+      const time_t now = time(nullptr);
+      const time_t retryAt = FetchBackoff::earliest(FETCH_WIFI, now, now);
+      g_minSleepSeconds = retryAt - now > 60 ? (uint32_t)(retryAt - now) : 60;
+      Serial.printf("🔄 WiFi retry %d/%d in %lu s\n", rtcData.wifiRetryCount,
+                    MAX_WIFI_RETRIES, (unsigned long)g_minSleepSeconds);
+      state = SLEEPING;
     }
   });
   
@@ -868,31 +1089,44 @@ void handleConnectingWifiWithSavedCredentials() {
 }
 
 void handleSyncingTime() {
-  Serial.println("🔄 Syncing time...");
-  
+  LOG_I("🔄 Syncing time...");
+
   // Safety check: Ensure timezone is configured
-  if (rtcData.timezoneOffsetSeconds == 0 && (rtcData.latitude == 0.0 || rtcData.longitude == 0.0)) {
-    Serial.println("⚠️ No timezone configured - need to reconfigure via BLE");
+  if (rtcData.timezoneOffsetSeconds == 0 && rtcData.posixTz[0] == '\0' &&
+      (rtcData.latitude == 0.0 || rtcData.longitude == 0.0)) {
+    LOG_W("⚠️ No timezone configured - need to reconfigure via BLE");
     state = ADVERTISING_BLE;
     return;
   }
-  
+
   RTCManager &rtc = RTCManager::getInstance();
-  if (rtc.syncTimeFromNTPWithOffset(3, 10000, rtcData.timezoneOffsetSeconds)) {
-    Serial.println("✅ Time synced successfully");
+  if (rtc.syncTimeFromNTP(3, 10000, TimezoneRules::current())) {
+    LOG_I("✅ Time synced successfully");
+    FetchBackoff::success(FETCH_NTP);
     // rtc.setTimeToSpecificHourAndMinute(20, 07, 5, 2); // for testing time
-    
-    // Disconnect WiFi after time sync to prevent beacon timeout
-    if (WiFi.status() == WL_CONNECTED) {
-      Serial.println("📡 Disconnecting WiFi after time sync");
-      WiFi.disconnect(true);
-      WiFi.mode(WIFI_OFF);
-      delay(100);
-    }
-    
-    state = RUNNING_MAIN_TASK;
+
+    // Top up the calendar (and the adhan) while Wi-Fi is up, then
+    // disconnect to prevent beacon timeout
+    prefetchCalendar([]() {
+      downloadAdhanIfMissing([]() {
+        if (WiFi.status() == WL_CONNECTED) {
+          LOG_I("📡 Disconnecting WiFi after time sync");
+          HttpsSession::close();
+          WiFiManager::radioOff();
+          delay(100);
+        }
+        state = RUNNING_MAIN_TASK;
+      });
+    });
+  } else if (rtc.isTimeSynced()) {
+    // Periodic resync: keep running on the drift-corrected RTC
+    LOG_W("⚠️ NTP resync failed - keeping RTC time");
+    FetchBackoff::failure(FETCH_NTP, time(nullptr));
+    HttpsSession::close();
+    WiFiManager::radioOff();
+    state = SLEEPING;
   } else {
-    Serial.println("❌ Failed to sync time");
+    LOG_E("❌ Failed to sync time");
     state = ADVERTISING_BLE;
   }
 }
@@ -901,8 +1135,8 @@ void handleAdvertisingBLE() {
   Serial.println("🔔 Advertising BLE...");
   
   // Ensure WiFi is completely stopped before starting BLE
-  WiFi.disconnect(true);
-  WiFi.mode(WIFI_OFF);
+  HttpsSession::close();
+  WiFiManager::radioOff();
   delay(100);
 
   // Display initialization message on e-ink screen
@@ -913,12 +1147,264 @@ void handleAdvertisingBLE() {
   BLEManager &ble = BLEManager::getInstance();
   ble.setupBLE();
   g_bleAdvertising = true; // Set BLE advertising flag
+  g_settingsWindowPending = false; // Full provisioning covers it
   ble.onNotificationEnabled([]() {
     Serial.println("🔔 BLE notification enabled");
     state = WAITING_FOR_WIFI_SCAN;
   });
 }
 
+// Provisioning settings as received over BLE (JSON or binary), before
+// validation
+struct ProvisioningRequest {
+  String ssid;
+  String password;
+  String mosqueUuid; // Legacy, kept for backward compatibility
+  String posixTz;
+  String timezoneName;
+  bool hasTimezone = false;
+  bool hasLocation = false;
+  int timezoneOffset = 0;
+  float latitude = 0.0;
+  float longitude = 0.0;
+  int calculationMethod = 4; // Default: Umm Al-Qura (Makkah)
+  int hijriAdjustment = 0;   // Days, -2..+2
+  uint32_t currentTime = 0;  // UTC epoch from the phone, 0 if not sent
+  bool hasIqama = false;
+  bool iqamaValid = true;
+  IqamaRuleSet iqama;
+};
+
+void rejectProvisioning(const char *message, bool showOnScreen = true) {
+  Serial.println(message);
+  if (showOnScreen) {
+    GxEPD2Adapter<decltype(display)> epdAdapter(display);
+    ScreenUI ui(epdAdapter, 800, 480);
+    ui.showInitializationScreenWithError(message);
+  }
+  state = ADVERTISING_BLE;
+}
+
+// Validates the request and stores it in the g_received* globals; moves on to
+// CONNECTING_WIFI, or back to ADVERTISING_BLE if something is missing
+bool acceptProvisioning(const ProvisioningRequest &req) {
+  // No Wi-Fi at all: run from an uploaded calendar on the phone's clock
+  const bool offline = req.ssid.isEmpty() && req.password.isEmpty() &&
+                       req.currentTime != 0 &&
+                       CalendarManager::hasUploadedCalendar();
+  if (!offline && (req.ssid.isEmpty() || req.password.isEmpty())) {
+    rejectProvisioning("⚠️ Incomplete Wi-Fi credentials.", false);
+    return false;
+  }
+
+  // Validate timezone (fixed offset, or POSIX rules with DST)
+  if (!req.hasTimezone) {
+    rejectProvisioning("⚠️ Timezone offset is required but not provided.");
+    return false;
+  }
+
+  // Validate location (latitude and longitude); only used for fetching
+  if (!offline && !req.hasLocation) {
+    rejectProvisioning("⚠️ Location coordinates are required.");
+    return false;
+  }
+
+  // Basic validation
+  if (req.latitude < -90.0 || req.latitude > 90.0 || req.longitude < -180.0 ||
+      req.longitude > 180.0) {
+    rejectProvisioning("⚠️ Invalid location coordinates.");
+    return false;
+  }
+
+  if (!req.posixTz.isEmpty() && !TimezoneRules::isValid(req.posixTz.c_str())) {
+    rejectProvisioning("⚠️ Invalid timezone rules.");
+    return false;
+  }
+
+  if (!AladhanManager::isValidMethod(req.calculationMethod)) {
+    rejectProvisioning("⚠️ Unknown calculation method.");
+    return false;
+  }
+
+  // Optional per-prayer iqama rules, validated before anything is stored
+  if (!req.iqamaValid) {
+    rejectProvisioning("⚠️ Invalid iqama rules.");
+    return false;
+  }
+  g_hasReceivedIqamaRules = req.hasIqama;
+  if (req.hasIqama) {
+    g_receivedIqamaRules = req.iqama;
+  }
+
+  // Store credentials in global variables (defer write operations to avoid
+  // stack overflow)
+  g_receivedSSID = req.ssid;
+  g_receivedPassword = req.password;
+  g_receivedMosqueUUID = req.mosqueUuid; // Kept for backward compatibility
+  g_receivedTimezoneOffset = req.timezoneOffset;
+  g_receivedPosixTz = req.posixTz;
+  g_receivedTimezoneName = req.timezoneName;
+  g_receivedLatitude = req.latitude;
+  g_receivedLongitude = req.longitude;
+  g_receivedCalculationMethod = req.calculationMethod;
+  g_receivedHijriAdjustment = constrain(req.hijriAdjustment, -2, 2);
+  g_receivedCurrentTime = req.currentTime;
+
+  Serial.printf("✅ Received Configuration:\n");
+  Serial.printf("   WiFi: %s\n", offline ? "none (offline)" : req.ssid.c_str());
+  Serial.printf("   Location: %.6f, %.6f\n", req.latitude, req.longitude);
+  Serial.printf("   Timezone: UTC%+d\n", req.timezoneOffset / 3600);
+  if (!req.posixTz.isEmpty()) {
+    Serial.printf("   TZ rules: %s\n", req.posixTz.c_str());
+  }
+  Serial.printf("   Calculation Method: %d\n", req.calculationMethod);
+
+  // Transition to connecting state
+  state = offline ? APPLYING_OFFLINE_SETUP : CONNECTING_WIFI;
+  return true;
+}
+
+void onProvisioningJson(const String &json) {
+  Serial.println("📩 Received JSON over BLE: " + json);
+  StaticJsonDocument<1024> doc;
+  DeserializationError err = deserializeJson(doc, json);
+  if (err) {
+    Serial.println("❌ Invalid JSON format");
+    state = ADVERTISING_BLE;
+    return;
+  }
+
+  ProvisioningRequest req;
+  req.ssid = doc["ssid"].as<String>();
+  req.password = doc["password"].as<String>();
+  req.mosqueUuid = doc["mosque_uuid"].as<String>();
+  req.hasTimezone =
+      doc.containsKey("timezone_offset") || doc.containsKey("posix_tz");
+  req.hasLocation = doc.containsKey("latitude") && doc.containsKey("longitude");
+  req.timezoneOffset = doc["timezone_offset"] | 0;
+  req.posixTz = doc["posix_tz"] | "";
+  req.timezoneName = doc["timezone_name"] | "";
+  req.latitude = doc["latitude"] | 0.0;
+  req.longitude = doc["longitude"] | 0.0;
+  req.calculationMethod = doc["calculation_method"] | 4;
+  req.hijriAdjustment = doc["hijri_adjustment"] | 0;
+  req.currentTime = doc["current_time"] | 0u;
+  if (!doc["iqama"].isNull()) {
+    req.hasIqama = true;
+    req.iqama = rtcData.iqamaRules;
+    req.iqamaValid = IqamaRules::fromJson(doc["iqama"], req.iqama);
+  }
+  acceptProvisioning(req);
+}
+
+// Copies the iqama rules present in a binary config over 'rules'; false if
+// one of them is out of range
+bool mergeIqamaRules(const BleProtocol::Config &config, IqamaRuleSet &rules) {
+  bool valid = true;
+  for (int i = 0; i < BleProtocol::IQAMA_RULES; i++) {
+    if (!(config.iqamaMask & (1 << i))) {
+      continue;
+    }
+    IqamaRule &rule =
+        i < DaySchedule::IQAMA_COUNT ? rules.daily[i] : rules.jumuah;
+    rule.type = config.iqama[i].type;
+    rule.value = config.iqama[i].value;
+    valid = valid && IqamaRules::isValid(rule);
+  }
+  return valid;
+}
+
+// Calendar upload (BleProtocol MSG_UPLOAD_*): every BEGIN and DATA is
+// acknowledged with the bytes stored so far, END with a status
+void onUploadMessage(uint8_t type, const uint8_t *data, size_t length) {
+  BLEManager &ble = BLEManager::getInstance();
+  uint8_t status = BleProtocol::STATUS_UPLOAD_FAILED;
+  const uint32_t id = length >= 4 ? BleProtocol::readU32(data) : 0;
+  uint32_t stored = 0;
+  bool ok = false;
+
+  switch (type) {
+  case BleProtocol::MSG_UPLOAD_BEGIN:
+    ok = length == BleProtocol::UPLOAD_BEGIN_SIZE &&
+         CalendarUpload::begin(id, BleProtocol::readU32(data + 4),
+                               BleProtocol::readU32(data + 8), stored);
+    break;
+  case BleProtocol::MSG_UPLOAD_DATA:
+    ok = length > BleProtocol::UPLOAD_DATA_HEADER &&
+         CalendarUpload::write(id, BleProtocol::readU32(data + 4),
+                               data + BleProtocol::UPLOAD_DATA_HEADER,
+                               length - BleProtocol::UPLOAD_DATA_HEADER,
+                               stored);
+    break;
+  default: { // MSG_UPLOAD_END
+    CalendarUpload::Result result =
+        length == 4 ? CalendarUpload::finish(id) : CalendarUpload::FAILED;
+    if (result == CalendarUpload::INSTALLED) {
+      g_calendarUploaded = true;
+      status = BleProtocol::STATUS_OK;
+    } else if (result == CalendarUpload::BAD_CHECKSUM) {
+      status = BleProtocol::STATUS_BAD_CHECKSUM;
+    }
+    ble.sendMessage(BleProtocol::MSG_STATUS, &status, 1);
+    return;
+  }
+  }
+
+  if (!ok) {
+    ble.sendMessage(BleProtocol::MSG_STATUS, &status, 1);
+    return;
+  }
+  uint8_t ack[BleProtocol::UPLOAD_ACK_SIZE];
+  BleProtocol::writeU32(ack, id);
+  BleProtocol::writeU32(ack + 4, stored);
+  ble.sendMessage(BleProtocol::MSG_UPLOAD_ACK, ack, sizeof(ack));
+}
+
+void onProvisioningMessage(uint8_t type, const uint8_t *data, size_t length) {
+  if (type == BleProtocol::MSG_UPLOAD_BEGIN ||
+      type == BleProtocol::MSG_UPLOAD_DATA ||
+      type == BleProtocol::MSG_UPLOAD_END) {
+    onUploadMessage(type, data, length);
+    return;
+  }
+  if (type != BleProtocol::MSG_CONFIG) {
+    LOG_W("⚠️ Unexpected BLE message type %u", type);
+    return;
+  }
+
+  BleProtocol::Config config;
+  ProvisioningRequest req;
+  bool decoded = BleProtocol::decodeConfig(data, length, config);
+  if (decoded) {
+    req.ssid = config.ssid;
+    req.password = config.password;
+    req.mosqueUuid = config.mosqueUuid;
+    req.posixTz = config.posixTz;
+    req.timezoneName = config.timezoneName;
+    req.hasTimezone = config.hasTimezoneOffset || config.posixTz[0] != '\0';
+    req.hasLocation = config.hasLocation;
+    req.timezoneOffset = config.timezoneOffset;
+    req.latitude = config.latitudeE7 / 1e7;
+    req.longitude = config.longitudeE7 / 1e7;
+    req.calculationMethod = config.method;
+    req.hijriAdjustment = config.hijriAdjust;
+    req.currentTime = config.currentTime;
+    if (config.iqamaMask != 0) {
+      req.hasIqama = true;
+      req.iqama = rtcData.iqamaRules;
+      req.iqamaValid = mergeIqamaRules(config, req.iqama);
+    }
+  }
+
+  uint8_t status = BleProtocol::STATUS_BAD_CONFIG;
+  if (!decoded) {
+    rejectProvisioning("⚠️ Malformed configuration message.", false);
+  } else if (acceptProvisioning(req)) {
+    status = BleProtocol::STATUS_OK;
+  }
+  BLEManager::getInstance().sendMessage(BleProtocol::MSG_STATUS, &status, 1);
+}
+
 void handleWaitingForWifiScan() {
   Serial.println("🔄 Waiting for Wi-Fi scan...");
   
@@ -932,6 +1418,7 @@ void handleWaitingForWifiScan() {
   wifi.setScanResultCallback([](const std::vector<ScanResult> &results) {
     Serial.println("📋 Wi-Fi scan results:");
     String json = "[";
+    std::vector<BleProtocol::ScanEntry> entries(results.size());
     for (size_t i = 0; i < results.size(); ++i) {
       const auto &net = results[i];
       String displaySSID = net.ssid.substring(0, 25);
@@ -946,99 +1433,296 @@ void handleWaitingForWifiScan() {
       if (i < results.size() - 1) {
         json += ",";
       }
+
+      strlcpy(entries[i].ssid, net.ssid.c_str(), sizeof(entries[i].ssid));
+      entries[i].rssi = constrain(net.rssi, -128, 0);
+      entries[i].secured = net.secured;
     }
     json += "]";
-    BLEManager::getInstance().onNotificationEnabled(
-        []() { handleWaitingForWifiScan(); });
-    BLEManager::getInstance().sendBLEData(json);
-    BLEManager::getInstance().onJsonReceived([](const String &json) {
-      Serial.println("📩 Received JSON over BLE: " + json);
-      StaticJsonDocument<512> doc;
-      DeserializationError err = deserializeJson(doc, json);
-      if (err) {
-        Serial.println("❌ Invalid JSON format");
-        state = ADVERTISING_BLE;
-        return;
-      }
 
-      String ssid = doc["ssid"].as<String>();
-      String password = doc["password"].as<String>();
-      
-      // Legacy: mosque UUID (kept for backward compatibility but not used)
-      String mosqueUuid = doc["mosque_uuid"].as<String>();
+    // Strongest first, so a full message only drops the weakest networks
+    std::sort(entries.begin(), entries.end(),
+              [](const BleProtocol::ScanEntry &a,
+                 const BleProtocol::ScanEntry &b) { return a.rssi > b.rssi; });
+    static uint8_t scanMessage[BleProtocol::MAX_MESSAGE_SIZE];
+    size_t scanLength = BleProtocol::encodeScanResults(
+        entries.data(), entries.size(), scanMessage, sizeof(scanMessage));
+
+    BLEManager &ble = BLEManager::getInstance();
+    ble.onNotificationEnabled([]() { handleWaitingForWifiScan(); });
+    ble.onJsonReceived(onProvisioningJson);
+    ble.onMessage(onProvisioningMessage);
+    ble.sendBLEData(json);
+    ble.sendMessage(BleProtocol::MSG_SCAN_RESULTS, scanMessage, scanLength);
+  });
+}
 
-      if (ssid.isEmpty() || password.isEmpty()) {
-        Serial.println("⚠️ Incomplete Wi-Fi credentials.");
-        state = ADVERTISING_BLE;
-        return;
-      }
+void handleUseWifiInput() {
+  Serial.println("🔄 Waiting for user Wi-Fi input...");
+  BLEManager &ble = BLEManager::getInstance();
+}
 
-      // Validate timezone offset
-      if (!doc.containsKey("timezone_offset")) {
-        Serial.println("⚠️ Timezone offset is required but not provided.");
-        
-        GxEPD2Adapter<decltype(display)> epdAdapter(display);
-        ScreenUI ui(epdAdapter, 800, 480);
-        ui.showInitializationScreenWithError("⚠️ Timezone offset is required but not provided.");
-        
-        state = ADVERTISING_BLE;
-        return;
-      }
+// Moves the settings received over BLE (except location and city) into RTC
+// memory and prayer_config.json
+void storeReceivedConfig() {
+  // Save iqama rules; cached schedule must be re-evaluated
+  if (g_hasReceivedIqamaRules) {
+    rtcData.iqamaRules = g_receivedIqamaRules;
+    rtcData.day = 0;
+  }
 
-      // Validate location (latitude and longitude)
-      if (!doc.containsKey("latitude") || !doc.containsKey("longitude")) {
-        Serial.println("⚠️ Location (latitude/longitude) is required but not provided.");
-        
-        GxEPD2Adapter<decltype(display)> epdAdapter(display);
-        ScreenUI ui(epdAdapter, 800, 480);
-        ui.showInitializationScreenWithError("⚠️ Location coordinates are required.");
-        
-        state = ADVERTISING_BLE;
-        return;
-      }
+  // Hijri correction; forces the cached Hijri date to be recomputed
+  rtcData.hijriAdjustmentDays = g_receivedHijriAdjustment;
+  rtcData.hijri.date.month = 0;
+
+  // Save timezone offset to RTC memory
+  rtcData.timezoneOffsetSeconds = g_receivedTimezoneOffset;
+  int hours = g_receivedTimezoneOffset / 3600;
+  int minutes = (abs(g_receivedTimezoneOffset) % 3600) / 60;
+  Serial.printf("💾 Timezone offset saved: UTC%+d:%02d (%d seconds)\n",
+                hours, minutes, g_receivedTimezoneOffset);
+  strlcpy(rtcData.posixTz, g_receivedPosixTz.c_str(), sizeof(rtcData.posixTz));
+  strlcpy(rtcData.timezoneName, g_receivedTimezoneName.c_str(),
+          sizeof(rtcData.timezoneName));
+  rtcData.nextTzTransition = 0;
+  TimezoneRules::apply();
+
+  // Legacy: Save mosque UUID if provided (for backward compatibility)
+  if (!g_receivedMosqueUUID.isEmpty()) {
+    strncpy(rtcData.mosqueUUID, g_receivedMosqueUUID.c_str(),
+            sizeof(rtcData.mosqueUUID) - 1);
+    rtcData.mosqueUUID[sizeof(rtcData.mosqueUUID) - 1] = '\0';
+    Serial.printf("💾 Legacy mosque UUID saved: %s\n", rtcData.mosqueUUID);
+  }
 
-      int timezoneOffset = doc["timezone_offset"] | 0;
-      float latitude = doc["latitude"] | 0.0;
-      float longitude = doc["longitude"] | 0.0;
-      int calculationMethod = doc["calculation_method"] | 4; // Default: Umm Al-Qura (Makkah)
-
-      // Basic validation
-      if (latitude < -90.0 || latitude > 90.0 || longitude < -180.0 || longitude > 180.0) {
-        Serial.println("⚠️ Invalid location coordinates.");
-        
-        GxEPD2Adapter<decltype(display)> epdAdapter(display);
-        ScreenUI ui(epdAdapter, 800, 480);
-        ui.showInitializationScreenWithError("⚠️ Invalid location coordinates.");
-        
-        state = ADVERTISING_BLE;
-        return;
-      }
+  // Persist to RTC memory
+  AppStateManager::save();
 
-      // Store credentials in global variables (defer write operations to avoid
-      // stack overflow)
-      g_receivedSSID = ssid;
-      g_receivedPassword = password;
-      g_receivedMosqueUUID = mosqueUuid; // Kept for backward compatibility
-      g_receivedTimezoneOffset = timezoneOffset;
-      g_receivedLatitude = latitude;
-      g_receivedLongitude = longitude;
-      g_receivedCalculationMethod = calculationMethod;
-
-      Serial.printf("✅ Received Configuration:\n");
-      Serial.printf("   WiFi: %s\n", ssid.c_str());
-      Serial.printf("   Location: %.6f, %.6f\n", latitude, longitude);
-      Serial.printf("   Timezone: UTC%+d\n", timezoneOffset / 3600);
-      Serial.printf("   Calculation Method: %d\n", calculationMethod);
-
-      // Transition to connecting state
-      state = CONNECTING_WIFI;
-    });
-  });
+  // Also save to SPIFFS for backup
+  savePrayerConfig();
+  Serial.println("💾 Configuration saved to SPIFFS");
 }
 
-void handleUseWifiInput() {
-  Serial.println("🔄 Waiting for user Wi-Fi input...");
+void handleApplyingOfflineSetup() {
+  Serial.println("📴 Applying offline setup (uploaded calendar, no Wi-Fi)...");
+  rtcData.latitude = g_receivedLatitude;
+  rtcData.longitude = g_receivedLongitude;
+  rtcData.calculationMethod = g_receivedCalculationMethod;
+  rtcData.cityName[0] = '\0';
+  rtcData.offlineMode = true;
+  storeReceivedConfig();
+
+  // The phone's clock stands in for NTP; it is set again over BLE if the
+  // device ever loses power, and through the settings window to correct
+  // drift
+  RTCManager::getInstance().syncTimeFromPhone(g_receivedCurrentTime);
+  RTCManager::getInstance().printTime();
+
+  BLEManager::getInstance().stopAdvertising();
+  g_bleAdvertising = false;
+  g_renderState.initialized = false;
+  state = RUNNING_MAIN_TASK;
+}
+
+// Runs in the BLE task: decode and validate only, the loop applies the
+// settings and answers with the status
+void onSettingsMessage(uint8_t type, const uint8_t *data, size_t length) {
+  if (type == BleProtocol::MSG_LOG_REQUEST) {
+    g_logRequested.store(true, std::memory_order_release);
+    return;
+  }
+  if (type != BleProtocol::MSG_SETTINGS) {
+    LOG_W("⚠️ BLE message 0x%02x ignored in the settings window", type);
+    return;
+  }
+  BleProtocol::Config settings;
+  IqamaRuleSet iqama;
+  uint8_t status = BleProtocol::STATUS_BAD_CONFIG;
+  if (!BleProtocol::decodeConfig(data, length, settings)) {
+    LOG_W("⚠️ Malformed settings message");
+  } else if ((settings.posixTz[0] != '\0' &&
+              !TimezoneRules::isValid(settings.posixTz)) ||
+             (settings.hasMethod &&
+              !AladhanManager::isValidMethod(settings.method)) ||
+             (settings.hasHijriAdjust &&
+              (settings.hijriAdjust < -2 || settings.hijriAdjust > 2)) ||
+             (settings.currentTime != 0 &&
+              settings.currentTime < MIN_PHONE_EPOCH) ||
+             !mergeIqamaRules(settings, iqama)) {
+    LOG_W("⚠️ Settings rejected by validation");
+  } else if (g_hasPendingSettings.load(std::memory_order_acquire)) {
+    status = BleProtocol::STATUS_BUSY;
+  } else {
+    g_pendingSettings = settings;
+    g_pendingSettingsMillis = millis();
+    g_hasPendingSettings.store(true, std::memory_order_release);
+    return;
+  }
+  BLEManager::getInstance().sendMessage(BleProtocol::MSG_STATUS, &status, 1);
+}
+
+// Stores the settings present in 'settings' and drops only the caches they
+// affect. True if the month files have to be fetched again.
+bool applySettings(const BleProtocol::Config &settings,
+                   uint32_t receivedMillis) {
+  bool refetch = false;
+  // Offline devices never reach NTP; the phone's clock corrects the drift
+  if (settings.currentTime != 0) {
+    RTCManager::getInstance().syncTimeFromPhone(settings.currentTime,
+                                                millis() - receivedMillis);
+    rtcData.day = 0; // Date may have moved
+  }
+
+  if (settings.hasMethod && settings.method != rtcData.calculationMethod) {
+    LOG_I("🧮 Calculation method %d -> %d", rtcData.calculationMethod,
+          settings.method);
+    rtcData.calculationMethod = settings.method;
+    refetch = true;
+  }
+
+  // Iqamas are evaluated locally from the cached adhan times
+  if (settings.iqamaMask != 0) {
+    mergeIqamaRules(settings, rtcData.iqamaRules);
+    rtcData.day = 0;
+    LOG_I("🕌 Iqama rules updated (mask 0x%02x)", settings.iqamaMask);
+  }
+
+  if (settings.hasHijriAdjust) {
+    rtcData.hijriAdjustmentDays = settings.hijriAdjust;
+    rtcData.hijri.date.month = 0;
+  }
+
+  // A fixed offset on its own replaces any DST rules
+  if (settings.hasTimezoneOffset || settings.posixTz[0] != '\0') {
+    if (settings.hasTimezoneOffset) {
+      rtcData.timezoneOffsetSeconds = settings.timezoneOffset;
+    }
+    strlcpy(rtcData.posixTz, settings.posixTz, sizeof(rtcData.posixTz));
+    rtcData.nextTzTransition = 0;
+    TimezoneRules::apply();
+    rtcData.day = 0; // Local date may have moved
+    rtcData.hijri.date.month = 0;
+    LOG_I("🌍 Timezone now %s", TimezoneRules::current());
+  }
+
+  // Aladhan returns the times in this zone
+  if (settings.timezoneName[0] != '\0' &&
+      strcmp(settings.timezoneName, rtcData.timezoneName) != 0) {
+    strlcpy(rtcData.timezoneName, settings.timezoneName,
+            sizeof(rtcData.timezoneName));
+    refetch = true;
+  }
+
+  if (settings.displayName[0] != '\0') {
+    strlcpy(rtcData.cityName, settings.displayName, sizeof(rtcData.cityName));
+  }
+
+  AppStateManager::save();
+  savePrayerConfig();
+  return refetch;
+}
+
+// The RTC log ring as MSG_LOG messages of whole lines, so a device without
+// USB attached can still be diagnosed
+void sendLogRing() {
+  static uint8_t message[BleProtocol::MAX_MESSAGE_SIZE];
+  const uint16_t total = Logger::count();
+  char line[160];
+  LogRecord rec;
+  size_t used = 1;
+  for (uint16_t i = 0; i < total; ++i) {
+    if (!Logger::get(i, rec)) {
+      continue;
+    }
+    const size_t length = Logger::format(rec, line, sizeof(line));
+    if (used + length + 1 > sizeof(message)) {
+      message[0] = 1; // More to come
+      BLEManager::getInstance().sendMessage(BleProtocol::MSG_LOG, message,
+                                            used);
+      used = 1;
+    }
+    memcpy(message + used, line, length);
+    used += length;
+    message[used++] = '\n';
+  }
+  message[0] = 0;
+  BLEManager::getInstance().sendMessage(BleProtocol::MSG_LOG, message, used);
+  LOG_I("📜 %u log records sent over BLE", total);
+}
+
+// Button wake, after the screen was drawn: BLE stays open for a minute (as
+// long as a phone is connected, up to five) for MSG_SETTINGS and
+// MSG_LOG_REQUEST, and the telemetry characteristic is kept current
+void handleSettingsWindow() {
+  LOG_I("⚙️ Settings window open");
+  HttpsSession::close();
+  WiFiManager::radioOff();
+
   BLEManager &ble = BLEManager::getInstance();
+  ble.onMessage(onSettingsMessage);
+  ble.setupBLE();
+  g_bleAdvertising = true;
+
+  // The BLE icon tells the user the window is open
+  GxEPD2Adapter<decltype(display)> epdAdapter(display);
+  ScreenUI ui(epdAdapter, 800, 480);
+  ui.redrawStatusBarRegion(
+      StatusBar::getStatusInfo(TimeSnapshot::now(), true));
+  Telemetry::countRefresh(false);
+
+  const unsigned long opened = millis();
+  unsigned long lastActivity = opened;
+  unsigned long lastTelemetry = 0;
+  bool changed = false;
+  bool refetch = false;
+  while (millis() - opened < SETTINGS_WINDOW_MAX_MS &&
+         millis() - lastActivity < SETTINGS_WINDOW_IDLE_MS) {
+    if (ble.isPhoneConnected()) {
+      lastActivity = millis();
+    }
+    if (lastTelemetry == 0 ||
+        millis() - lastTelemetry >= TELEMETRY_INTERVAL_MS) {
+      TelemetryRecord::Record record;
+      Telemetry::snapshot(record);
+      ble.setTelemetry((const uint8_t *)&record, sizeof(record));
+      lastTelemetry = millis();
+    }
+    if (g_hasPendingSettings.load(std::memory_order_acquire)) {
+      const BleProtocol::Config settings = g_pendingSettings;
+      const uint32_t receivedMillis = g_pendingSettingsMillis;
+      g_hasPendingSettings.store(false, std::memory_order_release);
+      refetch = applySettings(settings, receivedMillis) || refetch;
+      changed = true;
+      uint8_t status = BleProtocol::STATUS_OK;
+      ble.sendMessage(BleProtocol::MSG_STATUS, &status, 1);
+    }
+    if (g_logRequested.exchange(false, std::memory_order_acquire)) {
+      sendLogRing();
+    }
+    delay(100);
+  }
+
+  ble.stopAdvertising();
+  g_bleAdvertising = false;
+  LOG_I("⚙️ Settings window closed (%s)", changed ? "changed" : "no changes");
+  if (!changed) {
+    state = SLEEPING;
+    return;
+  }
+
+  // Only this month stays on screen until the periodic task replaces it;
+  // the look-ahead months are fetched again after it
+  if (refetch && !rtcData.offlineMode) {
+    TimeSnapshot now = TimeSnapshot::now();
+    CalendarManager::removeStoredMonths(CalendarManager::getMonthFilePath(
+        now.local.tm_year + 1900, now.local.tm_mon + 1));
+    rtcData.mosqueLastUpdateMillis = 0;
+    FetchBackoff::clear(FETCH_PRAYER);
+    g_calendarStale = true;
+    AppStateManager::save();
+  }
+  g_renderState.initialized = false;
+  state = RUNNING_MAIN_TASK;
 }
 
 void handleConnectingWifi() {
@@ -1077,36 +1761,8 @@ void handleConnectingWifi() {
             Serial.println("⚠️ Failed to get city name, will use coordinates");
           }
 
-          // Save timezone offset to RTC memory
-          rtcData.timezoneOffsetSeconds = g_receivedTimezoneOffset;
-          int hours = g_receivedTimezoneOffset / 3600;
-          int minutes = (abs(g_receivedTimezoneOffset) % 3600) / 60;
-          Serial.printf("💾 Timezone offset saved: UTC%+d:%02d (%d seconds)\n", 
-                        hours, minutes, g_receivedTimezoneOffset);
-
-          // Legacy: Save mosque UUID if provided (for backward compatibility)
-    if (!g_receivedMosqueUUID.isEmpty()) {
-      strncpy(rtcData.mosqueUUID, g_receivedMosqueUUID.c_str(),
-              sizeof(rtcData.mosqueUUID) - 1);
-            rtcData.mosqueUUID[sizeof(rtcData.mosqueUUID) - 1] = '\0';
-            Serial.printf("💾 Legacy mosque UUID saved: %s\n", rtcData.mosqueUUID);
-          }
-
-          // Persist to RTC memory
-      AppStateManager::save();
-
-      // Also save to SPIFFS for backup
-          String configJson = "{";
-          configJson += "\"latitude\":" + String(rtcData.latitude, 6) + ",";
-          configJson += "\"longitude\":" + String(rtcData.longitude, 6) + ",";
-          configJson += "\"calculation_method\":" + String(rtcData.calculationMethod) + ",";
-          configJson += "\"timezone_offset\":" + String(rtcData.timezoneOffsetSeconds);
-          if (rtcData.cityName[0] != '\0') {
-            configJson += ",\"city_name\":\"" + String(rtcData.cityName) + "\"";
-          }
-          configJson += "}";
-          writeJsonFile("/prayer_config.json", configJson);
-          Serial.println("💾 Configuration saved to SPIFFS");
+          rtcData.offlineMode = false;
+          storeReceivedConfig();
 
           // Fetch initial weather AND prayer times while WiFi is connected
           Serial.println("🌤️ Fetching initial weather...");
@@ -1119,16 +1775,23 @@ void handleConnectingWifi() {
                   Serial.println("⚠️ Failed to fetch initial weather (will retry later)");
                 }
                 
-                // Now fetch prayer times (WiFi still connected)
+                // Now fetch prayer times (WiFi still connected). Months
+                // stored for the previous location are no longer valid.
+                CalendarManager::removeStoredMonths();
+                if (!g_calendarUploaded) {
+                  // Uploaded for the previous setup, maybe another place
+                  CalendarManager::removeUploadedCalendar();
+                }
                 Serial.println("📡 Fetching initial prayer times...");
-                struct tm timeinfo;
-                if (!getLocalTime(&timeinfo)) {
+                TimeSnapshot now = TimeSnapshot::now();
+                if (!now.valid) {
                   Serial.println("❌ Failed to get time for initial prayer times fetch");
                   BLEManager::getInstance().stopAdvertising();
                   g_bleAdvertising = false;
                   state = SYNCING_TIME;
                   return;
                 }
+                const struct tm &timeinfo = now.local;
 
                 int currentMonth = timeinfo.tm_mon + 1;
                 int currentYear = timeinfo.tm_year + 1900;
@@ -1137,11 +1800,13 @@ void handleConnectingWifi() {
 
                 AladhanManager::getInstance().asyncFetchMonthlyPrayerTimes(
                     rtcData.latitude, rtcData.longitude, rtcData.calculationMethod,
-                    currentMonth, currentYear,
+                    currentMonth, currentYear, rtcData.timezoneName,
                     [currentMonth, currentYear](bool success, const char *path) {
                       if (success) {
                         Serial.printf("✅ Prayer times for %d/%d fetched successfully\n",
                                       currentMonth, currentYear);
+                        // New location/method: the RTC week is stale
+                        CalendarManager::invalidateCache();
                         rtcData.mosqueLastUpdateMillis = time(nullptr);
                         AppStateManager::save();
                       } else {
@@ -1185,53 +1850,96 @@ void handleConnectingWifi() {
 //   esp_deep_sleep_start();
 // }
 
-void handleSleeping() {
-  // Disconnect WiFi to save power
-  if (WiFi.status() == WL_CONNECTED) {
-    Serial.println("📡 Disconnecting WiFi before sleep");
-    WiFi.disconnect(true);
-    WiFi.mode(WIFI_OFF);
+void handleSleeping(bool redrawStatusBar) {
+  if (g_settingsWindowPending) {
+    g_settingsWindowPending = false;
+    state = SETTINGS_WINDOW; // Sleeps once the window closes
+    return;
+  }
+  AudioManager::waitUntilDone(); // Deep sleep would cut the adhan off
+  WakeProfiler::enter(WAKE_PHASE_SLEEP);
+  // Disconnect WiFi to save power. Radio off even when not connected: a
+  // failed connect leaves it on, and its session must end here.
+  const bool wifiConnected = WiFi.status() == WL_CONNECTED;
+  if (wifiConnected) {
+    LOG_I("📡 Disconnecting WiFi before sleep");
+    HttpsSession::close();
+  }
+  WiFiManager::radioOff();
+  if (wifiConnected) {
     delay(100);
   }
 
-  // Compute seconds to next full minute
-  struct tm timeinfo;
-  if (getLocalTime(&timeinfo)) {
-    int currentSecond = timeinfo.tm_sec;
+  // Compute seconds to next full minute. Re-read the clock (non-blocking):
+  // the wake snapshot is several seconds old by now.
+  TimeSnapshot now = TimeSnapshot::now();
+  if (now.valid) {
+    int currentSecond = now.local.tm_sec;
     sleepDuration = 60 - currentSecond;
     if (sleepDuration == 60)
       sleepDuration = 0; // edge case
   } else {
-    Serial.println("⚠️ Failed to get time for sleep alignment. Using 60s fallback.");
+    LOG_W("⚠️ Failed to get time for sleep alignment. Using 60s fallback.");
     sleepDuration = 60;
   }
 
+  if (g_minSleepSeconds > sleepDuration) {
+    sleepDuration = g_minSleepSeconds;
+  }
+
+  // Wake exactly at a DST switch so the clock is never shown an hour off
+  uint32_t untilTransition = TimezoneRules::secondsUntilTransition(now.epoch);
+  if (untilTransition > 0 && untilTransition < sleepDuration) {
+    sleepDuration = untilTransition;
+    LOG_I("🕐 Waking at DST transition in %lu seconds",
+          (unsigned long)untilTransition);
+  }
+
+  // Wake a few seconds before the adhan to pre-roll it
+  const time_t adhanWake = AudioManager::wakeTime();
+  if (adhanWake > now.epoch &&
+      (uint32_t)(adhanWake - now.epoch) < sleepDuration) {
+    sleepDuration = adhanWake - now.epoch;
+    LOG_I("🔊 Waking for the adhan in %d seconds", sleepDuration);
+  }
+
   // Calculate awake time for this cycle (only if tracking has started)
   if (rtcData.wakeStartMillis > 0) {
     unsigned long awakeMillis = millis() - rtcData.wakeStartMillis;
     unsigned long awakeSeconds = awakeMillis / 1000;
     rtcData.cumulativeAwakeSeconds += awakeSeconds;
-    Serial.printf("⏱️ Awake for %lu seconds this cycle (Total: %lu seconds, Cycles: %lu)\n",
-                  awakeSeconds, rtcData.cumulativeAwakeSeconds, rtcData.wakeCycleCount);
+    LOG_I("⏱️ Awake for %lu seconds this cycle (Total: %lu seconds, Cycles: %lu)",
+          awakeSeconds, rtcData.cumulativeAwakeSeconds, rtcData.wakeCycleCount);
     
-    // Update status bar with accurate awake time before sleep
-    GxEPD2Adapter<decltype(display)> epdAdapter(display);
-    ScreenUI ui(epdAdapter, 800, 480);
-    StatusInfo statusInfo = StatusBar::getStatusInfo(g_bleAdvertising, rtcData.cumulativeAwakeSeconds, rtcData.wakeCycleCount);
-    ui.redrawStatusBarRegion(statusInfo);
+    // The status bar clock was drawn from the wake snapshot; a long wake
+    // (network fetches) may have crossed into the next minute
+    if (redrawStatusBar && now.minutes() != g_wakeTime.minutes()) {
+      GxEPD2Adapter<decltype(display)> epdAdapter(display);
+      ScreenUI ui(epdAdapter, 800, 480);
+      StatusInfo statusInfo = StatusBar::getStatusInfo(now, g_bleAdvertising);
+      ui.redrawStatusBarRegion(statusInfo);
+      Telemetry::countRefresh(false);
+    }
   } else {
-    Serial.println("⏱️ First sleep - not counting initialization time");
+    LOG_I("⏱️ First sleep - not counting initialization time");
   }
 
+  // Radio time from connect to disconnect counts against the daily budget:
+  // Wi-Fi stays up past the network phase until the disconnect above
+  const WiFiManager::RadioUsage radio = WiFiManager::radioUsage();
+  FetchBackoff::chargeRadio(now.epoch, (radio.onMillis + 999) / 1000);
+  Telemetry::endWake(sleepDuration);
+
   // Save state to RTC memory before deep sleep
   AppStateManager::save();
 
-  Serial.printf("💤 Entering DEEP SLEEP for %d seconds...\n", sleepDuration);
-  Serial.flush();
-  delay(20);
+  LOG_I("💤 Entering DEEP SLEEP for %d seconds...", sleepDuration);
+  WakeProfiler::finish();
+  Logger::flush();
 
   // Configure wake sources
-  esp_sleep_enable_timer_wakeup((uint64_t)sleepDuration * 1000000ULL);
+  esp_sleep_enable_timer_wakeup(
+      RTCManager::getInstance().compensatedSleepMicros(sleepDuration));
   esp_sleep_enable_ext0_wakeup((gpio_num_t)FACTORY_RESET_BUTTON, 0);
 
   // DEEP SLEEP - device restarts on wake (runs setup() again)
@@ -1240,7 +1948,7 @@ void handleSleeping() {
 }
 
 void handleMainTaskState() {
-  Serial.println("⚙️ Running main task...");
+  LOG_D("⚙️ Running main task...");
   executeMainTask();
 
   state = RUNNING_PERIODIC_TASKS;
@@ -1285,9 +1993,10 @@ void fetchWeather() {
   WiFiManager::getInstance().asyncConnectWithSavedCredentials();
 
   WiFiManager::getInstance().onWifiFailedToConnectCallback([]() {
-    Serial.println("❌ Failed to connect to Wi-Fi to fetch weather (will retry in 1 hour)");
+    Serial.println("❌ Failed to connect to Wi-Fi to fetch weather (backing off)");
     // Restore retry count to prevent device restart
     rtcData.wifiRetryCount = 0;
+    FetchBackoff::failure(FETCH_WIFI, time(nullptr));
     AppStateManager::save();
     state = SLEEPING;
   });
@@ -1296,41 +2005,105 @@ void fetchWeather() {
     Serial.println("✅ Connected to Wi-Fi for weather fetch.");
     // Restore retry count after successful connection
     rtcData.wifiRetryCount = 0;
+    FetchBackoff::success(FETCH_WIFI);
     AppStateManager::save();
     
     WeatherManager::getInstance().asyncFetchWeather(
         rtcData.latitude, rtcData.longitude, [](bool success) {
           if (success) {
             Serial.println("✅ Weather fetched successfully");
+            FetchBackoff::success(FETCH_WEATHER);
             g_renderState.initialized = false;
-            state = RUNNING_MAIN_TASK;
           } else {
-            Serial.println("❌ Failed to fetch weather (will retry in 1 hour)");
-            state = SLEEPING;
+            Serial.println("❌ Failed to fetch weather (backing off)");
+            FetchBackoff::failure(FETCH_WEATHER, time(nullptr));
           }
+          // Opportunistic: top up the calendar while Wi-Fi is up
+          prefetchCalendar([success]() {
+            state = success ? RUNNING_MAIN_TASK : SLEEPING;
+          });
         });
   });
 }
 
+void syncClock() {
+  Serial.printf("⏱️ Predicted clock error %.1fs - resyncing with NTP\n",
+                RTCManager::getInstance().predictedErrorSeconds());
+
+  WiFiManager::getInstance().asyncConnectWithSavedCredentials();
+
+  WiFiManager::getInstance().onWifiFailedToConnectCallback([]() {
+    Serial.println("❌ Failed to connect to Wi-Fi for NTP (backing off)");
+    rtcData.wifiRetryCount = 0;
+    rtcData.lastNtpAttempt = time(nullptr);
+    FetchBackoff::failure(FETCH_WIFI, rtcData.lastNtpAttempt);
+    AppStateManager::save();
+    state = SLEEPING;
+  });
+
+  WiFiManager::getInstance().onWifiConnectedCallback([]() {
+    Serial.println("✅ Connected to Wi-Fi for NTP sync.");
+    rtcData.wifiRetryCount = 0;
+    FetchBackoff::success(FETCH_WIFI);
+    state = SYNCING_TIME;
+  });
+}
+
 void handlePeriodicTasks() {
-  Serial.println("🔄 Running periodic tasks...");
+  LOG_D("🔄 Running periodic tasks...");
+
+  // NTP only when the drift model says the clock may be out of budget
+  const time_t nowEpoch = time(nullptr);
+  if (!rtcData.offlineMode && RTCManager::getInstance().isSyncDue() &&
+      FetchBackoff::ready(FETCH_NTP, nowEpoch)) {
+    WakeProfiler::enter(WAKE_PHASE_NETWORK);
+    syncClock();
+    return;
+  }
   
+  // Prayer data about to run out: alarm, and retry hourly instead of waiting
+  // for the 6 hour schedule
+  TimeSnapshot now = TimeSnapshot::now();
+  g_calendarAlarm =
+      now.valid && CalendarManager::coverageDays(
+                       now.local, CALENDAR_COVERAGE_ALARM_DAYS) <
+                       CALENDAR_COVERAGE_ALARM_DAYS;
+  if (g_calendarAlarm) {
+    LOG_W("🚨 Prayer times on flash cover less than %d days",
+          CALENDAR_COVERAGE_ALARM_DAYS);
+  }
+  if (rtcData.offlineMode) {
+    // Everything comes from the uploaded calendar; Wi-Fi stays off
+    planFastPath();
+    state = SLEEPING;
+    return;
+  }
+
+  const bool calendarRetryDue =
+      g_calendarAlarm &&
+      now.epoch - rtcData.lastCalendarAttempt >= CALENDAR_RETRY_SECONDS;
+
   // Check if we need to fetch prayer times (every 6 hours)
   // Note: Weather fetch is chained inside prayer times fetch to reuse WiFi session
-  if (shouldFetchBasedOnInterval(rtcData.mosqueLastUpdateMillis,
-                                 mosqueUpdateInterval, "PRAYER_TIMES")) {
+  if ((calendarRetryDue ||
+       shouldFetchBasedOnInterval(rtcData.mosqueLastUpdateMillis,
+                                  mosqueUpdateInterval, "PRAYER_TIMES")) &&
+      FetchBackoff::ready(FETCH_PRAYER, nowEpoch)) {
+    WakeProfiler::enter(WAKE_PHASE_NETWORK);
     fetchPrayerTimesFromAladhan(); // This also checks/fetches weather if needed
     return;
   }
-  Serial.println("⚠️ Prayer times do not need to be fetched yet.");
+  LOG_D("⚠️ Prayer times do not need to be fetched yet.");
 
   // Check if we need to fetch weather separately (only if prayer times not fetched)
   if (shouldFetchBasedOnInterval(rtcData.weatherLastUpdate,
-                                 weatherUpdateInterval, "WEATHER")) {
+                                 weatherUpdateInterval, "WEATHER") &&
+      FetchBackoff::ready(FETCH_WEATHER, nowEpoch)) {
+    WakeProfiler::enter(WAKE_PHASE_NETWORK);
     fetchWeather();
     return;
   }
-  Serial.println("⚠️ Weather does not need to be fetched yet.");
+  LOG_D("⚠️ Weather does not need to be fetched yet.");
 
   // User events fetching (commented out for now)
   // if (shouldFetchBasedOnInterval(rtcData.userEventsUpdateMillis,
@@ -1339,6 +2112,7 @@ void handlePeriodicTasks() {
   //   return;
   // }
 
+  planFastPath();
   state = SLEEPING;
 }
 
@@ -1365,12 +2139,18 @@ void handleAppState() {
   case WAITING_FOR_WIFI_SCAN:
     handleWaitingForWifiScan();
     break;
+  case APPLYING_OFFLINE_SETUP:
+    handleApplyingOfflineSetup();
+    break;
   case RUNNING_MAIN_TASK:
     handleMainTaskState();
     break;
   case RUNNING_PERIODIC_TASKS:
     handlePeriodicTasks();
     break;
+  case SETTINGS_WINDOW:
+    handleSettingsWindow();
+    break;
   case SLEEPING:
     handleSleeping();
     break;
@@ -1385,12 +2165,12 @@ void loop() {
   int currentButtonState = digitalRead(FACTORY_RESET_BUTTON);
   if (currentButtonState != lastButtonState) {
     lastButtonState = currentButtonState;
-    Serial.printf("🔘 BOOT button (GPIO%d): %s\n", FACTORY_RESET_BUTTON,
-                  currentButtonState == LOW ? "PRESSED ⬇️" : "RELEASED ⬆️");
+    LOG_D("🔘 BOOT button (GPIO%d): %s", FACTORY_RESET_BUTTON,
+          currentButtonState == LOW ? "PRESSED ⬇️" : "RELEASED ⬆️");
   }
 
   if (state != lastState) {
-    Serial.printf("🔁 State changed: %d ➡️ %d\n", lastState, state);
+    LOG_D("🔁 State changed: %d ➡️ %d", lastState, state);
     lastState = state;
     handleAppState();
   }
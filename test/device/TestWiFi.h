@@ -0,0 +1,44 @@
+#ifndef TEST_WIFI_H
+#define TEST_WIFI_H
+
+// Wi-Fi for the device suites: the network from -DTEST_WIFI_SSID /
+// -DTEST_WIFI_PASSWORD if given, otherwise the one saved in /wifi.json by
+// the device's own setup.
+
+#include <AppState.h>
+#include <SPIFFSHelper.h>
+#include <WiFi.h>
+
+#ifndef TEST_WIFI_PASSWORD
+#define TEST_WIFI_PASSWORD ""
+#endif
+
+inline bool joinTestWiFi(uint32_t timeoutMs = 20000) {
+#ifdef TEST_WIFI_SSID
+  WiFi.mode(WIFI_STA);
+  WiFi.begin(TEST_WIFI_SSID, TEST_WIFI_PASSWORD);
+#else
+  JsonDocument doc;
+  if (!setupSPIFFS() || !readJsonFile(WIFI_CRED_FILE, doc)) {
+    return false;
+  }
+  WiFi.mode(WIFI_STA);
+  WiFi.begin(doc["ssid"].as<const char *>(),
+             doc["password"].as<const char *>());
+#endif
+  const unsigned long start = millis();
+  while (WiFi.status() != WL_CONNECTED && millis() - start < timeoutMs) {
+    delay(100);
+  }
+  return WiFi.status() == WL_CONNECTED;
+}
+
+// Radio off and back on, as around a deep sleep
+inline bool cycleTestWiFi(uint32_t offMs = 2000) {
+  WiFi.disconnect(true);
+  WiFi.mode(WIFI_OFF);
+  delay(offMs);
+  return joinTestWiFi();
+}
+
+#endif // TEST_WIFI_H
@@ -0,0 +1,145 @@
+// Open, read and replace latency of the project's file set on SPIFFS and
+// LittleFS, on the device:
+//
+//   pio test -e esp32-s3-devkitc-1 -f device/test_fs_bench -v
+//
+// ERASES the data partition (both backends are formatted in turn); set the
+// device up again afterwards.
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <SPIFFS.h>
+#include <unity.h>
+
+static const int RUNS = 10;
+
+struct FileSpec {
+  const char *label;
+  const char *path;
+  size_t size;
+};
+
+// Sizes as the firmware writes them
+static const FileSpec FILES[] = {
+    {"wifi", "/wifi.json", 96},
+    {"config", "/prayer_config.json", 640},
+    {"month", "/prayer_times_2026_01.json", 2200},
+    {"events", "/events.json", 3 * 1024},
+    {"mosque", "/data.json", 125 * 1024},
+};
+
+// The rest of a year of months, so latencies are taken on a partition
+// filled like a provisioned device's
+static const int FILLER_MONTHS = 11;
+
+static uint8_t chunk[1024];
+
+struct Timing {
+  uint32_t total = 0;
+  uint32_t worst = 0;
+  void add(uint32_t us) {
+    total += us;
+    worst = max(worst, us);
+  }
+};
+
+static bool writeFile(fs::FS &fs, const String &path, size_t size) {
+  File file = fs.open(path, FILE_WRITE);
+  if (!file) {
+    return false;
+  }
+  size_t written = 0;
+  while (written < size) {
+    written += file.write(chunk, min(sizeof(chunk), size - written));
+  }
+  file.close();
+  return written == size;
+}
+
+// Replace as commitAtomicWrite() does on each backend: LittleFS renames
+// over the old file, SPIFFS goes through "<path>.new"
+static bool replaceFile(fs::FS &fs, bool renameOver, const String &path,
+                        size_t size) {
+  const String tmp = path + ".tmp";
+  if (!writeFile(fs, tmp, size)) {
+    return false;
+  }
+  if (renameOver) {
+    return fs.rename(tmp, path);
+  }
+  const String ready = path + ".new";
+  return fs.rename(tmp, ready) && (!fs.exists(path) || fs.remove(path)) &&
+         fs.rename(ready, path);
+}
+
+static void bench(const char *name, fs::FS &fs, bool renameOver) {
+  for (int m = 2; m <= FILLER_MONTHS + 1; m++) {
+    char path[40];
+    snprintf(path, sizeof(path), "/prayer_times_2026_%02d.json", m);
+    TEST_ASSERT_TRUE(writeFile(fs, path, 2200));
+  }
+  for (const FileSpec &f : FILES) {
+    TEST_ASSERT_TRUE(writeFile(fs, f.path, f.size));
+  }
+
+  for (const FileSpec &f : FILES) {
+    Timing open, read, replace;
+    for (int i = 0; i < RUNS; i++) {
+      uint32_t start = micros();
+      File file = fs.open(f.path, FILE_READ);
+      open.add(micros() - start);
+      TEST_ASSERT_TRUE(file);
+
+      start = micros();
+      size_t total = 0;
+      size_t n;
+      while ((n = file.read(chunk, sizeof(chunk))) > 0) {
+        total += n;
+      }
+      file.close();
+      read.add(micros() - start);
+      TEST_ASSERT_EQUAL(f.size, total);
+
+      start = micros();
+      TEST_ASSERT_TRUE(replaceFile(fs, renameOver, f.path, f.size));
+      replace.add(micros() - start);
+    }
+    Serial.printf("%-9s %-7s %7lu B  open %6lu/%6lu  read %7lu/%7lu  "
+                  "replace %8lu/%8lu us (avg/worst)\n",
+                  name, f.label, (unsigned long)f.size,
+                  (unsigned long)(open.total / RUNS),
+                  (unsigned long)open.worst,
+                  (unsigned long)(read.total / RUNS),
+                  (unsigned long)read.worst,
+                  (unsigned long)(replace.total / RUNS),
+                  (unsigned long)replace.worst);
+  }
+}
+
+static void test_spiffs() {
+  TEST_ASSERT_TRUE(SPIFFS.begin(true));
+  TEST_ASSERT_TRUE(SPIFFS.format());
+  bench("SPIFFS", SPIFFS, false);
+  SPIFFS.end();
+}
+
+static void test_littlefs() {
+  TEST_ASSERT_TRUE(LittleFS.begin(true));
+  TEST_ASSERT_TRUE(LittleFS.format());
+  bench("LittleFS", LittleFS, true);
+  LittleFS.end();
+}
+
+void setUp() {}
+void tearDown() {}
+
+void setup() {
+  delay(2000); // Let the test runner attach to the port
+  memset(chunk, 'x', sizeof(chunk));
+  UNITY_BEGIN();
+  RUN_TEST(test_spiffs);
+  RUN_TEST(test_littlefs);
+  UNITY_END();
+}
+
+void loop() {}
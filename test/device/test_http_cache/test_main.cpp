@@ -0,0 +1,224 @@
+// HttpCache through the real fetch tasks, against tools/http_cache_mock.py:
+// the Aladhan month (ETag), the Open-Meteo forecast (Last-Modified) and the
+// MAWAQIT calendar (no validators, body hash only). The mock prints the
+// command line with its address:
+//
+//   tools/http_cache_mock.py                      (on a machine on the LAN)
+//   PLATFORMIO_BUILD_FLAGS='-DALADHAN_API_URL=\"http://192.168.1.20:8080\"
+//     -DOPEN_METEO_API_URL=\"https://192.168.1.20:8443\"
+//     -DMAWAQIT_API_URL=\"https://192.168.1.20:8443\"' \
+//     pio test -e esp32-s3-devkitc-1 -f device/test_http_cache -v
+//
+// A kept copy is overwritten with a marker before each repeat fetch: the
+// marker surviving shows the body was neither parsed nor rewritten. The
+// device's cache, January month file and mosque data are replaced.
+
+#include "../TestWiFi.h"
+#include <AladhanManager.h>
+#include <AppStateManager.h>
+#include <CalendarManager.h>
+#include <HttpCache.h>
+#include <MAWAQITManager.h>
+#include <WeatherManager.h>
+#include <unity.h>
+
+#if !defined(ALADHAN_API_URL) || !defined(OPEN_METEO_API_URL) ||             \
+    !defined(MAWAQIT_API_URL)
+#error "Build with the flags printed by tools/http_cache_mock.py"
+#endif
+
+static const int YEAR = 2026;
+static const int MONTH = 1;
+static const char *const MARKER = "{\"marker\":true}";
+static const int8_t MARKER_TEMP = 99;
+
+struct Request {
+  String path;
+  String ifNoneMatch;
+  String ifModifiedSince;
+  int status;
+};
+
+// Mock control endpoints live on the plain HTTP port
+static String control(const char *path) {
+  HTTPClient http;
+  WiFiClient client;
+  http.begin(client, String(ALADHAN_API_URL) + path);
+  const int code = http.GET();
+  String body = code == HTTP_CODE_OK ? http.getString() : String();
+  http.end();
+  TEST_ASSERT_EQUAL_MESSAGE(HTTP_CODE_OK, code, path);
+  return body;
+}
+
+// The one request the mock saw since the last call
+static Request lastRequest() {
+  JsonDocument log;
+  TEST_ASSERT_FALSE(deserializeJson(log, control("/_requests")));
+  TEST_ASSERT_EQUAL(1, log.size());
+  JsonObject r = log[0];
+  return {r["path"].as<String>(), r["ifNoneMatch"].as<String>(),
+          r["ifModifiedSince"].as<String>(), r["status"] | 0};
+}
+
+// Runs an async fetch and waits for its callback
+template <typename Start> static bool waitFor(Start start) {
+  volatile bool done = false;
+  volatile bool result = false;
+  start([&](bool success) {
+    result = success;
+    done = true;
+  });
+  const unsigned long begin = millis();
+  while (!done && millis() - begin < 60000) {
+    delay(50);
+  }
+  TEST_ASSERT_TRUE_MESSAGE(done, "fetch timed out");
+  return result;
+}
+
+static bool fetchMonth() {
+  return waitFor([](std::function<void(bool)> done) {
+    AladhanManager::getInstance().asyncFetchMonthlyPrayerTimes(
+        51.5f, -0.1f, 2, MONTH, YEAR, "Europe/London",
+        [done](bool success, const char *) { done(success); });
+  });
+}
+
+static bool fetchForecast() {
+  return waitFor([](std::function<void(bool)> done) {
+    WeatherManager::getInstance().asyncFetchWeather(51.5f, -0.1f, done);
+  });
+}
+
+static bool fetchMosque() {
+  return waitFor([](std::function<void(bool)> done) {
+    MAWAQITManager::getInstance().asyncFetchPrayerTimes(
+        "mock-mosque", [done](bool success, const char *) { done(success); });
+  });
+}
+
+static void mark(const String &path) {
+  TEST_ASSERT_TRUE(writeJsonFile(path, MARKER));
+}
+
+static bool marked(const String &path) { return readJsonFile(path) == MARKER; }
+
+// Full download, then a 304 for the unchanged month, then a new body
+static void test_aladhan_etag() {
+  control("/_reset?validators=1");
+  const String path = CalendarManager::getMonthFilePath(YEAR, MONTH);
+
+  TEST_ASSERT_TRUE(fetchMonth());
+  Request r = lastRequest();
+  TEST_ASSERT_EQUAL(HTTP_CODE_OK, r.status);
+  TEST_ASSERT_TRUE(r.ifNoneMatch.isEmpty());
+  TEST_ASSERT_FALSE(marked(path));
+
+  mark(path);
+  TEST_ASSERT_TRUE(fetchMonth());
+  r = lastRequest();
+  TEST_ASSERT_EQUAL_STRING("\"calendar-2026-1-v0\"", r.ifNoneMatch.c_str());
+  TEST_ASSERT_EQUAL(HTTP_CODE_NOT_MODIFIED, r.status);
+  TEST_ASSERT_TRUE_MESSAGE(marked(path), "304 rewrote the month file");
+
+  control("/_change");
+  TEST_ASSERT_TRUE(fetchMonth());
+  r = lastRequest();
+  TEST_ASSERT_EQUAL(HTTP_CODE_OK, r.status);
+  TEST_ASSERT_FALSE_MESSAGE(marked(path), "changed month not stored");
+}
+
+// No validators from the server: the same body is recognised by its hash
+static void test_aladhan_same_hash() {
+  control("/_reset?validators=0");
+  HttpCache::clear();
+  const String path = CalendarManager::getMonthFilePath(YEAR, MONTH);
+
+  TEST_ASSERT_TRUE(fetchMonth());
+  TEST_ASSERT_EQUAL(HTTP_CODE_OK, lastRequest().status);
+
+  mark(path);
+  TEST_ASSERT_TRUE(fetchMonth());
+  Request r = lastRequest();
+  TEST_ASSERT_TRUE(r.ifNoneMatch.isEmpty());
+  TEST_ASSERT_TRUE(r.ifModifiedSince.isEmpty());
+  TEST_ASSERT_EQUAL(HTTP_CODE_OK, r.status);
+  TEST_ASSERT_TRUE_MESSAGE(marked(path), "same body rewrote the month file");
+
+  control("/_change");
+  TEST_ASSERT_TRUE(fetchMonth());
+  TEST_ASSERT_FALSE_MESSAGE(marked(path), "changed month not stored");
+}
+
+// The forecast lives in RTC memory; a marker temperature stands in for it
+static void test_weather_last_modified() {
+  control("/_reset?validators=1");
+  rtcData.weather = WeatherForecast();
+
+  TEST_ASSERT_TRUE(fetchForecast());
+  Request r = lastRequest();
+  TEST_ASSERT_EQUAL(HTTP_CODE_OK, r.status);
+  TEST_ASSERT_TRUE(r.ifModifiedSince.isEmpty());
+  TEST_ASSERT_EQUAL(WeatherForecast::HOURS, rtcData.weather.count);
+
+  rtcData.weather.temp[0] = MARKER_TEMP;
+  TEST_ASSERT_TRUE(fetchForecast());
+  r = lastRequest();
+  TEST_ASSERT_EQUAL_STRING("Thu, 01 Jan 2026 00:00:00 GMT",
+                           r.ifModifiedSince.c_str());
+  TEST_ASSERT_EQUAL(HTTP_CODE_NOT_MODIFIED, r.status);
+  TEST_ASSERT_EQUAL(MARKER_TEMP, rtcData.weather.temp[0]);
+
+  control("/_change");
+  TEST_ASSERT_TRUE(fetchForecast());
+  TEST_ASSERT_EQUAL(HTTP_CODE_OK, lastRequest().status);
+  TEST_ASSERT_NOT_EQUAL(MARKER_TEMP, rtcData.weather.temp[0]);
+}
+
+// data/data.json without validators: only the streamed hash can spare the
+// 125 KB rewrite
+static void test_mawaqit_no_validators() {
+  control("/_reset?validators=1");
+  deleteFile(MOSQUE_FILE);
+
+  TEST_ASSERT_TRUE(fetchMosque());
+  Request r = lastRequest();
+  TEST_ASSERT_EQUAL(HTTP_CODE_OK, r.status);
+  TEST_ASSERT_TRUE(fileExists(MOSQUE_FILE));
+
+  mark(MOSQUE_FILE);
+  TEST_ASSERT_TRUE(fetchMosque());
+  r = lastRequest();
+  TEST_ASSERT_TRUE(r.ifNoneMatch.isEmpty());
+  TEST_ASSERT_TRUE(r.ifModifiedSince.isEmpty());
+  TEST_ASSERT_EQUAL(HTTP_CODE_OK, r.status);
+  TEST_ASSERT_TRUE_MESSAGE(marked(MOSQUE_FILE),
+                           "same body rewrote the mosque file");
+
+  control("/_change");
+  TEST_ASSERT_TRUE(fetchMosque());
+  TEST_ASSERT_FALSE_MESSAGE(marked(MOSQUE_FILE), "changed calendar not stored");
+}
+
+void setUp() {}
+void tearDown() {}
+
+void setup() {
+  delay(2000); // Let the test runner attach to the port
+  UNITY_BEGIN();
+  if (!setupSPIFFS() || !joinTestWiFi()) {
+    TEST_MESSAGE("No Wi-Fi: set up the device or pass -DTEST_WIFI_SSID");
+  } else {
+    HttpCache::clear();
+    deleteFile(CalendarManager::getMonthFilePath(YEAR, MONTH).c_str());
+    RUN_TEST(test_aladhan_etag);
+    RUN_TEST(test_aladhan_same_hash);
+    RUN_TEST(test_weather_last_modified);
+    RUN_TEST(test_mawaqit_no_validators);
+    HttpsSession::close();
+  }
+  UNITY_END();
+}
+
+void loop() {}
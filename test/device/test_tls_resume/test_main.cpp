@@ -0,0 +1,98 @@
+// TlsClient session resumption against a real server, across a simulated
+// deep sleep (client destroyed, Wi-Fi off and on, session only on flash):
+//
+//   tools/tls_test_server.sh                      (on a machine on the LAN)
+//   PLATFORMIO_BUILD_FLAGS='-DTLS_TEST_HOST=\"192.168.1.20\"' \
+//     pio test -e esp32-s3-devkitc-1 -f device/test_tls_resume -v
+//
+// The server's -www page reports "New," or "Reused," for each connection,
+// so resumption is confirmed by the server, not only by TlsClient.
+
+#include "../TestWiFi.h"
+#include <TlsClient.h>
+#include <unity.h>
+
+#ifndef TLS_TEST_HOST
+#error "Build with -DTLS_TEST_HOST=\"<address of tools/tls_test_server.sh>\""
+#endif
+#ifndef TLS_TEST_PORT
+#define TLS_TEST_PORT 8443
+#endif
+
+static const int WAKES = 5; // One full handshake, then resumed ones
+
+struct Handshake {
+  uint32_t millis;
+  bool resumedByClient;
+  bool reusedByServer;
+};
+
+// One wake's worth of HTTPS: fresh client, one request, connection closed
+static Handshake fetchStatusPage() {
+  TlsClient *client = new TlsClient();
+  TEST_ASSERT_TRUE_MESSAGE(client->connect(TLS_TEST_HOST, TLS_TEST_PORT),
+                           "TLS connect failed");
+  client->print("GET / HTTP/1.0\r\n\r\n");
+  String page;
+  const unsigned long start = millis();
+  while (millis() - start < 5000 &&
+         (client->connected() || client->available())) {
+    int c = client->read();
+    if (c >= 0) {
+      page += (char)c;
+    } else {
+      delay(1);
+    }
+  }
+  Handshake result = {client->handshakeMillis(), client->resumed(),
+                      page.indexOf("Reused,") >= 0};
+  TEST_ASSERT_TRUE_MESSAGE(result.reusedByServer || page.indexOf("New,") >= 0,
+                           "No s_server -www status page");
+  client->stop();
+  delete client;
+  return result;
+}
+
+static void test_resume_across_sleep() {
+  TlsClient::forgetSessions();
+  uint32_t resumedTotal = 0;
+  uint32_t full = 0;
+  for (int wake = 0; wake < WAKES; wake++) {
+    if (wake > 0) {
+      TEST_ASSERT_TRUE_MESSAGE(cycleTestWiFi(), "Wi-Fi did not come back");
+    }
+    const Handshake h = fetchStatusPage();
+    Serial.printf("wake %d: %lu ms, client %s, server %s\n", wake,
+                  (unsigned long)h.millis,
+                  h.resumedByClient ? "resumed" : "full",
+                  h.reusedByServer ? "Reused" : "New");
+    // Both sides must agree on what happened
+    TEST_ASSERT_EQUAL(h.reusedByServer, h.resumedByClient);
+    if (wake == 0) {
+      TEST_ASSERT_FALSE(h.reusedByServer);
+      full = h.millis;
+    } else {
+      TEST_ASSERT_TRUE_MESSAGE(h.reusedByServer, "Saved ticket refused");
+      resumedTotal += h.millis;
+    }
+  }
+  Serial.printf("full handshake %lu ms, resumed %lu ms on average\n",
+                (unsigned long)full,
+                (unsigned long)(resumedTotal / (WAKES - 1)));
+}
+
+void setUp() {}
+void tearDown() {}
+
+void setup() {
+  delay(2000); // Let the test runner attach to the port
+  UNITY_BEGIN();
+  if (!joinTestWiFi()) {
+    TEST_MESSAGE("No Wi-Fi: set up the device or pass -DTEST_WIFI_SSID");
+  } else {
+    RUN_TEST(test_resume_across_sleep);
+  }
+  UNITY_END();
+}
+
+void loop() {}
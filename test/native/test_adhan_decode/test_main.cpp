@@ -0,0 +1,119 @@
+// The adhan through ESP8266Audio's MP3 decoder on the host, the way
+// AudioManager plays it minus the I2S output: a synthetic file built here,
+// then the real download when there is one.
+//
+//   curl -L -o adhan.mp3 https://www.mp3quran.net/api/adhan_madinah.mp3
+//   pio test -e native-audio -v
+//
+// ADHAN_MP3_PATH points elsewhere (a file from a device's data partition).
+
+#include <Arduino.h>
+#include <AudioFileSourceSTDIO.h>
+#include <AudioGeneratorMP3.h>
+#include <AudioOutput.h>
+#include <unity.h>
+
+#ifndef ADHAN_MP3_PATH
+#define ADHAN_MP3_PATH "adhan.mp3"
+#endif
+
+// Same cap as AudioManager's ADHAN_MAX_SECONDS
+static const int MAX_SECONDS = 10 * 60;
+
+static const char *const SILENT_PATH = "/tmp/test_adhan_silent.mp3";
+static const int SILENT_FRAMES = 100;
+static const int SAMPLES_PER_FRAME = 1152; // MPEG-1 Layer III
+
+// Counts what the decoder hands to the output instead of playing it
+class CountingOutput : public AudioOutput {
+public:
+  bool SetRate(int hz) override {
+    rate = hz;
+    return AudioOutput::SetRate(hz);
+  }
+  bool begin() override { return true; }
+  bool ConsumeSample(int16_t sample[2]) override {
+    samples++;
+    peak = max(peak, abs(sample[LEFTCHANNEL]));
+    peak = max(peak, abs(sample[RIGHTCHANNEL]));
+    return true;
+  }
+  bool stop() override { return true; }
+
+  int rate = 0;
+  unsigned long samples = 0;
+  int peak = 0;
+};
+
+// MPEG-1 Layer III, 128 kbit/s, 44.1 kHz, mono: 417 bytes a frame. All-zero
+// side information and main data decode to silence.
+static void writeSilentMp3(const char *path, int frames) {
+  static const uint8_t HEADER[] = {0xFF, 0xFB, 0x90, 0xC4};
+  uint8_t frame[417] = {0};
+  memcpy(frame, HEADER, sizeof(HEADER));
+  FILE *file = fopen(path, "wb");
+  TEST_ASSERT_NOT_NULL(file);
+  for (int i = 0; i < frames; i++) {
+    TEST_ASSERT_EQUAL(sizeof(frame), fwrite(frame, 1, sizeof(frame), file));
+  }
+  fclose(file);
+}
+
+// Runs the decoder to the end of the file, as AudioManager's play task does
+static double decode(const char *path, CountingOutput &output) {
+  AudioFileSourceSTDIO source(path);
+  TEST_ASSERT_TRUE_MESSAGE(source.isOpen(), path);
+  AudioGeneratorMP3 mp3;
+  TEST_ASSERT_TRUE(mp3.begin(&source, &output));
+  const unsigned long start = micros();
+  while (mp3.isRunning() && mp3.loop()) {
+  }
+  mp3.stop();
+  return (micros() - start) / 1e6;
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_silent_frames() {
+  writeSilentMp3(SILENT_PATH, SILENT_FRAMES);
+  CountingOutput output;
+  decode(SILENT_PATH, output);
+  remove(SILENT_PATH);
+
+  TEST_ASSERT_EQUAL(44100, output.rate);
+  TEST_ASSERT_EQUAL(0, output.peak);
+  // libmad holds back the last frame or two at the end of the stream
+  TEST_ASSERT_LESS_OR_EQUAL(SILENT_FRAMES * SAMPLES_PER_FRAME,
+                            output.samples);
+  TEST_ASSERT_GREATER_OR_EQUAL((SILENT_FRAMES - 2) * SAMPLES_PER_FRAME,
+                               output.samples);
+}
+
+static void test_adhan_file() {
+  FILE *file = fopen(ADHAN_MP3_PATH, "rb");
+  if (!file) {
+    TEST_IGNORE_MESSAGE("No " ADHAN_MP3_PATH " (see the top of this file)");
+  }
+  fclose(file);
+
+  CountingOutput output;
+  const double elapsed = decode(ADHAN_MP3_PATH, output);
+  TEST_ASSERT_GREATER_THAN(0, output.rate);
+  const double seconds = (double)output.samples / output.rate;
+  printf("\n%s: %.1f s at %d Hz, peak %d, decoded in %.2f s (%.0fx)\n",
+         ADHAN_MP3_PATH, seconds, output.rate, output.peak, elapsed,
+         elapsed > 0 ? seconds / elapsed : 0.0);
+
+  // Something audible, and short enough to end before the play task's cap
+  TEST_ASSERT_GREATER_THAN(0, output.peak);
+  TEST_ASSERT_GREATER_THAN(10, (int)seconds);
+  TEST_ASSERT_LESS_THAN(MAX_SECONDS, (int)seconds);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_silent_frames);
+  RUN_TEST(test_adhan_file);
+  return UNITY_END();
+}
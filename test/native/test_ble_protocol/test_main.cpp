@@ -0,0 +1,367 @@
+// BLE provisioning codec on the host: framing at the MTUs phones actually
+// negotiate, scan result and config payloads, and the upload CRC.
+
+#include <BleProtocol.h>
+#include <string.h>
+#include <unity.h>
+
+using namespace BleProtocol;
+
+// Minimum, a common Android value and the maximum
+static const uint16_t MTUS[] = {DEFAULT_MTU, 185, PREFERRED_MTU};
+
+static uint8_t message[MAX_MESSAGE_SIZE];
+static uint8_t frame[PREFERRED_MTU];
+
+static void fillMessage(size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    message[i] = (uint8_t)(i * 7 + 3);
+  }
+}
+
+// Sends 'length' bytes through a Chunker and a Reassembler; returns the
+// number of frames
+static size_t roundTrip(uint16_t mtu, size_t length, Reassembler &rx) {
+  fillMessage(length);
+  Chunker tx(MSG_CONFIG, message, length, mtu);
+  size_t frames = 0;
+  Reassembler::Result result = Reassembler::INCOMPLETE;
+  size_t n;
+  while ((n = tx.next(frame)) > 0) {
+    TEST_ASSERT_LESS_OR_EQUAL(mtu - ATT_OVERHEAD, n);
+    TEST_ASSERT_EQUAL(Reassembler::INCOMPLETE, result);
+    result = rx.push(frame, n);
+    frames++;
+  }
+  TEST_ASSERT_TRUE(tx.done());
+  TEST_ASSERT_EQUAL(Reassembler::COMPLETE, result);
+  TEST_ASSERT_EQUAL(MSG_CONFIG, rx.type());
+  TEST_ASSERT_EQUAL(length, rx.size());
+  if (length > 0) {
+    TEST_ASSERT_EQUAL_MEMORY(message, rx.data(), length);
+  }
+  return frames;
+}
+
+static void test_round_trip_at_each_mtu() {
+  Reassembler rx;
+  for (uint16_t mtu : MTUS) {
+    const size_t perFrame = mtu - ATT_OVERHEAD - HEADER_SIZE;
+    const size_t lengths[] = {1, perFrame - 1, perFrame, perFrame + 1,
+                              3 * perFrame, 1000, MAX_MESSAGE_SIZE};
+    for (size_t length : lengths) {
+      const size_t frames = roundTrip(mtu, length, rx);
+      TEST_ASSERT_EQUAL((length + perFrame - 1) / perFrame, frames);
+    }
+  }
+}
+
+static void test_empty_message() {
+  Reassembler rx;
+  for (uint16_t mtu : MTUS) {
+    // Still one frame, so the receiver sees the message at all
+    TEST_ASSERT_EQUAL(1, roundTrip(mtu, 0, rx));
+  }
+  Chunker tx(MSG_STATUS, nullptr, 0, DEFAULT_MTU);
+  TEST_ASSERT_EQUAL(HEADER_SIZE, tx.next(frame));
+  TEST_ASSERT_EQUAL(MSG_STATUS, frame[0]);
+  TEST_ASSERT_EQUAL(FRAME_LAST, frame[1]);
+  TEST_ASSERT_EQUAL(0, tx.next(frame));
+}
+
+static size_t makeFrame(uint8_t *out, uint8_t type, uint16_t seq, bool last,
+                        size_t payload) {
+  out[0] = type;
+  out[1] = last ? FRAME_LAST : 0;
+  out[2] = seq & 0xFF;
+  out[3] = seq >> 8;
+  memset(out + HEADER_SIZE, 0xA5, payload);
+  return HEADER_SIZE + payload;
+}
+
+static void test_out_of_order_frames() {
+  Reassembler rx;
+  size_t n = makeFrame(frame, MSG_CONFIG, 0, false, 10);
+  TEST_ASSERT_EQUAL(Reassembler::INCOMPLETE, rx.push(frame, n));
+  n = makeFrame(frame, MSG_CONFIG, 2, true, 10); // seq 1 missing
+  TEST_ASSERT_EQUAL(Reassembler::ERROR, rx.push(frame, n));
+
+  // Nothing started: a continuation frame is rejected
+  n = makeFrame(frame, MSG_CONFIG, 1, true, 10);
+  TEST_ASSERT_EQUAL(Reassembler::ERROR, rx.push(frame, n));
+
+  // Repeated frame
+  n = makeFrame(frame, MSG_CONFIG, 0, false, 10);
+  TEST_ASSERT_EQUAL(Reassembler::INCOMPLETE, rx.push(frame, n));
+  n = makeFrame(frame, MSG_CONFIG, 1, false, 10);
+  TEST_ASSERT_EQUAL(Reassembler::INCOMPLETE, rx.push(frame, n));
+  TEST_ASSERT_EQUAL(Reassembler::ERROR, rx.push(frame, n));
+
+  // Another message type mid-message
+  n = makeFrame(frame, MSG_CONFIG, 0, false, 10);
+  TEST_ASSERT_EQUAL(Reassembler::INCOMPLETE, rx.push(frame, n));
+  n = makeFrame(frame, MSG_SETTINGS, 1, true, 10);
+  TEST_ASSERT_EQUAL(Reassembler::ERROR, rx.push(frame, n));
+
+  // Shorter than a header
+  TEST_ASSERT_EQUAL(Reassembler::ERROR, rx.push(frame, HEADER_SIZE - 1));
+
+  // A new seq 0 restarts cleanly after an error
+  TEST_ASSERT_EQUAL(5, roundTrip(DEFAULT_MTU, 80, rx));
+}
+
+static void test_oversized_message() {
+  Reassembler rx;
+  const size_t payload = PREFERRED_MTU - ATT_OVERHEAD - HEADER_SIZE;
+  uint16_t seq = 0;
+  size_t total = 0;
+  Reassembler::Result result = Reassembler::INCOMPLETE;
+  while (result == Reassembler::INCOMPLETE) {
+    const size_t n = makeFrame(frame, MSG_CONFIG, seq++, false, payload);
+    result = rx.push(frame, n);
+    total += payload;
+  }
+  TEST_ASSERT_EQUAL(Reassembler::ERROR, result);
+  TEST_ASSERT_GREATER_THAN(MAX_MESSAGE_SIZE, total);
+  TEST_ASSERT_EQUAL(0, rx.size());
+
+  // Exactly MAX_MESSAGE_SIZE still fits
+  roundTrip(PREFERRED_MTU, MAX_MESSAGE_SIZE, rx);
+}
+
+static void makeEntries(ScanEntry *entries, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    memset(&entries[i], 0, sizeof(entries[i]));
+    // Lengths from 1 to 32 bytes
+    const size_t len = 1 + i % 32;
+    for (size_t c = 0; c < len; c++) {
+      entries[i].ssid[c] = 'a' + (i + c) % 26;
+    }
+    entries[i].rssi = (int8_t)(-30 - (int)i);
+    entries[i].secured = i % 3 != 0;
+  }
+}
+
+static void assertSameEntries(const ScanEntry *expected,
+                              const ScanEntry *actual, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    TEST_ASSERT_EQUAL_STRING(expected[i].ssid, actual[i].ssid);
+    TEST_ASSERT_EQUAL_INT8(expected[i].rssi, actual[i].rssi);
+    TEST_ASSERT_EQUAL(expected[i].secured, actual[i].secured);
+  }
+}
+
+static void test_scan_results_round_trip() {
+  static const size_t COUNT = 40;
+  ScanEntry entries[COUNT];
+  ScanEntry decoded[COUNT];
+  makeEntries(entries, COUNT);
+
+  const size_t length =
+      encodeScanResults(entries, COUNT, message, sizeof(message));
+  TEST_ASSERT_GREATER_THAN(0, length);
+  TEST_ASSERT_EQUAL(COUNT, message[0]);
+  TEST_ASSERT_EQUAL(COUNT,
+                    decodeScanResults(message, length, decoded, COUNT));
+  assertSameEntries(entries, decoded, COUNT);
+
+  // Through the framing at the smallest MTU as well
+  Chunker tx(MSG_SCAN_RESULTS, message, length, DEFAULT_MTU);
+  Reassembler rx;
+  size_t n;
+  Reassembler::Result result = Reassembler::INCOMPLETE;
+  while ((n = tx.next(frame)) > 0) {
+    result = rx.push(frame, n);
+  }
+  TEST_ASSERT_EQUAL(Reassembler::COMPLETE, result);
+  TEST_ASSERT_EQUAL(COUNT, decodeScanResults(rx.data(), rx.size(), decoded,
+                                             COUNT));
+  assertSameEntries(entries, decoded, COUNT);
+
+  // A smaller receiver array takes the first entries
+  TEST_ASSERT_EQUAL(10, decodeScanResults(message, length, decoded, 10));
+  assertSameEntries(entries, decoded, 10);
+}
+
+static void test_scan_results_truncated_to_capacity() {
+  static const size_t COUNT = 40;
+  ScanEntry entries[COUNT];
+  ScanEntry decoded[COUNT];
+  makeEntries(entries, COUNT);
+  const size_t full =
+      encodeScanResults(entries, COUNT, message, sizeof(message));
+
+  for (size_t capacity = 1; capacity < full; capacity += 7) {
+    uint8_t out[MAX_MESSAGE_SIZE];
+    const size_t length = encodeScanResults(entries, COUNT, out, capacity);
+    TEST_ASSERT_LESS_OR_EQUAL(capacity, length);
+    // Whole entries from the front, none cut in half
+    const size_t kept = out[0];
+    size_t expected = 1;
+    for (size_t i = 0; i < kept; i++) {
+      expected += 3 + strlen(entries[i].ssid);
+    }
+    TEST_ASSERT_EQUAL(expected, length);
+    TEST_ASSERT_TRUE(kept == COUNT ||
+                     expected + 3 + strlen(entries[kept].ssid) > capacity);
+    TEST_ASSERT_EQUAL(kept, decodeScanResults(out, length, decoded, COUNT));
+    assertSameEntries(entries, decoded, kept);
+  }
+  TEST_ASSERT_EQUAL(0, encodeScanResults(entries, COUNT, message, 0));
+}
+
+static Config fullConfig() {
+  Config c;
+  strcpy(c.ssid, "01234567890123456789012345678901"); // 32 bytes
+  strcpy(c.password, "secret password");
+  strcpy(c.posixTz, "CET-1CEST,M3.5.0,M10.5.0/3");
+  strcpy(c.timezoneName, "Europe/Amsterdam");
+  strcpy(c.displayName, "Amsterdam");
+  c.latitudeE7 = 523676000;
+  c.longitudeE7 = -49041000;
+  c.timezoneOffset = 3600;
+  c.currentTime = 1767225600;
+  c.method = 3;
+  c.hasMethod = true;
+  c.hijriAdjust = -1;
+  c.hasHijriAdjust = true;
+  c.hasLocation = true;
+  c.hasTimezoneOffset = true;
+  for (int i = 0; i < IQAMA_RULES; i++) {
+    c.iqama[i] = {(uint8_t)(i % 2), (uint16_t)(10 + i)};
+  }
+  c.iqamaMask = ALL_IQAMA_RULES;
+  return c;
+}
+
+static void test_config_round_trip() {
+  const Config in = fullConfig();
+  const size_t length = encodeConfig(in, message, sizeof(message));
+  TEST_ASSERT_GREATER_THAN(0, length);
+  Config out;
+  TEST_ASSERT_TRUE(decodeConfig(message, length, out));
+  TEST_ASSERT_EQUAL_STRING(in.ssid, out.ssid);
+  TEST_ASSERT_EQUAL_STRING(in.password, out.password);
+  TEST_ASSERT_EQUAL_STRING(in.posixTz, out.posixTz);
+  TEST_ASSERT_EQUAL_STRING(in.timezoneName, out.timezoneName);
+  TEST_ASSERT_EQUAL_STRING(in.displayName, out.displayName);
+  TEST_ASSERT_EQUAL_INT32(in.latitudeE7, out.latitudeE7);
+  TEST_ASSERT_EQUAL_INT32(in.longitudeE7, out.longitudeE7);
+  TEST_ASSERT_EQUAL_INT32(in.timezoneOffset, out.timezoneOffset);
+  TEST_ASSERT_EQUAL_UINT32(in.currentTime, out.currentTime);
+  TEST_ASSERT_EQUAL(in.method, out.method);
+  TEST_ASSERT_EQUAL_INT8(in.hijriAdjust, out.hijriAdjust);
+  TEST_ASSERT_TRUE(out.hasLocation && out.hasMethod && out.hasHijriAdjust &&
+                   out.hasTimezoneOffset);
+  TEST_ASSERT_EQUAL(ALL_IQAMA_RULES, out.iqamaMask);
+  for (int i = 0; i < IQAMA_RULES; i++) {
+    TEST_ASSERT_EQUAL(in.iqama[i].type, out.iqama[i].type);
+    TEST_ASSERT_EQUAL(in.iqama[i].value, out.iqama[i].value);
+  }
+
+  // Unknown tags from a newer app are skipped
+  uint8_t withUnknown[MAX_MESSAGE_SIZE] = {0xF0, 3, 1, 2, 3};
+  memcpy(withUnknown + 5, message, length);
+  TEST_ASSERT_TRUE(decodeConfig(withUnknown, length + 5, out));
+  TEST_ASSERT_EQUAL_STRING(in.ssid, out.ssid);
+}
+
+static void test_config_rejects_truncated_tlv() {
+  const size_t length = encodeConfig(fullConfig(), message, sizeof(message));
+  // Every cut that does not fall on a TLV boundary
+  size_t boundary = 0;
+  Config out;
+  for (size_t cut = 1; cut < length; cut++) {
+    if (cut == boundary + 2 + message[boundary + 1]) {
+      boundary = cut;
+      TEST_ASSERT_TRUE(decodeConfig(message, cut, out));
+    } else {
+      TEST_ASSERT_FALSE(decodeConfig(message, cut, out));
+    }
+  }
+  const uint8_t tagOnly[] = {TAG_SSID};
+  TEST_ASSERT_FALSE(decodeConfig(tagOnly, sizeof(tagOnly), out));
+  const uint8_t shortValue[] = {TAG_SSID, 5, 'a', 'b'};
+  TEST_ASSERT_FALSE(decodeConfig(shortValue, sizeof(shortValue), out));
+}
+
+static bool decodeTlv(uint8_t tag, size_t len, Config &out) {
+  uint8_t tlv[2 + 255] = {tag, (uint8_t)len};
+  memset(tlv + 2, 'x', len);
+  return decodeConfig(tlv, 2 + len, out);
+}
+
+static void test_config_rejects_oversized_strings() {
+  struct {
+    uint8_t tag;
+    size_t maxLen;
+  } const strings[] = {
+      {TAG_SSID, sizeof(Config::ssid) - 1},
+      {TAG_PASSWORD, sizeof(Config::password) - 1},
+      {TAG_POSIX_TZ, sizeof(Config::posixTz) - 1},
+      {TAG_TZ_NAME, sizeof(Config::timezoneName) - 1},
+      {TAG_MOSQUE_UUID, sizeof(Config::mosqueUuid) - 1},
+      {TAG_DISPLAY_NAME, sizeof(Config::displayName) - 1},
+  };
+  Config out;
+  for (const auto &s : strings) {
+    TEST_ASSERT_TRUE(decodeTlv(s.tag, s.maxLen, out));
+    TEST_ASSERT_FALSE(decodeTlv(s.tag, s.maxLen + 1, out));
+    TEST_ASSERT_FALSE(decodeTlv(s.tag, 255, out));
+  }
+}
+
+static void test_config_rejects_wrong_fixed_sizes() {
+  struct {
+    uint8_t tag;
+    size_t size;
+  } const fixed[] = {
+      {TAG_LATITUDE, 4},   {TAG_LONGITUDE, 4},        {TAG_TZ_OFFSET, 4},
+      {TAG_CURRENT_TIME, 4}, {TAG_METHOD, 1},         {TAG_HIJRI_ADJUST, 1},
+      {TAG_IQAMA, IQAMA_RULES * 3}, {TAG_IQAMA_RULE, 4},
+  };
+  Config out;
+  for (const auto &f : fixed) {
+    // TAG_IQAMA_RULE's first byte is the row: 'x' is out of range, so
+    // the right size is checked with a valid row below
+    if (f.tag != TAG_IQAMA_RULE) {
+      TEST_ASSERT_TRUE(decodeTlv(f.tag, f.size, out));
+    }
+    TEST_ASSERT_FALSE(decodeTlv(f.tag, 0, out));
+    TEST_ASSERT_FALSE(decodeTlv(f.tag, f.size - 1, out));
+    TEST_ASSERT_FALSE(decodeTlv(f.tag, f.size + 1, out));
+  }
+  const uint8_t rule[] = {TAG_IQAMA_RULE, 4, 5, 1, 15, 0};
+  TEST_ASSERT_TRUE(decodeConfig(rule, sizeof(rule), out));
+  TEST_ASSERT_EQUAL(1 << 5, out.iqamaMask);
+  TEST_ASSERT_EQUAL(15, out.iqama[5].value);
+  const uint8_t badRow[] = {TAG_IQAMA_RULE, 4, IQAMA_RULES, 1, 15, 0};
+  TEST_ASSERT_FALSE(decodeConfig(badRow, sizeof(badRow), out));
+}
+
+static void test_crc32() {
+  const uint8_t *check = (const uint8_t *)"123456789";
+  TEST_ASSERT_EQUAL_HEX32(0xCBF43926, crc32(0, check, 9));
+  // Continued over two calls, as the upload does per DATA message
+  TEST_ASSERT_EQUAL_HEX32(0xCBF43926, crc32(crc32(0, check, 4), check + 4, 5));
+  TEST_ASSERT_EQUAL_HEX32(0, crc32(0, check, 0));
+}
+
+void setUp() {}
+void tearDown() {}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_round_trip_at_each_mtu);
+  RUN_TEST(test_empty_message);
+  RUN_TEST(test_out_of_order_frames);
+  RUN_TEST(test_oversized_message);
+  RUN_TEST(test_scan_results_round_trip);
+  RUN_TEST(test_scan_results_truncated_to_capacity);
+  RUN_TEST(test_config_round_trip);
+  RUN_TEST(test_config_rejects_truncated_tlv);
+  RUN_TEST(test_config_rejects_oversized_strings);
+  RUN_TEST(test_config_rejects_wrong_fixed_sizes);
+  RUN_TEST(test_crc32);
+  return UNITY_END();
+}
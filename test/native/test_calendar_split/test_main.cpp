@@ -0,0 +1,183 @@
+// Streaming MAWAQIT splitter against the DOM splitter it replaced, on the
+// real data/data.json: same prayer month files for the original, compact
+// and pretty-printed layouts, then time and peak heap per run.
+
+#include <Arduino.h>
+#include <AppState.h>
+#include <HostHeap.h>
+#include <SPIFFSHelper.h>
+#include <map>
+#include <unity.h>
+
+#ifndef DATA_JSON_PATH
+#define DATA_JSON_PATH "data/data.json"
+#endif
+
+static const int BENCH_RUNS = 5;
+
+// The splitter as it was before the streaming rewrite: whole document as a
+// DOM, once per calendar, month documents serialised through a String.
+// Allocations go through HostHeap so the peak is comparable.
+static bool domSplitCalendarJson(const String &rawJsonPath, bool isIqama) {
+  File file = openFileForRead(rawJsonPath);
+  if (!file) {
+    return false;
+  }
+  JsonDocument doc(&HostHeap::json);
+  DeserializationError error = deserializeJson(doc, file);
+  file.close();
+  if (error) {
+    return false;
+  }
+  String mainKey = isIqama ? "iqamaCalendar" : "calendar";
+  String jsonKey = isIqama ? "iqamaCalendar" : "prayerCalender";
+  String fileName = isIqama ? IQAMA_TIME_FILE_NAME : PRAYER_TIME_FILE_NAME;
+  if (doc[mainKey].isNull()) {
+    return false;
+  }
+
+  JsonArray calendar = doc[mainKey].as<JsonArray>();
+  for (size_t month = 0; month < calendar.size(); month++) {
+    if (calendar[month].is<JsonObject>()) {
+      JsonDocument monthDoc(&HostHeap::json);
+      monthDoc["month"] = month + 1;
+      monthDoc[jsonKey] = calendar[month];
+      String monthJson;
+      serializeJson(monthDoc, monthJson);
+      String filename = fileName + String((int)month + 1) + ".json";
+      if (!writeJsonFile(filename, monthJson)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+static bool domSplit(const String &path) {
+  return domSplitCalendarJson(path, false) && domSplitCalendarJson(path, true);
+}
+
+static std::string readAll(const String &path) {
+  File file = APP_FS.open(path, FILE_READ);
+  std::string text;
+  char buffer[512];
+  size_t n;
+  while (file && (n = file.read((uint8_t *)buffer, sizeof(buffer))) > 0) {
+    text.append(buffer, n);
+  }
+  return text;
+}
+
+static std::map<std::string, std::string> monthFiles() {
+  std::map<std::string, std::string> files;
+  for (int month = 1; month <= 12; month++) {
+    for (const char *prefix : {PRAYER_TIME_FILE_NAME, IQAMA_TIME_FILE_NAME}) {
+      String path = String(prefix) + String(month) + ".json";
+      if (APP_FS.exists(path)) {
+        files[path.c_str()] = readAll(path);
+        APP_FS.remove(path);
+      }
+    }
+  }
+  return files;
+}
+
+// data.json as shipped, plus compact and pretty re-serialisations of it
+static void writeLayouts() {
+  FILE *in = fopen(DATA_JSON_PATH, "rb");
+  if (!in) {
+    TEST_IGNORE_MESSAGE("data/data.json not found (run from the project)");
+  }
+  File original = APP_FS.open("/layout_original.json", FILE_WRITE);
+  char buffer[1024];
+  size_t n;
+  while ((n = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+    original.write((const uint8_t *)buffer, n);
+  }
+  fclose(in);
+  original.close();
+
+  JsonDocument doc;
+  TEST_ASSERT_TRUE(readJsonFile("/layout_original.json", doc));
+  File compact = APP_FS.open("/layout_compact.json", FILE_WRITE);
+  serializeJson(doc, compact);
+  compact.close();
+  File pretty = APP_FS.open("/layout_pretty.json", FILE_WRITE);
+  serializeJsonPretty(doc, pretty);
+  pretty.close();
+}
+
+static const char *const LAYOUTS[] = {"/layout_original.json",
+                                      "/layout_compact.json",
+                                      "/layout_pretty.json"};
+
+void setUp() {}
+void tearDown() {}
+
+// The iqama calendar is no longer split: only the prayer months compare,
+// and iqama files left by older firmware are removed
+static void test_stream_matches_dom_split() {
+  writeLayouts();
+  const String staleIqama = String(IQAMA_TIME_FILE_NAME) + "1.json";
+  for (const char *layout : LAYOUTS) {
+    TEST_ASSERT_TRUE(domSplitCalendarJson(layout, false));
+    const auto expected = monthFiles();
+    TEST_ASSERT_EQUAL(12, expected.size());
+
+    TEST_ASSERT_TRUE(writeJsonFile(staleIqama, "{}"));
+    TEST_ASSERT_TRUE(splitCalendarJson(layout));
+    TEST_ASSERT_FALSE(APP_FS.exists(staleIqama));
+    const auto actual = monthFiles();
+    TEST_ASSERT_EQUAL(expected.size(), actual.size());
+    for (const auto &file : expected) {
+      auto it = actual.find(file.first);
+      TEST_ASSERT_TRUE_MESSAGE(it != actual.end(), file.first.c_str());
+      TEST_ASSERT_EQUAL_STRING_MESSAGE(file.second.c_str(),
+                                       it->second.c_str(),
+                                       file.first.c_str());
+    }
+  }
+}
+
+struct BenchResult {
+  double millisPerRun;
+  size_t peakBytes;
+};
+
+static BenchResult bench(bool (*split)(const String &), const String &path) {
+  HostHeap::reset();
+  const size_t base = HostHeap::live;
+  const unsigned long start = micros();
+  for (int i = 0; i < BENCH_RUNS; i++) {
+    TEST_ASSERT_TRUE(split(path));
+  }
+  const unsigned long elapsed = micros() - start;
+  return {elapsed / 1000.0 / BENCH_RUNS, HostHeap::peak - base};
+}
+
+static void test_benchmark() {
+  writeLayouts();
+  printf("\n%-22s %12s %14s\n", "splitter (data.json)", "ms/run",
+         "peak heap B");
+  for (const char *layout : LAYOUTS) {
+    const BenchResult dom = bench(domSplit, layout);
+    const BenchResult stream = bench(splitCalendarJson, layout);
+    printf("%-22s %12.2f %14zu\n", (String("DOM ") + (layout + 8)).c_str(),
+           dom.millisPerRun, dom.peakBytes);
+    printf("%-22s %12.2f %14zu\n", (String("stream ") + (layout + 8)).c_str(),
+           stream.millisPerRun, stream.peakBytes);
+    // "A few KB" on the device; the host adds no JSON buffers either
+    TEST_ASSERT_LESS_THAN(4096, stream.peakBytes);
+    TEST_ASSERT_LESS_THAN(dom.peakBytes, stream.peakBytes);
+  }
+  monthFiles();
+}
+
+int main() {
+  Serial.mute(true);
+  APP_FS.begin(true);
+  UNITY_BEGIN();
+  RUN_TEST(test_stream_matches_dom_split);
+  RUN_TEST(test_benchmark);
+  return UNITY_END();
+}
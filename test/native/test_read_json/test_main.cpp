@@ -0,0 +1,151 @@
+// readJsonFile() against the chunk-appending helper it replaced, from a
+// config-sized file up to data/data.json: time, heap allocations and peak
+// heap for reading the text and for parsing it into a JsonDocument.
+
+#include <Arduino.h>
+#include <HostHeap.h>
+#include <SPIFFSHelper.h>
+#include <unity.h>
+
+#ifndef DATA_JSON_PATH
+#define DATA_JSON_PATH "data/data.json"
+#endif
+
+static const int BENCH_RUNS = 20;
+
+// The helper as it was: 2 KB chunks, each copied into a temporary String,
+// cut with substring() and appended. The original built the temporary from
+// an unterminated buffer (reading past it); the terminator added here
+// keeps the same allocations without the overrun.
+static String legacyReadJsonFile(const String &jsonPath) {
+  File file = APP_FS.open(jsonPath, "r");
+  if (!file) {
+    return "{}";
+  }
+  String jsonData = "";
+  const size_t bufferSize = 2048;
+  char buffer[bufferSize + 1];
+  while (file.available()) {
+    size_t bytesRead = file.readBytes(buffer, bufferSize);
+    buffer[bytesRead] = '\0';
+    jsonData += String(buffer).substring(0, bytesRead);
+  }
+  file.close();
+  return jsonData;
+}
+
+// A JSON array of records padded to about 'size' bytes
+static void writeSynthetic(const char *path, size_t size) {
+  File file = APP_FS.open(path, FILE_WRITE);
+  size_t written = file.print("{\"items\":[");
+  for (int i = 0; written < size; i++) {
+    written += file.printf("%s{\"id\":%d,\"name\":\"record %d\","
+                           "\"value\":\"0123456789abcdef\"}",
+                           i ? "," : "", i, i);
+  }
+  file.print("]}");
+  file.close();
+}
+
+static void copyDataJson(const char *path) {
+  FILE *in = fopen(DATA_JSON_PATH, "rb");
+  if (!in) {
+    TEST_IGNORE_MESSAGE("data/data.json not found (run from the project)");
+  }
+  File out = APP_FS.open(path, FILE_WRITE);
+  char buffer[1024];
+  size_t n;
+  while ((n = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+    out.write((const uint8_t *)buffer, n);
+  }
+  fclose(in);
+  out.close();
+}
+
+struct Sample {
+  double microsPerRun;
+  size_t allocations;
+  size_t peakBytes;
+};
+
+template <typename Fn> static Sample measure(Fn fn) {
+  HostHeap::reset();
+  const size_t base = HostHeap::live;
+  const unsigned long start = micros();
+  for (int i = 0; i < BENCH_RUNS; i++) {
+    fn();
+  }
+  const unsigned long elapsed = micros() - start;
+  return {(double)elapsed / BENCH_RUNS, HostHeap::allocations / BENCH_RUNS,
+          HostHeap::peak - base};
+}
+
+static void printRow(const char *file, const char *method, const Sample &s) {
+  printf("%-18s %-16s %12.1f %8zu %12zu\n", file, method, s.microsPerRun,
+         s.allocations, s.peakBytes);
+}
+
+void setUp() {}
+void tearDown() {}
+
+static const char *const FILES[] = {"/bench_1k.json", "/bench_16k.json",
+                                    "/bench_64k.json", "/data.json"};
+
+static void writeFiles() {
+  writeSynthetic(FILES[0], 1024);
+  writeSynthetic(FILES[1], 16 * 1024);
+  writeSynthetic(FILES[2], 64 * 1024);
+  copyDataJson(FILES[3]);
+}
+
+static void test_same_text() {
+  writeFiles();
+  for (const char *path : FILES) {
+    const String legacy = legacyReadJsonFile(path);
+    const String current = readJsonFile(path);
+    TEST_ASSERT_EQUAL(APP_FS.open(path).size(), current.length());
+    TEST_ASSERT_TRUE_MESSAGE(legacy == current, path);
+  }
+  TEST_ASSERT_EQUAL_STRING("{}", readJsonFile("/missing.json").c_str());
+}
+
+static void test_benchmark() {
+  writeFiles();
+  printf("\n%-18s %-16s %12s %8s %12s\n", "file", "method", "us/run",
+         "allocs", "peak heap B");
+  size_t textAllocations = 0;
+  for (const char *path : FILES) {
+    const Sample legacyText =
+        measure([&] { legacyReadJsonFile(path).length(); });
+    const Sample text = measure([&] { readJsonFile(path).length(); });
+    const Sample legacyParse = measure([&] {
+      JsonDocument doc(&HostHeap::json);
+      TEST_ASSERT_FALSE(deserializeJson(doc, legacyReadJsonFile(path)));
+    });
+    const Sample parse = measure([&] {
+      JsonDocument doc(&HostHeap::json);
+      TEST_ASSERT_TRUE(readJsonFile(path, doc));
+    });
+    printRow(path + 1, "legacy text", legacyText);
+    printRow(path + 1, "text", text);
+    printRow(path + 1, "legacy + parse", legacyParse);
+    printRow(path + 1, "stream parse", parse);
+
+    // One buffer whatever the size instead of three allocations per chunk,
+    // and no copy of the text next to the document
+    if (textAllocations == 0) {
+      textAllocations = text.allocations;
+    }
+    TEST_ASSERT_EQUAL(textAllocations, text.allocations);
+    TEST_ASSERT_LESS_THAN(legacyParse.peakBytes, parse.peakBytes);
+  }
+}
+
+int main() {
+  Serial.mute(true);
+  APP_FS.begin(true);
+  UNITY_BEGIN();
+  RUN_TEST(test_same_text);
+  RUN_TEST(test_benchmark);
+  return UNITY_END();
+}
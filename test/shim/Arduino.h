@@ -0,0 +1,290 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// Just enough of the Arduino core for the [env:native] suites to build the
+// libraries that do not touch hardware. Header-only, so every suite picks it
+// up through -Itest/shim.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctype.h>
+#include <thread>
+
+#include "pgmspace.h"
+
+#define RTC_DATA_ATTR
+#define IRAM_ATTR
+
+using std::max;
+using std::min;
+
+inline unsigned long micros() {
+  using namespace std::chrono;
+  static const steady_clock::time_point start = steady_clock::now();
+  return (unsigned long)duration_cast<microseconds>(steady_clock::now() -
+                                                    start)
+      .count();
+}
+
+inline unsigned long millis() { return micros() / 1000; }
+
+inline void delay(unsigned long ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+inline void yield() {}
+
+// Grows to the exact length like the core's WString (no doubling), so
+// append-heavy code costs on the host what it costs on the device
+class String {
+public:
+  String() {}
+  String(const char *s) { assign(s ? s : "", s ? strlen(s) : 0); }
+  String(const char *s, size_t n) { assign(s, n); }
+  String(const String &s) { assign(s.c_str(), s.len_); }
+  String(String &&s) noexcept : buf_(s.buf_), len_(s.len_), cap_(s.cap_) {
+    s.buf_ = nullptr;
+    s.len_ = s.cap_ = 0;
+  }
+  String(char c) { assign(&c, 1); }
+  String(int v) : String((long)v) {}
+  String(unsigned int v) : String((unsigned long)v) {}
+  String(long v) {
+    char buf[24];
+    assign(buf, snprintf(buf, sizeof(buf), "%ld", v));
+  }
+  String(unsigned long v) {
+    char buf[24];
+    assign(buf, snprintf(buf, sizeof(buf), "%lu", v));
+  }
+  String(double v, unsigned decimals = 2) {
+    char buf[40];
+    assign(buf, snprintf(buf, sizeof(buf), "%.*f", (int)decimals, v));
+  }
+  ~String() { delete[] buf_; }
+
+  String &operator=(const String &s) {
+    if (this != &s) {
+      len_ = 0;
+      concat(s.c_str(), s.len_);
+    }
+    return *this;
+  }
+  String &operator=(String &&s) noexcept {
+    std::swap(buf_, s.buf_);
+    std::swap(len_, s.len_);
+    std::swap(cap_, s.cap_);
+    return *this;
+  }
+  String &operator=(const char *s) {
+    len_ = 0;
+    concat(s ? s : "");
+    return *this;
+  }
+
+  const char *c_str() const { return buf_ ? buf_ : ""; }
+  unsigned int length() const { return len_; }
+  bool isEmpty() const { return len_ == 0; }
+  bool reserve(unsigned int size) {
+    if (size <= cap_ && buf_) {
+      return true;
+    }
+    char *grown = new char[size + 1];
+    memcpy(grown, c_str(), len_ + 1);
+    delete[] buf_;
+    buf_ = grown;
+    cap_ = size;
+    return true;
+  }
+
+  bool concat(const char *s, unsigned int n) {
+    reserve(len_ + n);
+    memcpy(buf_ + len_, s, n);
+    len_ += n;
+    buf_[len_] = '\0';
+    return true;
+  }
+  bool concat(const char *s) { return concat(s, strlen(s)); }
+  bool concat(const String &s) { return concat(s.c_str(), s.len_); }
+  bool concat(char c) { return concat(&c, 1); }
+
+  String &operator+=(const String &s) {
+    concat(s);
+    return *this;
+  }
+  String &operator+=(const char *s) {
+    concat(s);
+    return *this;
+  }
+  String &operator+=(char c) {
+    concat(c);
+    return *this;
+  }
+
+  char operator[](unsigned int i) const { return i < len_ ? buf_[i] : 0; }
+  bool operator==(const String &o) const {
+    return len_ == o.len_ && memcmp(c_str(), o.c_str(), len_) == 0;
+  }
+  bool operator==(const char *o) const { return strcmp(c_str(), o) == 0; }
+  bool operator!=(const String &o) const { return !(*this == o); }
+  bool operator<(const String &o) const {
+    return strcmp(c_str(), o.c_str()) < 0;
+  }
+
+  int indexOf(char c, unsigned int from = 0) const {
+    const char *p = from < len_ ? strchr(c_str() + from, c) : nullptr;
+    return p ? (int)(p - c_str()) : -1;
+  }
+  int indexOf(const char *s, unsigned int from = 0) const {
+    const char *p = from < len_ ? strstr(c_str() + from, s) : nullptr;
+    return p ? (int)(p - c_str()) : -1;
+  }
+  String substring(unsigned int from) const { return substring(from, len_); }
+  String substring(unsigned int from, unsigned int to) const {
+    if (from > to) {
+      std::swap(from, to);
+    }
+    to = std::min(to, len_);
+    return from < to ? String(c_str() + from, to - from) : String();
+  }
+  bool startsWith(const String &p) const {
+    return len_ >= p.len_ && memcmp(c_str(), p.c_str(), p.len_) == 0;
+  }
+  bool endsWith(const String &p) const {
+    return len_ >= p.len_ &&
+           memcmp(c_str() + len_ - p.len_, p.c_str(), p.len_) == 0;
+  }
+  long toInt() const { return atol(c_str()); }
+  float toFloat() const { return (float)atof(c_str()); }
+  void trim() {
+    if (!buf_) {
+      return;
+    }
+    unsigned int b = 0;
+    while (b < len_ && isspace((unsigned char)buf_[b])) {
+      b++;
+    }
+    unsigned int e = len_;
+    while (e > b && isspace((unsigned char)buf_[e - 1])) {
+      e--;
+    }
+    memmove(buf_, buf_ + b, e - b);
+    len_ = e - b;
+    buf_[len_] = '\0';
+  }
+
+private:
+  void assign(const char *s, size_t n) {
+    len_ = 0;
+    concat(s, (unsigned int)n);
+  }
+
+  char *buf_ = nullptr;
+  unsigned int len_ = 0;
+  unsigned int cap_ = 0;
+};
+
+class StringSumHelper : public String {
+public:
+  StringSumHelper(const String &s) : String(s) {}
+};
+
+inline StringSumHelper operator+(const String &a, const String &b) {
+  String r(a);
+  r += b;
+  return r;
+}
+inline StringSumHelper operator+(const String &a, const char *b) {
+  String r(a);
+  r += b;
+  return r;
+}
+inline StringSumHelper operator+(const char *a, const String &b) {
+  String r(a);
+  r += b;
+  return r;
+}
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t *buffer, size_t size) {
+    size_t n = 0;
+    while (size-- && write(*buffer++)) {
+      n++;
+    }
+    return n;
+  }
+  size_t write(const char *s) { return write((const uint8_t *)s, strlen(s)); }
+  size_t print(const char *s) { return write(s); }
+  size_t print(const String &s) {
+    return write((const uint8_t *)s.c_str(), s.length());
+  }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int v) { return printf("%d", v); }
+  size_t println(const char *s = "") { return print(s) + print('\n'); }
+  size_t println(const String &s) { return print(s) + print('\n'); }
+  __attribute__((format(printf, 2, 3))) size_t printf(const char *fmt, ...) {
+    char buf[512];
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    if (n < 0) {
+      return 0;
+    }
+    return write((const uint8_t *)buf, std::min((size_t)n, sizeof(buf) - 1));
+  }
+};
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  virtual size_t readBytes(char *buffer, size_t length) {
+    size_t n = 0;
+    int c;
+    while (n < length && (c = read()) >= 0) {
+      buffer[n++] = (char)c;
+    }
+    return n;
+  }
+};
+
+// Serial goes to stdout; suites that time something mute it
+class HostSerial : public Stream {
+public:
+  void begin(unsigned long) {}
+  void mute(bool on) { muted = on; }
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+  size_t write(uint8_t c) override {
+    if (!muted) {
+      putchar(c);
+    }
+    return 1;
+  }
+  size_t write(const uint8_t *buffer, size_t size) override {
+    if (!muted) {
+      fwrite(buffer, 1, size, stdout);
+    }
+    return size;
+  }
+  using Print::write;
+
+private:
+  bool muted = false;
+};
+
+inline HostSerial Serial;
+
+#endif // HOST_ARDUINO_H
@@ -0,0 +1,138 @@
+#ifndef HOST_FS_H
+#define HOST_FS_H
+
+// Host stand-in for the ESP32 fs::FS / fs::File pair: every path maps to a
+// plain file under one directory (HOST_FS_ROOT, .pio/host_fs by default).
+
+#include "Arduino.h"
+#include <memory>
+#include <string>
+#include <sys/stat.h>
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+#ifndef HOST_FS_ROOT
+#define HOST_FS_ROOT ".pio/host_fs"
+#endif
+
+namespace fs {
+
+class File : public Stream {
+public:
+  File() {}
+  File(FILE *f, const String &path)
+      : f_(f, [](FILE *p) { fclose(p); }), path_(path) {}
+
+  explicit operator bool() const { return f_ != nullptr; }
+  const char *path() const { return path_.c_str(); }
+
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t *buffer, size_t size) override {
+    return f_ ? fwrite(buffer, 1, size, f_.get()) : 0;
+  }
+  using Print::write;
+
+  int available() override {
+    return f_ ? (int)(size() - position()) : 0;
+  }
+  int read() override {
+    return f_ ? fgetc(f_.get()) : -1;
+  }
+  size_t read(uint8_t *buffer, size_t size) {
+    return f_ ? fread(buffer, 1, size, f_.get()) : 0;
+  }
+  int peek() override {
+    if (!f_) {
+      return -1;
+    }
+    int c = fgetc(f_.get());
+    if (c >= 0) {
+      ungetc(c, f_.get());
+    }
+    return c;
+  }
+  size_t readBytes(char *buffer, size_t length) override {
+    return read((uint8_t *)buffer, length);
+  }
+
+  bool seek(uint32_t pos) {
+    return f_ && fseek(f_.get(), pos, SEEK_SET) == 0;
+  }
+  size_t position() const { return f_ ? ftell(f_.get()) : 0; }
+  size_t size() const {
+    if (!f_) {
+      return 0;
+    }
+    fflush(f_.get());
+    struct stat st;
+    return fstat(fileno(f_.get()), &st) == 0 ? st.st_size : 0;
+  }
+  void flush() {
+    if (f_) {
+      fflush(f_.get());
+    }
+  }
+  void close() { f_.reset(); }
+
+private:
+  std::shared_ptr<FILE> f_;
+  String path_;
+};
+
+class FS {
+public:
+  explicit FS(const char *root = HOST_FS_ROOT) : root_(root) {}
+
+  // Creates the directory; formatting empties it
+  bool begin(bool formatOnFail = false) {
+    (void)formatOnFail;
+    mkdirs(root_);
+    return true;
+  }
+  void end() {}
+  bool format() {
+    std::string cmd = "rm -rf '" + root_ + "' && mkdir -p '" + root_ + "'";
+    return system(cmd.c_str()) == 0;
+  }
+
+  File open(const String &path, const char *mode = FILE_READ) {
+    // "w"/"a" create the file; read-only opens fail like on the device
+    const std::string mapped = map(path);
+    const char *hostMode = mode[0] == 'r' ? "rb" : mode[0] == 'a' ? "ab+"
+                                                                    : "wb+";
+    FILE *f = fopen(mapped.c_str(), hostMode);
+    return f ? File(f, path) : File();
+  }
+  bool exists(const String &path) {
+    struct stat st;
+    return stat(map(path).c_str(), &st) == 0;
+  }
+  bool remove(const String &path) { return ::remove(map(path).c_str()) == 0; }
+  bool rename(const String &from, const String &to) {
+    return ::rename(map(from).c_str(), map(to).c_str()) == 0;
+  }
+
+  size_t totalBytes() { return 1024 * 1024; }
+  size_t usedBytes() { return 0; }
+
+private:
+  std::string map(const String &path) const { return root_ + path.c_str(); }
+
+  static void mkdirs(const std::string &dir) {
+    std::string cmd = "mkdir -p '" + dir + "'";
+    if (system(cmd.c_str()) != 0) {
+      fprintf(stderr, "Cannot create %s\n", dir.c_str());
+    }
+  }
+
+  std::string root_;
+};
+
+} // namespace fs
+
+using fs::File;
+using fs::FS;
+
+#endif // HOST_FS_H
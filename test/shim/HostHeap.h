@@ -0,0 +1,86 @@
+#ifndef HOST_HEAP_H
+#define HOST_HEAP_H
+
+// Heap accounting for the host benchmarks: replaces the global operator
+// new/delete and offers an ArduinoJson allocator on the same counters, so a
+// run's peak covers String, File and JsonDocument memory alike. Include it
+// from exactly one file of a suite.
+
+#include <ArduinoJson.h>
+#include <cstdlib>
+#include <new>
+
+namespace HostHeap {
+
+// Live bytes now, the highest value and the number of allocations since
+// reset()
+inline size_t live = 0;
+inline size_t peak = 0;
+inline size_t allocations = 0;
+
+inline void reset() {
+  peak = live;
+  allocations = 0;
+}
+
+// A size header in front of every block, so frees can be counted
+constexpr size_t HEADER = alignof(std::max_align_t);
+
+inline void *allocate(size_t size) {
+  uint8_t *block = (uint8_t *)malloc(size + HEADER);
+  if (!block) {
+    return nullptr;
+  }
+  *(size_t *)block = size;
+  live += size;
+  allocations++;
+  if (live > peak) {
+    peak = live;
+  }
+  return block + HEADER;
+}
+
+inline void release(void *p) {
+  if (p) {
+    uint8_t *block = (uint8_t *)p - HEADER;
+    live -= *(size_t *)block;
+    free(block);
+  }
+}
+
+inline void *reallocate(void *p, size_t size) {
+  void *moved = allocate(size);
+  if (moved && p) {
+    const size_t old = *(size_t *)((uint8_t *)p - HEADER);
+    memcpy(moved, p, old < size ? old : size);
+    release(p);
+  }
+  return moved;
+}
+
+struct JsonAllocator : ArduinoJson::Allocator {
+  void *allocate(size_t size) override { return HostHeap::allocate(size); }
+  void deallocate(void *p) override { HostHeap::release(p); }
+  void *reallocate(void *p, size_t size) override {
+    return HostHeap::reallocate(p, size);
+  }
+};
+
+inline JsonAllocator json;
+
+} // namespace HostHeap
+
+void *operator new(size_t size) {
+  void *p = HostHeap::allocate(size);
+  if (!p) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+void *operator new[](size_t size) { return operator new(size); }
+void operator delete(void *p) noexcept { HostHeap::release(p); }
+void operator delete[](void *p) noexcept { HostHeap::release(p); }
+void operator delete(void *p, size_t) noexcept { HostHeap::release(p); }
+void operator delete[](void *p, size_t) noexcept { HostHeap::release(p); }
+
+#endif // HOST_HEAP_H
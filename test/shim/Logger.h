@@ -0,0 +1,14 @@
+#ifndef HOST_LOGGER_H
+#define HOST_LOGGER_H
+
+// Host stand-in for lib/Logger (which needs the ESP-IDF): warnings and
+// errors go to stderr, so benchmark tables on stdout stay readable.
+
+#include <cstdio>
+
+#define LOG_E(fmt, ...) fprintf(stderr, fmt "\n", ##__VA_ARGS__)
+#define LOG_W(fmt, ...) fprintf(stderr, fmt "\n", ##__VA_ARGS__)
+#define LOG_I(fmt, ...) do {} while (0)
+#define LOG_D(fmt, ...) do {} while (0)
+
+#endif // HOST_LOGGER_H
@@ -0,0 +1,8 @@
+#ifndef HOST_SPIFFS_H
+#define HOST_SPIFFS_H
+
+#include "FS.h"
+
+inline fs::FS SPIFFS;
+
+#endif // HOST_SPIFFS_H
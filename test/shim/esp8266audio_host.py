@@ -0,0 +1,18 @@
+# [env:native-audio]: builds only the part of ESP8266Audio that runs on the
+# host (MP3 decoder, stdio file source, logger). The rest of the library
+# needs I2S, SD or Wi-Fi drivers the shims do not provide.
+
+Import("env")
+
+HOST_SOURCES = ("AudioGeneratorMP3.cpp", "AudioFileSourceSTDIO.cpp",
+                "AudioLogger.cpp")
+
+
+def host_only(node):
+    path = node.get_abspath().replace("\\", "/")
+    if "/libmad/" in path or path.endswith(HOST_SOURCES):
+        return node
+    return None
+
+
+env.AddBuildMiddleware(host_only, "*/ESP8266Audio/src/*")
@@ -0,0 +1,20 @@
+#ifndef HOST_PGMSPACE_H
+#define HOST_PGMSPACE_H
+
+// Flash reads are plain reads on the host (ESP8266Audio's libmad tables)
+
+#include <cstdint>
+#include <cstring>
+
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+#define PSTR(s) (s)
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t *)(addr))
+#define memcpy_P memcpy
+#define strcpy_P strcpy
+#define strlen_P strlen
+
+#endif // HOST_PGMSPACE_H
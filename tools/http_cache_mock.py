@@ -0,0 +1,222 @@
+#!/usr/bin/env python3
+"""Mock Aladhan, Open-Meteo and MAWAQIT servers for the HTTP cache suite
+(test/device/test_http_cache):
+
+  tools/http_cache_mock.py [--http-port 8080] [--https-port 8443]
+
+Each resource covers one HttpCache path:
+
+  /v1/calendar/<y>/<m>       Aladhan month, ETag           (HTTP)
+  /v1/forecast               Open-Meteo hours, Last-Modified (HTTPS)
+  /api/3.0/mosque/<id>/times data/data.json, no validators  (HTTPS)
+
+Matching If-None-Match / If-Modified-Since get a 304. Control endpoints
+for the suite, on both ports:
+
+  /_reset?validators=0|1  version 0, empty log, validators on or off
+  /_change                new body (and validators) for every resource
+  /_requests              requests since the last call, as JSON
+
+HTTPS uses a throwaway self-signed certificate (TlsClient does not
+verify). Prints the build flags that point the firmware here.
+"""
+
+import argparse
+import json
+import os
+import socket
+import ssl
+import subprocess
+import sys
+import tempfile
+import threading
+from email.utils import formatdate, parsedate_to_datetime
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from urllib.parse import parse_qs, urlparse
+
+DATA_JSON = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..",
+                         "data", "data.json")
+
+# Forecast hours start here whatever the device clock says, so the suite
+# does not need NTP
+FORECAST_START = 1767225600  # 2026-01-01T00:00:00Z
+FORECAST_HOURS = 48
+# Last-Modified of version 0; every /_change moves it an hour on
+MODIFIED_BASE = 1767225600
+
+
+class State:
+    lock = threading.Lock()
+    version = 0
+    validators = True
+    log = []
+
+
+def aladhan_body(year, month):
+    minute = State.version % 60
+    days = [{"timings": {
+        "Fajr": "05:%02d (UTC)" % minute,
+        "Sunrise": "07:%02d (UTC)" % minute,
+        "Dhuhr": "12:%02d (UTC)" % minute,
+        "Asr": "15:%02d (UTC)" % minute,
+        "Maghrib": "17:%02d (UTC)" % minute,
+        "Isha": "19:%02d (UTC)" % minute,
+    }, "date": {"gregorian": {"date": "%02d-%02d-%04d" % (day, month, year)}}}
+        for day in range(1, 31)]
+    return json.dumps({"code": 200, "status": "OK", "data": days})
+
+
+def forecast_body():
+    return json.dumps({"hourly": {
+        "time": [FORECAST_START + 3600 * i for i in range(FORECAST_HOURS)],
+        "temperature_2m": [10.0 + State.version] * FORECAST_HOURS,
+        "weather_code": [3] * FORECAST_HOURS,
+    }})
+
+
+def mosque_body():
+    with open(DATA_JSON, "rb") as f:
+        body = f.read()
+    # Trailing whitespace per version: a new hash, still the same JSON
+    return body + b" " * State.version
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"  # Keep-alive, as HttpsSession expects
+
+    def log_message(self, fmt, *args):
+        sys.stderr.write("%s %s\n" % (self.address_string(), fmt % args))
+
+    def send_body(self, status, body, content_type="application/json",
+                  headers=()):
+        if isinstance(body, str):
+            body = body.encode()
+        self.send_response(status)
+        for name, value in headers:
+            self.send_header(name, value)
+        if status != 304:
+            self.send_header("Content-Type", content_type)
+            self.send_header("Content-Length", str(len(body)))
+        self.end_headers()
+        if status != 304:
+            self.wfile.write(body)
+
+    def do_GET(self):
+        url = urlparse(self.path)
+        query = parse_qs(url.query)
+        parts = url.path.strip("/").split("/")
+
+        if url.path == "/_reset":
+            with State.lock:
+                State.version = 0
+                State.validators = query.get("validators", ["1"])[0] != "0"
+                State.log = []
+            return self.send_body(200, "{}")
+        if url.path == "/_change":
+            with State.lock:
+                State.version += 1
+            return self.send_body(200, "{}")
+        if url.path == "/_requests":
+            with State.lock:
+                log, State.log = State.log, []
+            return self.send_body(200, json.dumps(log))
+
+        with State.lock:
+            version, validators = State.version, State.validators
+        etag = modified = None
+        if parts[:2] == ["v1", "calendar"] and len(parts) == 4:
+            body = aladhan_body(int(parts[2]), int(parts[3]))
+            etag = '"calendar-%s-%s-v%d"' % (parts[2], parts[3], version)
+        elif url.path == "/v1/forecast":
+            body = forecast_body()
+            modified = formatdate(MODIFIED_BASE + 3600 * version,
+                                  usegmt=True)
+        elif parts[:3] == ["api", "3.0", "mosque"] and parts[-1] == "times":
+            body = mosque_body()
+        else:
+            return self.send_body(404, '{"error":"not found"}')
+        if not validators:
+            etag = modified = None
+
+        status = 200
+        if_none_match = self.headers.get("If-None-Match")
+        if_modified_since = self.headers.get("If-Modified-Since")
+        if etag and if_none_match == etag:
+            status = 304
+        elif modified and if_modified_since:
+            try:
+                if (parsedate_to_datetime(if_modified_since) >=
+                        parsedate_to_datetime(modified)):
+                    status = 304
+            except (TypeError, ValueError):
+                pass
+
+        with State.lock:
+            State.log.append({
+                "path": url.path,
+                "ifNoneMatch": if_none_match or "",
+                "ifModifiedSince": if_modified_since or "",
+                "status": status,
+            })
+        headers = []
+        if etag:
+            headers.append(("ETag", etag))
+        if modified:
+            headers.append(("Last-Modified", modified))
+        self.send_body(status, body, headers=headers)
+
+
+def make_certificate(directory):
+    cert = os.path.join(directory, "cert.pem")
+    key = os.path.join(directory, "key.pem")
+    subprocess.run(["openssl", "req", "-x509", "-newkey", "rsa:2048",
+                    "-nodes", "-days", "1", "-subj", "/CN=http-cache-mock",
+                    "-keyout", key, "-out", cert],
+                   check=True, stdout=subprocess.DEVNULL,
+                   stderr=subprocess.DEVNULL)
+    return cert, key
+
+
+def lan_address():
+    with socket.socket(socket.AF_INET, socket.SOCK_DGRAM) as s:
+        try:
+            s.connect(("192.0.2.1", 9))  # No packet is sent
+            return s.getsockname()[0]
+        except OSError:
+            return "127.0.0.1"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("--http-port", type=int, default=8080)
+    parser.add_argument("--https-port", type=int, default=8443)
+    args = parser.parse_args()
+
+    http = ThreadingHTTPServer(("", args.http_port), Handler)
+    https = ThreadingHTTPServer(("", args.https_port), Handler)
+    with tempfile.TemporaryDirectory() as directory:
+        context = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+        context.load_cert_chain(*make_certificate(directory))
+    https.socket = context.wrap_socket(https.socket, server_side=True)
+
+    host = lan_address()
+    print("HTTP cache mock on ports %d (HTTP) and %d (HTTPS). Run the suite "
+          "with:\n" % (args.http_port, args.https_port))
+    print("  PLATFORMIO_BUILD_FLAGS='"
+          "-DALADHAN_API_URL=\\\"http://%s:%d\\\" "
+          "-DOPEN_METEO_API_URL=\\\"https://%s:%d\\\" "
+          "-DMAWAQIT_API_URL=\\\"https://%s:%d\\\"' \\\n"
+          "    pio test -e esp32-s3-devkitc-1 -f device/test_http_cache -v\n"
+          % (host, args.http_port, host, args.https_port, host,
+             args.https_port))
+    sys.stdout.flush()
+
+    threading.Thread(target=https.serve_forever, daemon=True).start()
+    try:
+        http.serve_forever()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,149 @@
+// Prints the BLE telemetry record (lib/Telemetry/TelemetryRecord.h).
+//
+//   g++ -std=c++11 -Ilib/Telemetry tools/telemetry_decode.cpp -o decode
+//   ./decode record.bin
+//   echo "01-00-00-01-..." | ./decode -   (hex as copied from a BLE app)
+//
+// A battery capacity in mAh as second argument adds a runtime estimate:
+//   ./decode record.bin 2000
+
+#include "TelemetryRecord.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+static const char *const PHASE_NAMES[TelemetryRecord::PHASES] = {
+    "boot", "rtc", "plan", "fs", "display", "render", "network", "sleep"};
+static const char *const PATH_NAMES[TelemetryRecord::PATHS] = {"boot", "full",
+                                                               "fast"};
+static const char *const SOURCE_NAMES[TelemetryRecord::SOURCES] = {
+    "wifi", "prayer", "weather", "ntp", "adhan"};
+
+static int hexValue(int c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  c = tolower(c);
+  return c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+}
+
+// Hex digits in pairs; separators and "0x" prefixes are skipped
+static std::vector<uint8_t> readHex(FILE *in) {
+  std::vector<uint8_t> bytes;
+  int high = -1;
+  int previous = 0;
+  int c;
+  while ((c = fgetc(in)) != EOF) {
+    if ((c == 'x' || c == 'X') && previous == '0' && high == 0) {
+      high = -1; // The '0' was a prefix
+    } else if (hexValue(c) >= 0) {
+      if (high < 0) {
+        high = hexValue(c);
+      } else {
+        bytes.push_back((uint8_t)(high << 4 | hexValue(c)));
+        high = -1;
+      }
+    }
+    previous = c;
+  }
+  return bytes;
+}
+
+static std::vector<uint8_t> readBinary(const char *path) {
+  std::vector<uint8_t> bytes;
+  FILE *in = fopen(path, "rb");
+  if (!in) {
+    perror(path);
+    exit(1);
+  }
+  int c;
+  while ((c = fgetc(in)) != EOF) {
+    bytes.push_back((uint8_t)c);
+  }
+  fclose(in);
+  return bytes;
+}
+
+static double percent(uint32_t part, uint32_t whole) {
+  return whole ? 100.0 * part / whole : 0.0;
+}
+
+int main(int argc, char **argv) {
+  std::vector<uint8_t> bytes =
+      argc > 1 && argv[1][0] != '-' ? readBinary(argv[1]) : readHex(stdin);
+  const double capacityMah = argc > 2 ? atof(argv[2]) : 0.0;
+
+  TelemetryRecord::Record r;
+  if (!TelemetryRecord::decode(bytes.data(), bytes.size(), r)) {
+    fprintf(stderr, "Not a telemetry record (%zu bytes)\n", bytes.size());
+    return 1;
+  }
+  if (r.version != TelemetryRecord::VERSION || r.size != sizeof(r)) {
+    printf("Note: record v%u of %u bytes, decoder knows v%u of %zu\n",
+           r.version, r.size, TelemetryRecord::VERSION, sizeof(r));
+  }
+
+  const uint32_t totalSeconds = r.awakeSeconds + r.sleepSeconds;
+  printf("Wakes          %u (awake %u s, asleep %u s, %.3f%% duty)\n",
+         r.wakeCycles, r.awakeSeconds, r.sleepSeconds,
+         percent(r.awakeSeconds, totalSeconds));
+  printf("Refreshes      %u full, %u partial\n", r.fullRefreshes,
+         r.partialRefreshes);
+  printf("Wi-Fi          %u sessions, %.1f s total, %.1f s longest, "
+         "%u s today\n",
+         r.wifiSessions, r.wifiMillis / 1000.0, r.wifiLongestMillis / 1000.0,
+         r.radioSecondsToday);
+  printf("Heap           %u free, %u lowest, %u largest block\n", r.freeHeap,
+         r.minFreeHeap, r.largestFreeBlock);
+  printf("Stack          %u bytes free at worst (loop task)\n",
+         r.minStackFree);
+
+  printf("Charge         %.2f mAh used", r.chargeUsedUah / 1000.0);
+  if (totalSeconds > 0) {
+    const double averageMa =
+        r.chargeUsedUah / 1000.0 / (totalSeconds / 3600.0);
+    printf(", %.3f mA average", averageMa);
+    if (capacityMah > 0 && averageMa > 0) {
+      printf(", ~%.0f days on %.0f mAh", capacityMah / averageMa / 24,
+             capacityMah);
+    }
+  }
+  printf("\n");
+  if (r.batteryMillivolts != TelemetryRecord::NO_BATTERY) {
+    printf("Battery        %u mV\n", r.batteryMillivolts);
+  }
+
+  printf("\nFetches        ok    failed  rate    in backoff\n");
+  for (int i = 0; i < TelemetryRecord::SOURCES; i++) {
+    const TelemetryRecord::Fetch &f = r.fetches[i];
+    printf("  %-12s %-5u %-7u %5.1f%%  %s\n", SOURCE_NAMES[i], f.successes,
+           f.failures, percent(f.successes, f.successes + f.failures),
+           f.consecutiveFailures ? "yes" : "no");
+  }
+
+  printf("\nAverage wake (us)");
+  for (int p = 0; p < TelemetryRecord::PATHS; p++) {
+    printf("%12s", PATH_NAMES[p]);
+  }
+  printf("\n  %-15s", "wakes");
+  for (int p = 0; p < TelemetryRecord::PATHS; p++) {
+    printf("%12u", r.paths[p].wakes);
+  }
+  for (int i = 0; i < TelemetryRecord::PHASES; i++) {
+    printf("\n  %-15s", PHASE_NAMES[i]);
+    for (int p = 0; p < TelemetryRecord::PATHS; p++) {
+      printf("%12u", r.paths[p].avgPhaseMicros[i]);
+    }
+  }
+  printf("\n  %-15s", "total");
+  for (int p = 0; p < TelemetryRecord::PATHS; p++) {
+    printf("%12u", r.paths[p].avgMicros);
+  }
+  printf("\n  %-15s", "MHz*ms");
+  for (int p = 0; p < TelemetryRecord::PATHS; p++) {
+    printf("%12u", r.paths[p].avgEnergy);
+  }
+  printf("\n");
+  return 0;
+}
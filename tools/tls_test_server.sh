@@ -0,0 +1,18 @@
+#!/bin/sh
+# Local TLS server for the session resumption suite
+# (test/device/test_tls_resume):
+#
+#   tools/tls_test_server.sh [port]
+#
+# openssl s_server with session tickets on (its default) and -www, whose
+# status page says "New," or "Reused," for every connection. A throwaway
+# RSA-2048 certificate, like most public servers use, is made on each start.
+set -e
+PORT=${1:-8443}
+DIR=$(mktemp -d)
+trap 'rm -rf "$DIR"' EXIT INT TERM
+openssl req -x509 -newkey rsa:2048 -nodes -days 1 -subj /CN=tls-test \
+  -keyout "$DIR/key.pem" -out "$DIR/cert.pem" 2>/dev/null
+echo "TLS test server on port $PORT, Ctrl-C to stop"
+openssl s_server -accept "$PORT" -cert "$DIR/cert.pem" -key "$DIR/key.pem" \
+  -www -quiet